@@ -34,8 +34,8 @@ namespace plug
             Other
         };
 
-        DeviceModel(const std::string& name, Category category, std::size_t numberPresets)
-            : name_(name), category_(category), numberPresets_(numberPresets)
+        DeviceModel(const std::string& name, Category category, std::size_t numberPresets, std::size_t numberEffectPresets = 0)
+            : name_(name), category_(category), numberPresets_(numberPresets), numberEffectPresets_(numberEffectPresets)
         {
         }
 
@@ -51,10 +51,16 @@ namespace plug
         {
             return numberPresets_;
         }
+        // Per effect knob, 0 if unknown
+        std::size_t numberOfEffectPresets() const
+        {
+            return numberEffectPresets_;
+        }
 
     private:
         std::string name_;
         Category category_;
         std::size_t numberPresets_;
+        std::size_t numberEffectPresets_;
     };
 }
@@ -0,0 +1,44 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data_structs.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace plug
+{
+    enum class EffectKnob
+    {
+        mod,
+        dlyRev
+    };
+
+    // Effect preset stored on the Mod or Dly/Rev knob
+    struct EffectPreset
+    {
+        EffectKnob knob;
+        std::uint8_t slot;
+        std::string name;
+        std::vector<fx_pedal_settings> effects;
+    };
+}
@@ -0,0 +1,56 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "data_structs.h"
+#include "com/Packet.h"
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace plug::com
+{
+    // Last state written to or read from the amp, per DSP; empty if unknown
+    struct DspState
+    {
+        std::optional<amp_settings> amp;
+        std::array<std::optional<fx_pedal_settings>, 4> effects;
+    };
+
+    struct CommandPlan
+    {
+        std::vector<PacketRawType> commands;
+        DspState state;
+        std::size_t savedPackets;
+    };
+
+
+    std::optional<std::size_t> effectDspIndex(const fx_pedal_settings& effect);
+    DspState toDspState(const SignalChain& signalChain);
+
+    CommandPlan planCommands(const DspState& current, const std::optional<amp_settings>& amp, std::span<const fx_pedal_settings> effects);
+    CommandPlan planSignalChain(const DspState& current, const SignalChain& target);
+    CommandPlan planSignalChain(const SignalChain& current, const SignalChain& target);
+
+    bool isSameBank(const SignalChain& lhs, const SignalChain& rhs);
+}
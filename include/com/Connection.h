@@ -20,12 +20,17 @@
 
 #pragma once
 
-#include <vector>
+#include "com/Packet.h"
+#include <chrono>
+#include <numeric>
+#include <span>
 #include <string>
 #include <cstdint>
 
 namespace plug::com
 {
+    inline constexpr std::chrono::milliseconds defaultReceiveTimeout{500};
+
 
     class Connection
     {
@@ -35,17 +40,34 @@ namespace plug::com
         virtual void close() = 0;
         virtual bool isOpen() const = 0;
 
-        template <class Container>
-        std::size_t send(Container c)
+        std::size_t send(std::span<const std::uint8_t> data)
         {
-            return sendImpl(c.data(), c.size());
+            return sendImpl(data.data(), data.size());
         }
 
-        virtual std::vector<std::uint8_t> receive(std::size_t recvSize) = 0;
+        virtual std::size_t sendBatch(std::span<const PacketRawType> packets)
+        {
+            return std::accumulate(packets.begin(), packets.end(), std::size_t{0}, [this](std::size_t n, const auto& packet)
+                                   { return n + send(packet); });
+        }
+
+        // Returns the number of bytes received into buffer, 0 on timeout
+        virtual std::size_t receiveInto(std::span<std::uint8_t> buffer) = 0;
+
+        virtual void setReceiveTimeout(std::chrono::milliseconds timeout) = 0;
+
+        // Drops packets received so far, so stale or unsolicited packets
+        // aren't taken as the answer to the next command
+        virtual void discardReceived()
+        {
+        }
 
         virtual std::string name() const = 0;
 
+        // Tells apart connected amps of the same model
+        virtual std::string identity() const = 0;
+
     private:
-        virtual std::size_t sendImpl(std::uint8_t* data, std::size_t size) = 0;
+        virtual std::size_t sendImpl(const std::uint8_t* data, std::size_t size) = 0;
     };
 }
@@ -20,12 +20,25 @@
 
 #pragma once
 
+#include "com/Connection.h"
+#include "com/UsbHotplug.h"
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace plug::com
 {
     class Mustang;
 
 
-    std::unique_ptr<Mustang> connect();
+    std::unique_ptr<Mustang> connect(libusb_context* context);
+
+    // Opens every attached amp; amps that cannot be opened are skipped
+    std::vector<std::unique_ptr<Mustang>> connectAll(libusb_context* context, std::chrono::milliseconds receiveTimeout = defaultReceiveTimeout);
+
+    // Opens the first amp that was started in firmware update mode
+    std::shared_ptr<Connection> connectUpdateMode(libusb_context* context);
+
+    // Reports supported amplifiers being plugged in or removed
+    std::unique_ptr<usb::HotplugMonitor> monitorDevices(libusb_context* context, usb::HotplugHandler handler);
 }
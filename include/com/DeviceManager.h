@@ -0,0 +1,72 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/MustangWorker.h"
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace plug::com
+{
+    struct BroadcastResult
+    {
+        std::chrono::steady_clock::duration latency;
+        std::exception_ptr error;
+    };
+
+
+    // Runs several amps side by side, each on its own worker thread; a
+    // broadcast is sent to all amps at once, so it takes as long as the
+    // slowest amp
+    class DeviceManager
+    {
+    public:
+        using ErrorHandler = std::function<void(std::size_t device, std::exception_ptr error)>;
+
+        explicit DeviceManager(ErrorHandler errorHandler);
+        DeviceManager(const DeviceManager&) = delete;
+        ~DeviceManager();
+
+        // The receive timeout, if set, replaces the one of the device's
+        // connection before onConnected runs
+        std::size_t add(std::unique_ptr<Mustang> device, MustangWorker::Task onConnected, std::optional<std::chrono::milliseconds> receiveTimeout = std::nullopt);
+        void clear();
+        std::size_t size() const;
+        MustangWorker& worker(std::size_t device);
+
+        // The results are in device order; the latency is taken from the
+        // call until the device has finished
+        std::future<std::vector<BroadcastResult>> broadcast(MustangWorker::Task task);
+        std::future<std::vector<BroadcastResult>> applySignalChain(const SignalChain& signalChain);
+
+        DeviceManager& operator=(const DeviceManager&) = delete;
+
+    private:
+        const ErrorHandler onError;
+        std::vector<std::unique_ptr<MustangWorker>> workers;
+    };
+}
@@ -0,0 +1,43 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "EffectPreset.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace plug::com
+{
+    // Effect presets of the Mod and Dly/Rev knobs, ordered by knob and slot
+    class EffectPresetTable
+    {
+    public:
+        void clear();
+        void put(const EffectPreset& preset);
+
+        std::optional<EffectPreset> get(EffectKnob knob, std::uint8_t slot) const;
+        const std::vector<EffectPreset>& presets() const;
+
+    private:
+        std::vector<EffectPreset> entries;
+    };
+}
@@ -0,0 +1,37 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/Packet.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace plug::com
+{
+    // Checks the image and builds every packet of the update: the date
+    // packet, the payload in numbered chunks and the finish packet
+    std::vector<PacketRawType> toFirmwarePackets(std::span<const std::uint8_t> image);
+
+    // The file is read once, nothing is parsed while sending
+    std::vector<PacketRawType> loadFirmware(const std::string& filename);
+}
@@ -21,166 +21,234 @@
 #pragma once
 
 #include "effects_enum.h"
+#include "com/Packet.h"
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
 namespace plug
 {
+    // Wire ids of the models; the amp specific and unknown bytes are the
+    // values of AmpPayload::setUnknownAmpSpecific() and setUnknown()
+    struct AmpIds
+    {
+        amps amp;
+        std::uint8_t id;
+        std::array<std::uint8_t, 5> specific;
+        std::array<std::uint8_t, 3> unknown;
+    };
 
-    constexpr amps lookupAmpById(std::uint8_t id)
+    struct EffectIds
+    {
+        effects effect;
+        std::uint8_t id;
+        com::DSP dsp;
+        std::array<std::uint8_t, 3> unknown;
+    };
+
+    struct CabinetIds
     {
-        switch (id)
+        cabinets cabinet;
+        std::uint8_t id;
+    };
+
+
+    // Entries are in enum order, so the lookup by model is an index
+    inline constexpr std::array<AmpIds, 12> ampTable{{
+        {amps::FENDER_57_DELUXE, 0x67, {{0x01, 0x01, 0x01, 0x01, 0x53}}, {{0x80, 0x80, 0x01}}},
+        {amps::FENDER_59_BASSMAN, 0x64, {{0x02, 0x02, 0x02, 0x02, 0x67}}, {{0x80, 0x80, 0x01}}},
+        {amps::FENDER_57_CHAMP, 0x7c, {{0x0c, 0x0c, 0x0c, 0x0c, 0x00}}, {{0x80, 0x80, 0x01}}},
+        {amps::FENDER_65_DELUXE_REVERB, 0x53, {{0x03, 0x03, 0x03, 0x03, 0x6a}}, {{0x00, 0x00, 0x01}}},
+        {amps::FENDER_65_PRINCETON, 0x6a, {{0x04, 0x04, 0x04, 0x04, 0x61}}, {{0x80, 0x80, 0x01}}},
+        {amps::FENDER_65_TWIN_REVERB, 0x75, {{0x05, 0x05, 0x05, 0x05, 0x72}}, {{0x80, 0x80, 0x01}}},
+        {amps::FENDER_SUPER_SONIC, 0x72, {{0x06, 0x06, 0x06, 0x06, 0x79}}, {{0x80, 0x80, 0x01}}},
+        {amps::BRITISH_60S, 0x61, {{0x07, 0x07, 0x07, 0x07, 0x5e}}, {{0x80, 0x80, 0x01}}},
+        {amps::BRITISH_70S, 0x79, {{0x0b, 0x0b, 0x0b, 0x0b, 0x7c}}, {{0x80, 0x80, 0x01}}},
+        {amps::BRITISH_80S, 0x5e, {{0x09, 0x09, 0x09, 0x09, 0x5d}}, {{0x80, 0x80, 0x01}}},
+        {amps::AMERICAN_90S, 0x5d, {{0x0a, 0x0a, 0x0a, 0x0a, 0x6d}}, {{0x80, 0x80, 0x01}}},
+        {amps::METAL_2000, 0x6d, {{0x08, 0x08, 0x08, 0x08, 0x75}}, {{0x80, 0x80, 0x01}}},
+    }};
+
+    inline constexpr std::array<EffectIds, 38> effectTable{{
+        {effects::EMPTY, 0x00, com::DSP::none, {{0x00, 0x08, 0x01}}},
+        {effects::OVERDRIVE, 0x3c, com::DSP::effect0, {{0x00, 0x08, 0x01}}},
+        {effects::WAH, 0x49, com::DSP::effect0, {{0x01, 0x08, 0x01}}},
+        {effects::TOUCH_WAH, 0x4a, com::DSP::effect0, {{0x01, 0x08, 0x01}}},
+        {effects::FUZZ, 0x1a, com::DSP::effect0, {{0x00, 0x08, 0x01}}},
+        {effects::FUZZ_TOUCH_WAH, 0x1c, com::DSP::effect0, {{0x00, 0x08, 0x01}}},
+        {effects::SIMPLE_COMP, 0x88, com::DSP::effect0, {{0x08, 0x08, 0x01}}},
+        {effects::COMPRESSOR, 0x07, com::DSP::effect0, {{0x00, 0x08, 0x01}}},
+        {effects::SINE_CHORUS, 0x12, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::TRIANGLE_CHORUS, 0x13, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::SINE_FLANGER, 0x18, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::TRIANGLE_FLANGER, 0x19, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::VIBRATONE, 0x2d, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::VINTAGE_TREMOLO, 0x40, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::SINE_TREMOLO, 0x41, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::RING_MODULATOR, 0x22, com::DSP::effect1, {{0x01, 0x08, 0x01}}},
+        {effects::STEP_FILTER, 0x29, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::PHASER, 0x4f, com::DSP::effect1, {{0x01, 0x01, 0x01}}},
+        {effects::PITCH_SHIFTER, 0x1f, com::DSP::effect1, {{0x01, 0x08, 0x01}}},
+        {effects::MONO_DELAY, 0x16, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::MONO_ECHO_FILTER, 0x43, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::STEREO_ECHO_FILTER, 0x48, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::MULTITAP_DELAY, 0x44, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::PING_PONG_DELAY, 0x45, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::DUCKING_DELAY, 0x15, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::REVERSE_DELAY, 0x46, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::TAPE_DELAY, 0x2b, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::STEREO_TAPE_DELAY, 0x2a, com::DSP::effect2, {{0x02, 0x01, 0x01}}},
+        {effects::SMALL_HALL_REVERB, 0x24, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::LARGE_HALL_REVERB, 0x3a, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::SMALL_ROOM_REVERB, 0x26, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::LARGE_ROOM_REVERB, 0x3b, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::SMALL_PLATE_REVERB, 0x4e, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::LARGE_PLATE_REVERB, 0x4b, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::AMBIENT_REVERB, 0x4c, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::ARENA_REVERB, 0x4d, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::FENDER_63_SPRING_REVERB, 0x21, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+        {effects::FENDER_65_SPRING_REVERB, 0x0b, com::DSP::effect3, {{0x00, 0x08, 0x01}}},
+    }};
+
+    inline constexpr std::array<CabinetIds, 13> cabinetTable{{
+        {cabinets::OFF, 0x00},
+        {cabinets::cab57DLX, 0x01},
+        {cabinets::cabBSSMN, 0x02},
+        {cabinets::cab65DLX, 0x03},
+        {cabinets::cab65PRN, 0x04},
+        {cabinets::cabCHAMP, 0x05},
+        {cabinets::cab4x12M, 0x06},
+        {cabinets::cab2x12C, 0x07},
+        {cabinets::cab4x12G, 0x08},
+        {cabinets::cab65TWN, 0x09},
+        {cabinets::cab4x12V, 0x0a},
+        {cabinets::cabSS212, 0x0b},
+        {cabinets::cabSS112, 0x0c},
+    }};
+
+
+    namespace detail
+    {
+        inline constexpr std::uint8_t noIndex{0xff};
+
+        // Each model is at the position of its enum value and each id is
+        // used only once
+        template <class Entry, std::size_t N, class Model>
+        constexpr bool isBijective(const std::array<Entry, N>& table, Model Entry::*model)
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                if (static_cast<std::size_t>(table[i].*model) != i)
+                {
+                    return false;
+                }
+
+                for (std::size_t j = i + 1; j < N; ++j)
+                {
+                    if (table[i].id == table[j].id)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return N < noIndex;
+        }
+
+        template <class Entry, std::size_t N>
+        constexpr std::array<std::uint8_t, 256> indexById(const std::array<Entry, N>& table)
         {
-            case 0x67:
-                return amps::FENDER_57_DELUXE;
-            case 0x64:
-                return amps::FENDER_59_BASSMAN;
-            case 0x7c:
-                return amps::FENDER_57_CHAMP;
-            case 0x53:
-                return amps::FENDER_65_DELUXE_REVERB;
-            case 0x6a:
-                return amps::FENDER_65_PRINCETON;
-            case 0x75:
-                return amps::FENDER_65_TWIN_REVERB;
-            case 0x72:
-                return amps::FENDER_SUPER_SONIC;
-            case 0x61:
-                return amps::BRITISH_60S;
-            case 0x79:
-                return amps::BRITISH_70S;
-            case 0x5e:
-                return amps::BRITISH_80S;
-            case 0x5d:
-                return amps::AMERICAN_90S;
-            case 0x6d:
-                return amps::METAL_2000;
-            default:
-                throw std::invalid_argument{"Invalid amp id: " + std::to_string(id)};
+            std::array<std::uint8_t, 256> index{};
+            index.fill(noIndex);
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                index[table[i].id] = static_cast<std::uint8_t>(i);
+            }
+            return index;
         }
+
+        static_assert(isBijective(ampTable, &AmpIds::amp));
+        static_assert(isBijective(effectTable, &EffectIds::effect));
+        static_assert(isBijective(cabinetTable, &CabinetIds::cabinet));
+
+        inline constexpr auto ampIndex = indexById(ampTable);
+        inline constexpr auto effectIndex = indexById(effectTable);
+        inline constexpr auto cabinetIndex = indexById(cabinetTable);
     }
 
 
-    constexpr effects lookupEffectById(std::uint8_t id)
+    constexpr const AmpIds& lookupAmp(amps amp)
+    {
+        return ampTable[static_cast<std::size_t>(amp)];
+    }
+
+    constexpr const EffectIds& lookupEffect(effects effect)
+    {
+        return effectTable[static_cast<std::size_t>(effect)];
+    }
+
+    constexpr const CabinetIds& lookupCabinet(cabinets cabinet)
     {
-        switch (id)
+        return cabinetTable[static_cast<std::size_t>(cabinet)];
+    }
+
+
+    // Returns an empty optional for unknown ids
+    constexpr std::optional<amps> findAmpById(std::uint8_t id)
+    {
+        if (const auto index = detail::ampIndex[id]; index != detail::noIndex)
+        {
+            return ampTable[index].amp;
+        }
+        return {};
+    }
+
+    constexpr std::optional<effects> findEffectById(std::uint8_t id)
+    {
+        if (const auto index = detail::effectIndex[id]; index != detail::noIndex)
+        {
+            return effectTable[index].effect;
+        }
+        return {};
+    }
+
+    constexpr std::optional<cabinets> findCabinetById(std::uint8_t id)
+    {
+        if (const auto index = detail::cabinetIndex[id]; index != detail::noIndex)
         {
-            case 0x00:
-                return effects::EMPTY;
-            case 0x3c:
-                return effects::OVERDRIVE;
-            case 0x49:
-                return effects::WAH;
-            case 0x4a:
-                return effects::TOUCH_WAH;
-            case 0x1a:
-                return effects::FUZZ;
-            case 0x1c:
-                return effects::FUZZ_TOUCH_WAH;
-            case 0x88:
-                return effects::SIMPLE_COMP;
-            case 0x07:
-                return effects::COMPRESSOR;
-            case 0x12:
-                return effects::SINE_CHORUS;
-            case 0x13:
-                return effects::TRIANGLE_CHORUS;
-            case 0x18:
-                return effects::SINE_FLANGER;
-            case 0x19:
-                return effects::TRIANGLE_FLANGER;
-            case 0x2d:
-                return effects::VIBRATONE;
-            case 0x40:
-                return effects::VINTAGE_TREMOLO;
-            case 0x41:
-                return effects::SINE_TREMOLO;
-            case 0x22:
-                return effects::RING_MODULATOR;
-            case 0x29:
-                return effects::STEP_FILTER;
-            case 0x4f:
-                return effects::PHASER;
-            case 0x1f:
-                return effects::PITCH_SHIFTER;
-            case 0x16:
-                return effects::MONO_DELAY;
-            case 0x43:
-                return effects::MONO_ECHO_FILTER;
-            case 0x48:
-                return effects::STEREO_ECHO_FILTER;
-            case 0x44:
-                return effects::MULTITAP_DELAY;
-            case 0x45:
-                return effects::PING_PONG_DELAY;
-            case 0x15:
-                return effects::DUCKING_DELAY;
-            case 0x46:
-                return effects::REVERSE_DELAY;
-            case 0x2b:
-                return effects::TAPE_DELAY;
-            case 0x2a:
-                return effects::STEREO_TAPE_DELAY;
-            case 0x24:
-                return effects::SMALL_HALL_REVERB;
-            case 0x3a:
-                return effects::LARGE_HALL_REVERB;
-            case 0x26:
-                return effects::SMALL_ROOM_REVERB;
-            case 0x3b:
-                return effects::LARGE_ROOM_REVERB;
-            case 0x4e:
-                return effects::SMALL_PLATE_REVERB;
-            case 0x4b:
-                return effects::LARGE_PLATE_REVERB;
-            case 0x4c:
-                return effects::AMBIENT_REVERB;
-            case 0x4d:
-                return effects::ARENA_REVERB;
-            case 0x21:
-                return effects::FENDER_63_SPRING_REVERB;
-            case 0x0b:
-                return effects::FENDER_65_SPRING_REVERB;
-            default:
-                throw std::invalid_argument{"Invalid effect id: " + std::to_string(id)};
+            return cabinetTable[index].cabinet;
         }
+        return {};
     }
 
 
+    constexpr amps lookupAmpById(std::uint8_t id)
+    {
+        if (const auto amp = findAmpById(id); amp)
+        {
+            return *amp;
+        }
+        throw std::invalid_argument{"Invalid amp id: " + std::to_string(id)};
+    }
+
+    constexpr effects lookupEffectById(std::uint8_t id)
+    {
+        if (const auto effect = findEffectById(id); effect)
+        {
+            return *effect;
+        }
+        throw std::invalid_argument{"Invalid effect id: " + std::to_string(id)};
+    }
+
     constexpr cabinets lookupCabinetById(std::uint8_t id)
     {
-        switch (id)
+        if (const auto cabinet = findCabinetById(id); cabinet)
         {
-            case 0x00:
-                return cabinets::OFF;
-            case 0x01:
-                return cabinets::cab57DLX;
-            case 0x02:
-                return cabinets::cabBSSMN;
-            case 0x03:
-                return cabinets::cab65DLX;
-            case 0x04:
-                return cabinets::cab65PRN;
-            case 0x05:
-                return cabinets::cabCHAMP;
-            case 0x06:
-                return cabinets::cab4x12M;
-            case 0x07:
-                return cabinets::cab2x12C;
-            case 0x08:
-                return cabinets::cab4x12G;
-            case 0x09:
-                return cabinets::cab65TWN;
-            case 0x0a:
-                return cabinets::cab4x12V;
-            case 0x0b:
-                return cabinets::cabSS212;
-            case 0x0c:
-                return cabinets::cabSS112;
-            default:
-                throw std::invalid_argument{"Invalid cabinet id: " + std::to_string(id)};
+            return *cabinet;
         }
+        throw std::invalid_argument{"Invalid cabinet id: " + std::to_string(id)};
     }
 
 }
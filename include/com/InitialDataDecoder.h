@@ -0,0 +1,78 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "DeviceModel.h"
+#include "EffectPreset.h"
+#include "com/Packet.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace plug::com
+{
+    bool isConfirmationPacket(std::span<const std::uint8_t> data);
+    SignalChain decode_data(const std::array<PacketRawType, 7>& data);
+
+
+    // Decodes the data sent on connect packet by packet: preset names,
+    // the current state and the effect presets of the Mod and Dly/Rev knobs
+    class InitialDataDecoder
+    {
+    public:
+        using NameHandler = std::function<void(std::size_t, const std::string&)>;
+        using StateHandler = std::function<void(const SignalChain&)>;
+        using EffectPresetHandler = std::function<void(const EffectPreset&)>;
+
+        InitialDataDecoder(const DeviceModel& model, NameHandler nameHandler, StateHandler stateHandler, EffectPresetHandler effectPresetHandler);
+
+        void push(const PacketRawType& packet);
+        bool hasState() const;
+        bool isComplete() const;
+
+
+    private:
+        enum class Phase
+        {
+            presetNames,
+            currentState,
+            stateTrailer,
+            effectPresets
+        };
+
+        void pushPresetName(const PacketRawType& packet);
+        void pushEffectPreset(const PacketRawType& packet);
+
+        const NameHandler onName;
+        const StateHandler onState;
+        const EffectPresetHandler onEffectPreset;
+        std::size_t numberOfPresets;
+        const std::size_t numberOfEffectPresets;
+        Phase phase;
+        std::size_t received;
+        std::array<PacketRawType, 7> state;
+        std::optional<EffectPreset> effectPreset;
+    };
+}
@@ -0,0 +1,88 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace plug::com
+{
+    // Lock-free queue for many producers and a single consumer; push() may
+    // be called from any thread, tryPop() only from the consuming thread
+    template <class T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue()
+            : head(new Node{}), tail(head.load())
+        {
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+
+        ~MpscQueue()
+        {
+            while (tryPop())
+            {
+            }
+            delete tail;
+        }
+
+        void push(T value)
+        {
+            auto* node = new Node{};
+            node->value.emplace(std::move(value));
+            Node* previous = head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        // Empty if the queue is empty or a concurrent push is not yet linked
+        std::optional<T> tryPop()
+        {
+            Node* next = tail->next.load(std::memory_order_acquire);
+
+            if (next == nullptr)
+            {
+                return std::nullopt;
+            }
+
+            std::optional<T> value{std::move(next->value)};
+            next->value.reset();
+            delete tail;
+            tail = next;
+            return value;
+        }
+
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next{nullptr};
+            std::optional<T> value;
+        };
+
+        std::atomic<Node*> head;
+        Node* tail;
+    };
+}
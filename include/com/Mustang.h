@@ -23,7 +23,14 @@
 
 #include "SignalChain.h"
 #include "DeviceModel.h"
+#include "EffectPreset.h"
 #include "com/Connection.h"
+#include "com/CommandPlanner.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 #include <memory>
@@ -35,33 +42,69 @@ namespace plug::com
     {
         SignalChain signalChain;
         std::vector<std::string> presetNames;
+        std::vector<EffectPreset> effectPresets;
     };
 
     class Mustang
     {
     public:
+        // Collects amp and effect writes and sends them as one burst with
+        // a single apply per phase; uncommitted writes are discarded
+        class Transaction
+        {
+        public:
+            explicit Transaction(Mustang& mustang);
+            Transaction(const Transaction&) = delete;
+
+            Transaction& set_amplifier(amp_settings value);
+            Transaction& set_effect(fx_pedal_settings value);
+            void commit();
+
+            Transaction& operator=(const Transaction&) = delete;
+
+        private:
+            Mustang& owner;
+            std::optional<amp_settings> amp;
+            std::vector<fx_pedal_settings> effects;
+        };
+
+        using PresetNameHandler = std::function<void(std::size_t, const std::string&)>;
+
         Mustang(DeviceModel deviceModel, std::shared_ptr<Connection> connection);
         Mustang(const Mustang&) = delete;
 
-        InitialData start_amp();
+        InitialData start_amp(const PresetNameHandler& onPresetName = nullptr);
         void stop_amp();
         void set_effect(fx_pedal_settings value);
         void set_amplifier(amp_settings value);
-        void save_on_amp(std::string_view name, std::uint8_t slot);
+        SignalChain save_on_amp(std::string_view name, std::uint8_t slot);
         SignalChain load_memory_bank(std::uint8_t slot);
         void save_effects(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects);
+        Transaction transaction();
+        std::size_t applySignalChain(const SignalChain& target);
+        void setPipelining(bool enabled);
+        void setReceiveTimeout(std::chrono::milliseconds timeout);
 
         DeviceModel getDeviceModel() const;
+        std::string getDeviceName() const;
+        std::string getDeviceIdentity() const;
+        const DspState& getDspState() const;
 
 
         Mustang& operator=(const Mustang&) = delete;
 
 
     private:
-        InitialData loadData();
+        InitialData loadData(const PresetNameHandler& onPresetName);
         void initializeAmp();
+        void sendCommands(std::span<const PacketRawType> commands);
+        std::size_t sendPipelined(std::span<const PacketRawType> commands);
+        void sendPlan(const CommandPlan& plan);
+        void writeSettings(const std::optional<amp_settings>& amp, std::span<const fx_pedal_settings> effects);
 
         const DeviceModel model;
         const std::shared_ptr<Connection> conn;
+        bool pipelineCommands;
+        DspState dspState;
     };
 }
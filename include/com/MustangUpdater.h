@@ -3,7 +3,6 @@
  *        Linux replacement for Fender FUSE software
  *
  * Copyright (C) 2017-2024  offa
- * Copyright (C) 2010-2016  piorekf <piorek@piorekf.org>
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,7 +20,47 @@
 
 #pragma once
 
+#include "com/Connection.h"
+#include "com/Packet.h"
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace plug::com
 {
-    int updateFirmware(const char* filename);
+    // Sends a firmware image to an amp in update mode on a thread of its
+    // own; each packet is sent as soon as the amp has answered the previous
+    // one
+    class MustangUpdater
+    {
+    public:
+        using Factory = std::function<std::shared_ptr<Connection>()>;
+        using ProgressHandler = std::function<void(std::size_t packetsSent, std::size_t packetsTotal)>;
+        using FinishedHandler = std::function<void(std::exception_ptr error)>;
+
+        MustangUpdater(ProgressHandler progressHandler, FinishedHandler finishedHandler);
+        MustangUpdater(const MustangUpdater&) = delete;
+        ~MustangUpdater();
+
+        // The image is read and split into packets before this returns; the
+        // handlers are invoked on the update thread
+        void start(const std::string& filename, Factory factory);
+        void cancel();
+
+        MustangUpdater& operator=(const MustangUpdater&) = delete;
+
+    private:
+        void run(std::vector<PacketRawType> packets, Factory factory);
+
+        const ProgressHandler onProgress;
+        const FinishedHandler onFinished;
+        std::atomic<bool> running;
+        std::atomic<bool> cancelled;
+        std::thread thread;
+    };
 }
@@ -0,0 +1,88 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/Mustang.h"
+#include "com/MpscQueue.h"
+#include "com/UpdateCoalescer.h"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <semaphore>
+#include <thread>
+
+namespace plug::com
+{
+    // Owns the Mustang and runs all device traffic on a dedicated thread;
+    // tasks run in the order they were queued, so a later task never
+    // overtakes an earlier state change
+    class MustangWorker
+    {
+    public:
+        using Task = std::function<void(Mustang&)>;
+        using Factory = std::function<std::unique_ptr<Mustang>()>;
+        using ErrorHandler = std::function<void(std::exception_ptr)>;
+        using LatencyHandler = std::function<void(TokenBucket::Clock::duration)>;
+
+        explicit MustangWorker(ErrorHandler errorHandler, LatencyHandler latencyHandler = nullptr);
+        MustangWorker(const MustangWorker&) = delete;
+        ~MustangWorker();
+
+        void connect(Factory factory, Task onConnected);
+        void disconnect();
+        void post(Task task);
+        void execute(std::function<void()> task);
+
+        // Settings updates are coalesced per target and rate limited; the
+        // latency handler gets the time from the latest update to its ack.
+        // They are sent ahead of tasks queued later, which never wait for
+        // the rate limit
+        void update(amp_settings value);
+        void update(fx_pedal_settings value);
+        CoalescingStats coalescingStats() const;
+
+        MustangWorker& operator=(const MustangWorker&) = delete;
+
+
+    private:
+        void enqueue(std::function<void()> task);
+        void armFlush();
+        void run();
+        void runTask(const std::function<void()>& task);
+        void flushUpdates();
+
+        const ErrorHandler onError;
+        const LatencyHandler onUpdateSent;
+        std::unique_ptr<Mustang> mustang;
+        UpdateCoalescer updates;
+        TokenBucket sendRate;
+        MpscQueue<std::function<void()>> tasks;
+        std::atomic<std::uint64_t> enqueued;
+        std::atomic<std::uint64_t> flushBarrier;
+        std::atomic<bool> flushArmed;
+        std::counting_semaphore<> pending;
+        std::atomic<bool> running;
+        std::thread thread;
+    };
+}
@@ -20,11 +20,13 @@
 
 #pragma once
 
+#include "com/PacketSchema.h"
 #include <array>
 #include <algorithm>
 #include <string>
 #include <string_view>
 #include <cstdint>
+#include <span>
 
 namespace plug::com
 {
@@ -59,144 +61,515 @@ namespace plug::com
         unknown
     };
 
-    class Header
+    namespace detail
     {
-    public:
-        using RawType = std::array<std::uint8_t, 16>;
+        std::uint8_t toStageId(Stage stage);
+        Stage toStage(std::uint8_t id);
+        std::uint8_t toTypeId(Type type);
+        Type toType(std::uint8_t id);
+        std::uint8_t toDspId(DSP dsp);
+        DSP toDsp(std::uint8_t id);
+    }
 
-        void setStage(Stage stage);
-        Stage getStage() const;
 
-        void setType(Type type);
-        Type getType() const;
+    constexpr std::size_t headerRawTypeSize = 16;
+    constexpr std::size_t payloadRawTypeSize = 48;
 
-        void setDSP(DSP dsp);
-        DSP getDSP() const;
+    static_assert(schema::isValidLayout(schema::header::fields, headerRawTypeSize));
+    static_assert(schema::isValidLayout(schema::name::fields, payloadRawTypeSize));
+    static_assert(schema::isValidLayout(schema::effect::fields, payloadRawTypeSize));
+    static_assert(schema::isValidLayout(schema::amp::fields, payloadRawTypeSize));
+    static_assert(schema::isSingleByte(schema::header::fields) && schema::isSingleByte(schema::effect::fields) && schema::isSingleByte(schema::amp::fields));
 
-        void setSlot(std::uint8_t slot);
-        std::uint8_t getSlot() const;
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
+    // Byte access for the field accessors, shared by the owning types and
+    // the packet views; Derived provides the bytes through data()
+    template <class Derived>
+    class FieldAccess
+    {
+    public:
+        template <const schema::Field& field>
+        std::uint8_t get() const
+        {
+            static_assert(field.width == 1);
+            return schema::get(bytes(), field);
+        }
 
-        RawType getBytes() const;
-        void fromBytes(const RawType& data);
+        template <const schema::Field& field>
+        void set(std::uint8_t value)
+        {
+            static_assert(field.width == 1);
+            schema::set(bytes(), field, value);
+        }
 
-    private:
-        RawType bytes{{}};
+    protected:
+        constexpr auto bytes()
+        {
+            return static_cast<Derived&>(*this).data();
+        }
+
+        constexpr auto bytes() const
+        {
+            return static_cast<const Derived&>(*this).data();
+        }
     };
 
 
-    class PayloadBase
+    // Named accessors of the schema fields
+    template <class Derived>
+    class HeaderFields : public FieldAccess<Derived>
     {
     public:
-        using RawType = std::array<std::uint8_t, 48>;
+        void setStage(Stage stage)
+        {
+            this->template set<schema::header::stage>(detail::toStageId(stage));
+        }
 
-        RawType getBytes() const;
-        void fromBytes(const RawType& data);
+        Stage getStage() const
+        {
+            return detail::toStage(this->template get<schema::header::stage>());
+        }
 
-    protected:
-        RawType bytes{{}};
+        void setType(Type type)
+        {
+            this->template set<schema::header::type>(detail::toTypeId(type));
+        }
+
+        Type getType() const
+        {
+            return detail::toType(this->template get<schema::header::type>());
+        }
+
+        void setDSP(DSP dsp)
+        {
+            this->template set<schema::header::dsp>(detail::toDspId(dsp));
+        }
+
+        DSP getDSP() const
+        {
+            return detail::toDsp(this->template get<schema::header::dsp>());
+        }
+
+        void setSlot(std::uint8_t value)
+        {
+            this->template set<schema::header::slot>(value);
+        }
+
+        std::uint8_t getSlot() const
+        {
+            return this->template get<schema::header::slot>();
+        }
+
+        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            this->template set<schema::header::unknown0>(value0);
+            this->template set<schema::header::unknown1>(value1);
+            this->template set<schema::header::unknown2>(value2);
+        }
+
+        std::array<std::uint8_t, 3> getUnknown() const
+        {
+            return {{this->template get<schema::header::unknown0>(), this->template get<schema::header::unknown1>(), this->template get<schema::header::unknown2>()}};
+        }
     };
 
-    class EmptyPayload : public PayloadBase
+
+    template <class Derived>
+    class EmptyFields : public FieldAccess<Derived>
+    {
+    };
+
+    template <class Derived>
+    class NameFields : public FieldAccess<Derived>
     {
     public:
+        void setName(std::string_view name)
+        {
+            const auto n = std::min(name.length(), schema::name::name.width);
+            std::copy_n(name.cbegin(), n, std::next(this->bytes().begin(), schema::name::name.offset));
+        }
+
+        std::string getName() const
+        {
+            const auto b = this->bytes().subspan(schema::name::name.offset, schema::name::name.width);
+            const auto end = std::find(b.begin(), b.end(), '\0');
+
+            return std::string(b.begin(), end);
+        }
     };
 
-    class NamePayload : public PayloadBase
+    template <class Derived>
+    class EffectFields : public FieldAccess<Derived>
     {
     public:
-        void setName(std::string_view name);
-        std::string getName() const;
+        void setKnob1(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob1>(value);
+        }
+
+        std::uint8_t getKnob1() const
+        {
+            return this->template get<schema::effect::knob1>();
+        }
+
+        void setKnob2(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob2>(value);
+        }
+
+        std::uint8_t getKnob2() const
+        {
+            return this->template get<schema::effect::knob2>();
+        }
+
+        void setKnob3(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob3>(value);
+        }
+
+        std::uint8_t getKnob3() const
+        {
+            return this->template get<schema::effect::knob3>();
+        }
+
+        void setKnob4(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob4>(value);
+        }
+
+        std::uint8_t getKnob4() const
+        {
+            return this->template get<schema::effect::knob4>();
+        }
+
+        void setKnob5(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob5>(value);
+        }
+
+        std::uint8_t getKnob5() const
+        {
+            return this->template get<schema::effect::knob5>();
+        }
+
+        void setKnob6(std::uint8_t value)
+        {
+            this->template set<schema::effect::knob6>(value);
+        }
+
+        std::uint8_t getKnob6() const
+        {
+            return this->template get<schema::effect::knob6>();
+        }
+
+        void setSlot(std::uint8_t value)
+        {
+            this->template set<schema::effect::slot>(value);
+        }
+
+        std::uint8_t getSlot() const
+        {
+            return this->template get<schema::effect::slot>();
+        }
+
+        void setModel(std::uint8_t value)
+        {
+            this->template set<schema::effect::model>(value);
+        }
+
+        std::uint8_t getModel() const
+        {
+            return this->template get<schema::effect::model>();
+        }
+
+        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            this->template set<schema::effect::unknown0>(value0);
+            this->template set<schema::effect::unknown1>(value1);
+            this->template set<schema::effect::unknown2>(value2);
+        }
     };
 
-    class EffectPayload : public PayloadBase
+    template <class Derived>
+    class AmpFields : public FieldAccess<Derived>
     {
     public:
-        void setKnob1(std::uint8_t value);
-        std::uint8_t getKnob1() const;
+        void setModel(std::uint8_t value)
+        {
+            this->template set<schema::amp::model>(value);
+        }
+
+        std::uint8_t getModel() const
+        {
+            return this->template get<schema::amp::model>();
+        }
+
+        void setVolume(std::uint8_t value)
+        {
+            this->template set<schema::amp::volume>(value);
+        }
+
+        std::uint8_t getVolume() const
+        {
+            return this->template get<schema::amp::volume>();
+        }
+
+        void setGain(std::uint8_t value)
+        {
+            this->template set<schema::amp::gain>(value);
+        }
+
+        std::uint8_t getGain() const
+        {
+            return this->template get<schema::amp::gain>();
+        }
+
+        void setGain2(std::uint8_t value)
+        {
+            this->template set<schema::amp::gain2>(value);
+        }
+
+        std::uint8_t getGain2() const
+        {
+            return this->template get<schema::amp::gain2>();
+        }
+
+        void setMasterVolume(std::uint8_t value)
+        {
+            this->template set<schema::amp::masterVolume>(value);
+        }
+
+        std::uint8_t getMasterVolume() const
+        {
+            return this->template get<schema::amp::masterVolume>();
+        }
+
+        void setTreble(std::uint8_t value)
+        {
+            this->template set<schema::amp::treble>(value);
+        }
+
+        std::uint8_t getTreble() const
+        {
+            return this->template get<schema::amp::treble>();
+        }
+
+        void setMiddle(std::uint8_t value)
+        {
+            this->template set<schema::amp::middle>(value);
+        }
+
+        std::uint8_t getMiddle() const
+        {
+            return this->template get<schema::amp::middle>();
+        }
+
+        void setBass(std::uint8_t value)
+        {
+            this->template set<schema::amp::bass>(value);
+        }
+
+        std::uint8_t getBass() const
+        {
+            return this->template get<schema::amp::bass>();
+        }
+
+        void setPresence(std::uint8_t value)
+        {
+            this->template set<schema::amp::presence>(value);
+        }
+
+        std::uint8_t getPresence() const
+        {
+            return this->template get<schema::amp::presence>();
+        }
+
+        void setDepth(std::uint8_t value)
+        {
+            this->template set<schema::amp::depth>(value);
+        }
 
-        void setKnob2(std::uint8_t value);
-        std::uint8_t getKnob2() const;
+        std::uint8_t getDepth() const
+        {
+            return this->template get<schema::amp::depth>();
+        }
+
+        void setBias(std::uint8_t value)
+        {
+            this->template set<schema::amp::bias>(value);
+        }
+
+        std::uint8_t getBias() const
+        {
+            return this->template get<schema::amp::bias>();
+        }
+
+        void setNoiseGate(std::uint8_t value)
+        {
+            this->template set<schema::amp::noiseGate>(value);
+        }
+
+        std::uint8_t getNoiseGate() const
+        {
+            return this->template get<schema::amp::noiseGate>();
+        }
+
+        void setThreshold(std::uint8_t value)
+        {
+            this->template set<schema::amp::threshold>(value);
+        }
+
+        std::uint8_t getThreshold() const
+        {
+            return this->template get<schema::amp::threshold>();
+        }
+
+        void setCabinet(std::uint8_t value)
+        {
+            this->template set<schema::amp::cabinet>(value);
+        }
+
+        std::uint8_t getCabinet() const
+        {
+            return this->template get<schema::amp::cabinet>();
+        }
+
+        void setSag(std::uint8_t value)
+        {
+            this->template set<schema::amp::sag>(value);
+        }
 
-        void setKnob3(std::uint8_t value);
-        std::uint8_t getKnob3() const;
+        std::uint8_t getSag() const
+        {
+            return this->template get<schema::amp::sag>();
+        }
 
-        void setKnob4(std::uint8_t value);
-        std::uint8_t getKnob4() const;
+        void setBrightness(std::uint8_t value)
+        {
+            this->template set<schema::amp::brightness>(value);
+        }
 
-        void setKnob5(std::uint8_t value);
-        std::uint8_t getKnob5() const;
+        std::uint8_t getBrightness() const
+        {
+            return this->template get<schema::amp::brightness>();
+        }
 
-        void setKnob6(std::uint8_t value);
-        std::uint8_t getKnob6() const;
+        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            this->template set<schema::amp::unknown0>(value0);
+            this->template set<schema::amp::unknown1>(value1);
+            this->template set<schema::amp::unknown2>(value2);
+        }
 
-        void setSlot(std::uint8_t slot);
-        std::uint8_t getSlot() const;
+        void setUnknownAmpSpecific(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2, std::uint8_t value3, std::uint8_t value4)
+        {
+            this->template set<schema::amp::ampSpecific0>(value0);
+            this->template set<schema::amp::ampSpecific1>(value1);
+            this->template set<schema::amp::ampSpecific2>(value2);
+            this->template set<schema::amp::ampSpecific3>(value3);
+            this->template set<schema::amp::ampSpecific4>(value4);
+        }
 
-        void setModel(std::uint8_t model);
-        std::uint8_t getModel() const;
+        void setUsbGain(std::uint8_t value)
+        {
+            this->template set<schema::amp::usbGain>(value);
+        }
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
+        std::uint8_t getUsbGain() const
+        {
+            return this->template get<schema::amp::usbGain>();
+        }
     };
 
 
-    class AmpPayload : public PayloadBase
+    class Header : public HeaderFields<Header>
     {
     public:
-        void setModel(std::uint8_t value);
-        std::uint8_t getModel() const;
+        using RawType = std::array<std::uint8_t, headerRawTypeSize>;
+        static constexpr const auto& fields{schema::header::fields};
 
-        void setVolume(std::uint8_t value);
-        std::uint8_t getVolume() const;
+        RawType getBytes() const;
+        void fromBytes(const RawType& data);
 
-        void setGain(std::uint8_t value);
-        std::uint8_t getGain() const;
+    private:
+        friend class FieldAccess<Header>;
 
-        void setGain2(std::uint8_t value);
-        std::uint8_t getGain2() const;
+        std::span<std::uint8_t, headerRawTypeSize> data()
+        {
+            return bytes;
+        }
 
-        void setMasterVolume(std::uint8_t value);
-        std::uint8_t getMasterVolume() const;
+        std::span<const std::uint8_t, headerRawTypeSize> data() const
+        {
+            return bytes;
+        }
 
-        void setTreble(std::uint8_t value);
-        std::uint8_t getTreble() const;
+        RawType bytes{{}};
+    };
 
-        void setMiddle(std::uint8_t value);
-        std::uint8_t getMiddle() const;
 
-        void setBass(std::uint8_t value);
-        std::uint8_t getBass() const;
+    class PayloadBase
+    {
+    public:
+        using RawType = std::array<std::uint8_t, payloadRawTypeSize>;
 
-        void setPresence(std::uint8_t value);
-        std::uint8_t getPresence() const;
+        RawType getBytes() const;
+        void fromBytes(const RawType& data);
+
+    protected:
+        std::span<std::uint8_t, payloadRawTypeSize> data()
+        {
+            return bytes;
+        }
+
+        std::span<const std::uint8_t, payloadRawTypeSize> data() const
+        {
+            return bytes;
+        }
 
-        void setDepth(std::uint8_t value);
-        std::uint8_t getDepth() const;
+        RawType bytes{{}};
+    };
 
-        void setBias(std::uint8_t value);
-        std::uint8_t getBias() const;
+    class EmptyPayload : public PayloadBase
+    {
+    public:
+        template <class Derived>
+        using Fields = EmptyFields<Derived>;
+        static constexpr const auto& fields{schema::empty::fields};
+    };
 
-        void setNoiseGate(std::uint8_t value);
-        std::uint8_t getNoiseGate() const;
+    class NamePayload : public PayloadBase, public NameFields<NamePayload>
+    {
+    public:
+        template <class Derived>
+        using Fields = NameFields<Derived>;
+        static constexpr const auto& fields{schema::name::fields};
 
-        void setThreshold(std::uint8_t value);
-        std::uint8_t getThreshold() const;
+    private:
+        friend class FieldAccess<NamePayload>;
+    };
 
-        void setCabinet(std::uint8_t value);
-        std::uint8_t getCabinet() const;
+    class EffectPayload : public PayloadBase, public EffectFields<EffectPayload>
+    {
+    public:
+        template <class Derived>
+        using Fields = EffectFields<Derived>;
+        static constexpr const auto& fields{schema::effect::fields};
 
-        void setSag(std::uint8_t value);
-        std::uint8_t getSag() const;
+    private:
+        friend class FieldAccess<EffectPayload>;
+    };
 
-        void setBrightness(std::uint8_t value);
-        std::uint8_t getBrightness() const;
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
-        void setUnknownAmpSpecific(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2, std::uint8_t value3, std::uint8_t value4);
+    class AmpPayload : public PayloadBase, public AmpFields<AmpPayload>
+    {
+    public:
+        template <class Derived>
+        using Fields = AmpFields<Derived>;
+        static constexpr const auto& fields{schema::amp::fields};
 
-        void setUsbGain(std::uint8_t value);
-        std::uint8_t getUsbGain() const;
+    private:
+        friend class FieldAccess<AmpPayload>;
     };
 
 
@@ -267,4 +640,118 @@ namespace plug::com
         Payload payload;
     };
 
+
+    // Non-owning access to the fields of a raw packet; Byte is const for
+    // read-only views
+    template <class Byte>
+    class BasicHeaderView : public HeaderFields<BasicHeaderView<Byte>>
+    {
+    public:
+        static constexpr const auto& fields{Header::fields};
+
+        constexpr explicit BasicHeaderView(std::span<Byte, headerRawTypeSize> bytes)
+            : bytes_(bytes)
+        {
+        }
+
+        constexpr std::span<Byte, headerRawTypeSize> getBytes() const
+        {
+            return bytes_;
+        }
+
+    private:
+        friend class FieldAccess<BasicHeaderView<Byte>>;
+
+        constexpr std::span<Byte, headerRawTypeSize> data() const
+        {
+            return bytes_;
+        }
+
+        std::span<Byte, headerRawTypeSize> bytes_;
+    };
+
+    template <class Payload, class Byte>
+    class BasicPayloadView : public Payload::template Fields<BasicPayloadView<Payload, Byte>>
+    {
+    public:
+        static constexpr const auto& fields{Payload::fields};
+
+        constexpr explicit BasicPayloadView(std::span<Byte, payloadRawTypeSize> bytes)
+            : bytes_(bytes)
+        {
+        }
+
+        constexpr std::span<Byte, payloadRawTypeSize> getBytes() const
+        {
+            return bytes_;
+        }
+
+    private:
+        friend class FieldAccess<BasicPayloadView<Payload, Byte>>;
+
+        constexpr std::span<Byte, payloadRawTypeSize> data() const
+        {
+            return bytes_;
+        }
+
+        std::span<Byte, payloadRawTypeSize> bytes_;
+    };
+
+    // Reads and writes the fields in place on a caller owned buffer, which
+    // has to outlive the view
+    template <class Payload, class Byte>
+    class BasicPacketView
+    {
+    public:
+        constexpr explicit BasicPacketView(std::span<Byte, packetRawTypeSize> bytes)
+            : bytes_(bytes)
+        {
+        }
+
+        constexpr BasicHeaderView<Byte> getHeader() const
+        {
+            return BasicHeaderView<Byte>{bytes_.template first<headerRawTypeSize>()};
+        }
+
+        constexpr BasicPayloadView<Payload, Byte> getPayload() const
+        {
+            return BasicPayloadView<Payload, Byte>{bytes_.template last<payloadRawTypeSize>()};
+        }
+
+        constexpr void clear() const
+        {
+            std::fill(bytes_.begin(), bytes_.end(), std::uint8_t{0});
+        }
+
+    private:
+        std::span<Byte, packetRawTypeSize> bytes_;
+    };
+
+    template <class Payload>
+    using PacketView = BasicPacketView<Payload, const std::uint8_t>;
+
+    template <class Payload>
+    using PacketSpan = BasicPacketView<Payload, std::uint8_t>;
+
+
+    // Field-wise equality, hash and diff of headers or payloads, either
+    // owning or views, as described by their schema
+    template <class Fields>
+    bool equalFields(const Fields& lhs, const Fields& rhs)
+    {
+        return schema::equal(Fields::fields, lhs.getBytes(), rhs.getBytes());
+    }
+
+    template <class Fields>
+    std::size_t hashFields(const Fields& value)
+    {
+        return schema::hash(Fields::fields, value.getBytes());
+    }
+
+    template <class Fields>
+    auto diffFields(const Fields& lhs, const Fields& rhs)
+    {
+        return schema::diff(Fields::fields, lhs.getBytes(), rhs.getBytes());
+    }
+
 }
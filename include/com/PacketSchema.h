@@ -0,0 +1,238 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace plug::com::schema
+{
+    // A field of the header or a payload, the offset is relative to the
+    // start of the header or payload respectively
+    struct Field
+    {
+        std::string_view name;
+        std::size_t offset;
+        std::size_t width{1};
+    };
+
+
+    namespace header
+    {
+        inline constexpr Field stage{"stage", 0};
+        inline constexpr Field type{"type", 1};
+        inline constexpr Field dsp{"dsp", 2};
+        inline constexpr Field unknown0{"unknown0", 3};
+        inline constexpr Field slot{"slot", 4};
+        inline constexpr Field unknown1{"unknown1", 6};
+        inline constexpr Field unknown2{"unknown2", 7};
+
+        inline constexpr std::array fields{stage, type, dsp, unknown0, slot, unknown1, unknown2};
+    }
+
+    namespace empty
+    {
+        inline constexpr std::array<Field, 0> fields{};
+    }
+
+    namespace name
+    {
+        inline constexpr Field name{"name", 0, 32};
+
+        inline constexpr std::array fields{name};
+    }
+
+    namespace effect
+    {
+        inline constexpr Field model{"model", 0};
+        inline constexpr Field slot{"slot", 2};
+        inline constexpr Field unknown0{"unknown0", 3};
+        inline constexpr Field unknown1{"unknown1", 4};
+        inline constexpr Field unknown2{"unknown2", 5};
+        inline constexpr Field knob1{"knob1", 16};
+        inline constexpr Field knob2{"knob2", 17};
+        inline constexpr Field knob3{"knob3", 18};
+        inline constexpr Field knob4{"knob4", 19};
+        inline constexpr Field knob5{"knob5", 20};
+        inline constexpr Field knob6{"knob6", 21};
+
+        inline constexpr std::array fields{model, slot, unknown0, unknown1, unknown2,
+                                           knob1, knob2, knob3, knob4, knob5, knob6};
+    }
+
+    // The usb gain packet reuses the model byte of the amp packet
+    namespace amp
+    {
+        inline constexpr Field model{"model", 0};
+        inline constexpr Field usbGain{"usbGain", 0};
+        inline constexpr Field volume{"volume", 16};
+        inline constexpr Field gain{"gain", 17};
+        inline constexpr Field gain2{"gain2", 18};
+        inline constexpr Field masterVolume{"masterVolume", 19};
+        inline constexpr Field treble{"treble", 20};
+        inline constexpr Field middle{"middle", 21};
+        inline constexpr Field bass{"bass", 22};
+        inline constexpr Field presence{"presence", 23};
+        inline constexpr Field unknown0{"unknown0", 24};
+        inline constexpr Field depth{"depth", 25};
+        inline constexpr Field bias{"bias", 26};
+        inline constexpr Field unknown1{"unknown1", 27};
+        inline constexpr Field ampSpecific0{"ampSpecific0", 28};
+        inline constexpr Field ampSpecific1{"ampSpecific1", 29};
+        inline constexpr Field ampSpecific2{"ampSpecific2", 30};
+        inline constexpr Field noiseGate{"noiseGate", 31};
+        inline constexpr Field threshold{"threshold", 32};
+        inline constexpr Field cabinet{"cabinet", 33};
+        inline constexpr Field ampSpecific3{"ampSpecific3", 34};
+        inline constexpr Field sag{"sag", 35};
+        inline constexpr Field brightness{"brightness", 36};
+        inline constexpr Field unknown2{"unknown2", 37};
+        inline constexpr Field ampSpecific4{"ampSpecific4", 38};
+
+        inline constexpr std::array fields{model, volume, gain, gain2, masterVolume, treble, middle, bass,
+                                           presence, unknown0, depth, bias, unknown1, ampSpecific0,
+                                           ampSpecific1, ampSpecific2, noiseGate, threshold, cabinet,
+                                           ampSpecific3, sag, brightness, unknown2, ampSpecific4};
+    }
+
+
+    // Fields have to fit into the size and must not overlap each other
+    template <std::size_t N>
+    constexpr bool isValidLayout(const std::array<Field, N>& fields, std::size_t size)
+    {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            if ((fields[i].width == 0) || (fields[i].offset + fields[i].width > size))
+            {
+                return false;
+            }
+
+            for (std::size_t j = i + 1; j < N; ++j)
+            {
+                if ((fields[i].offset < fields[j].offset + fields[j].width) && (fields[j].offset < fields[i].offset + fields[i].width))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <std::size_t N>
+    constexpr bool isSingleByte(const std::array<Field, N>& fields)
+    {
+        for (const auto& field : fields)
+        {
+            if (field.width != 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    constexpr std::uint8_t get(std::span<const std::uint8_t> bytes, const Field& field)
+    {
+        return bytes[field.offset];
+    }
+
+    constexpr void set(std::span<std::uint8_t> bytes, const Field& field, std::uint8_t value)
+    {
+        bytes[field.offset] = value;
+    }
+
+    // Bulk access to single byte fields, values are in schema order
+    template <std::size_t N>
+    constexpr std::array<std::uint8_t, N> decode(const std::array<Field, N>& fields, std::span<const std::uint8_t> bytes)
+    {
+        std::array<std::uint8_t, N> values{};
+
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            values[i] = get(bytes, fields[i]);
+        }
+        return values;
+    }
+
+    template <std::size_t N>
+    constexpr void encode(const std::array<Field, N>& fields, const std::array<std::uint8_t, N>& values, std::span<std::uint8_t> bytes)
+    {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            set(bytes, fields[i], values[i]);
+        }
+    }
+
+    // Equality, hash and diff only take the fields into account; bytes
+    // outside of the schema are ignored
+    template <std::size_t N>
+    constexpr bool equal(const std::array<Field, N>& fields, std::span<const std::uint8_t> lhs, std::span<const std::uint8_t> rhs)
+    {
+        for (const auto& field : fields)
+        {
+            for (std::size_t i = field.offset; i < field.offset + field.width; ++i)
+            {
+                if (lhs[i] != rhs[i])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // FNV-1a
+    template <std::size_t N>
+    constexpr std::size_t hash(const std::array<Field, N>& fields, std::span<const std::uint8_t> bytes)
+    {
+        std::uint64_t value{0xcbf29ce484222325};
+
+        for (const auto& field : fields)
+        {
+            for (std::size_t i = field.offset; i < field.offset + field.width; ++i)
+            {
+                value = (value ^ bytes[i]) * 0x100000001b3;
+            }
+        }
+        return static_cast<std::size_t>(value);
+    }
+
+    // Bit i is set if fields[i] differs
+    template <std::size_t N>
+    constexpr std::bitset<N> diff(const std::array<Field, N>& fields, std::span<const std::uint8_t> lhs, std::span<const std::uint8_t> rhs)
+    {
+        static_assert(N <= 64);
+        std::uint64_t changed{0};
+
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            if (!equal(std::array{fields[i]}, lhs, rhs))
+            {
+                changed |= (std::uint64_t{1} << i);
+            }
+        }
+        return std::bitset<N>{changed};
+    }
+}
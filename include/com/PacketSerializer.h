@@ -42,6 +42,13 @@ namespace plug::com
     std::string decodeNameFromData(const Packet<NamePayload>& packet);
     amp_settings decodeAmpFromData(const Packet<AmpPayload>& packet, const Packet<AmpPayload>& packetUsbGain);
 
+    fx_pedal_settings decodeEffectFromData(const Packet<EffectPayload>& packet);
+
+    // Decode straight from the received bytes
+    std::string decodeNameFromData(PacketView<NamePayload> packet);
+    amp_settings decodeAmpFromData(PacketView<AmpPayload> packet, PacketView<AmpPayload> packetUsbGain);
+    fx_pedal_settings decodeEffectFromData(PacketView<EffectPayload> packet);
+
     std::vector<fx_pedal_settings> decodeEffectsFromData(const std::array<Packet<EffectPayload>, 4>& packet);
     std::vector<std::string> decodePresetListFromData(const std::vector<Packet<NamePayload>>& packet);
 
@@ -60,4 +67,12 @@ namespace plug::com
 
     std::array<Packet<EmptyPayload>, 2> serializeInitCommand();
 
+    // Serialize in place into a caller owned packet, which is overwritten
+    void serializeAmpSettings(const amp_settings& value, PacketSpan<AmpPayload> packet);
+    void serializeAmpSettingsUsbGain(const amp_settings& value, PacketSpan<AmpPayload> packet);
+    void serializeName(std::uint8_t slot, std::string_view name, PacketSpan<NamePayload> packet);
+    void serializeEffectSettings(const fx_pedal_settings& value, PacketSpan<EffectPayload> packet);
+    void serializeClearEffectSettings(const fx_pedal_settings& effect, PacketSpan<EffectPayload> packet);
+    void serializeApplyCommand(PacketSpan<EmptyPayload> packet);
+
 }
@@ -0,0 +1,49 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace plug::com
+{
+    // Decoded preset banks per slot; safe to use from multiple threads
+    class PresetCache
+    {
+    public:
+        explicit PresetCache(std::size_t numberOfSlots = 0);
+
+        void reset(std::size_t numberOfSlots);
+        std::size_t size() const;
+
+        std::optional<SignalChain> get(std::uint8_t slot) const;
+        bool contains(std::uint8_t slot) const;
+        void put(std::uint8_t slot, const SignalChain& signalChain);
+        void invalidate(std::uint8_t slot);
+
+    private:
+        mutable std::mutex mutex;
+        std::vector<std::optional<SignalChain>> slots;
+    };
+}
@@ -0,0 +1,54 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "DeviceModel.h"
+#include "EffectPreset.h"
+#include <filesystem>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace plug::com
+{
+    // Last seen contents of an amplifier, kept between sessions
+    struct CachedState
+    {
+        std::vector<std::string> presetNames;
+        SignalChain signalChain;
+        std::vector<std::optional<SignalChain>> banks;
+        std::vector<EffectPreset> effectPresets;
+    };
+
+    // The device name is the USB product string; together with the model
+    // it identifies the vendor / product id. The identity (serial number or
+    // port) keeps amps of the same model apart.
+    std::string stateCacheKey(const DeviceModel& model, const std::string& deviceName, const std::string& deviceIdentity);
+
+    void writeStateCache(std::ostream& stream, const std::string& key, const CachedState& state);
+    std::optional<CachedState> readStateCache(std::istream& stream, const std::string& key);
+
+    // A missing, foreign or damaged cache file is reported as no cache
+    void saveStateCache(const std::filesystem::path& directory, const std::string& key, const CachedState& state);
+    std::optional<CachedState> loadStateCache(const std::filesystem::path& directory, const std::string& key);
+}
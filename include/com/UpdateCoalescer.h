@@ -0,0 +1,99 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data_structs.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace plug::com
+{
+    class TokenBucket
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TokenBucket(std::size_t capacity, Clock::duration refillInterval, Clock::time_point now);
+
+        bool tryConsume(Clock::time_point now);
+        Clock::duration waitTime(Clock::time_point now);
+        void setRefillInterval(Clock::duration value);
+        Clock::duration refillInterval() const;
+
+    private:
+        void refill(Clock::time_point now);
+
+        const double maxTokens;
+        double tokens;
+        Clock::duration interval;
+        Clock::time_point last;
+    };
+
+
+    struct CoalescingStats
+    {
+        std::uint64_t coalesced;
+        std::uint64_t dropped;
+    };
+
+    struct PendingUpdates
+    {
+        std::optional<amp_settings> amp;
+        std::vector<fx_pedal_settings> effects;
+        TokenBucket::Clock::time_point lastUpdate;
+
+        std::size_t size() const
+        {
+            return (amp ? 1 : 0) + effects.size();
+        }
+    };
+
+
+    // Keeps only the latest update per target, the amp or an effect DSP;
+    // an empty effect clears its slot and replaces the updates pending for
+    // that slot. Safe to use from multiple threads.
+    class UpdateCoalescer
+    {
+    public:
+        UpdateCoalescer();
+
+        // Returns true if nothing was pending before
+        bool push(amp_settings value, TokenBucket::Clock::time_point now = TokenBucket::Clock::now());
+        bool push(fx_pedal_settings value, TokenBucket::Clock::time_point now = TokenBucket::Clock::now());
+
+        PendingUpdates take();
+        void drop(std::size_t count);
+
+        CoalescingStats stats() const;
+
+    private:
+        bool isEmpty() const;
+
+        mutable std::mutex mutex;
+        std::optional<amp_settings> amp;
+        std::vector<fx_pedal_settings> effects;
+        TokenBucket::Clock::time_point lastUpdate;
+        CoalescingStats counters;
+    };
+}
@@ -22,6 +22,9 @@
 
 #include "com/Connection.h"
 #include <com/UsbDevice.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
 
 
 namespace plug::com
@@ -30,19 +33,26 @@ namespace plug::com
     class UsbComm : public Connection
     {
     public:
-        UsbComm(usb::Device device);
+        UsbComm(usb::Device device, std::chrono::milliseconds receiveTimeout = defaultReceiveTimeout);
 
         void close() override;
         bool isOpen() const override;
 
-        std::vector<std::uint8_t> receive(std::size_t recvSize) override;
+        std::size_t sendBatch(std::span<const PacketRawType> packets) override;
+        std::size_t receiveInto(std::span<std::uint8_t> buffer) override;
+        void setReceiveTimeout(std::chrono::milliseconds timeout) override;
+        void discardReceived() override;
 
         std::string name() const override;
+        std::string identity() const override;
 
     private:
-        std::size_t sendImpl(std::uint8_t* data, std::size_t size) override;
+        struct ReceiveQueue;
+
+        std::size_t sendImpl(const std::uint8_t* data, std::size_t size) override;
 
         usb::Device device_;
-        const std::string name_;
+        std::shared_ptr<ReceiveQueue> received_;
+        std::atomic<std::chrono::milliseconds> receiveTimeout_;
     };
 }
@@ -21,24 +21,44 @@
 #pragma once
 
 #include <com/UsbDevice.h>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
+struct libusb_context;
+
 namespace plug::com::usb
 {
+    namespace detail
+    {
+        void releaseContext(libusb_context* context);
+    }
+
+
+    // Owns a libusb context of its own; sessions on different contexts do
+    // not share devices or event handling
     class Context
     {
     public:
         Context();
         Context(const Context&) = delete;
-        ~Context();
+
+        libusb_context* get() const noexcept;
 
         Context& operator=(const Context&) = delete;
 
     private:
-        void init();
-        void deinit();
+        static libusb_context* init();
+
+        Ressource<libusb_context, detail::releaseContext> context_;
     };
 
-    std::vector<Device> listDevices();
+    using DeviceFilter = std::function<bool(std::uint16_t vendorId, std::uint16_t productId)>;
+
+    std::vector<Device> listDevices(libusb_context* context);
+
+    // Reads each descriptor once and opens no handles; devices are created
+    // for matches only and devices without a descriptor are skipped
+    std::vector<Device> listDevices(libusb_context* context, const DeviceFilter& filter);
 
 }
@@ -20,13 +20,16 @@
 
 #pragma once
 
+#include "com/UsbTransport.h"
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <memory>
 
+struct libusb_context;
 struct libusb_device;
 struct libusb_device_handle;
+struct libusb_device_descriptor;
 
 namespace plug::com::usb
 {
@@ -48,13 +51,15 @@ namespace plug::com::usb
     {
         void releaseDevice(libusb_device* device);
         void releaseHandle(libusb_device_handle* handle);
+        void releaseTransport(Transport* transport);
     }
 
 
     class Device
     {
     public:
-        explicit Device(libusb_device* device);
+        Device(libusb_context* context, libusb_device* device);
+        Device(libusb_context* context, libusb_device* device, const libusb_device_descriptor& descriptor);
         Device(Device&&) = default;
 
         void open();
@@ -64,10 +69,16 @@ namespace plug::com::usb
         std::uint16_t vendorId() const noexcept;
         std::uint16_t productId() const noexcept;
         std::string name() const;
+        std::string serialNumber() const;
+        std::string location() const;
 
         std::size_t write(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize);
         std::vector<std::uint8_t> receive(std::uint8_t endpoint, std::size_t dataSize);
 
+        PendingWrite writeAsync(std::uint8_t endpoint, std::span<const std::uint8_t> data);
+        void startReceiving(std::uint8_t endpoint, std::size_t packetSize, ReceiveHandler handler);
+        void stopReceiving();
+
         Device& operator=(Device&&) = default;
 
 
@@ -77,12 +88,17 @@ namespace plug::com::usb
             std::uint16_t vid;
             std::uint16_t pid;
             std::uint8_t stringDescriptorIndex;
+            std::uint8_t serialNumberIndex;
         };
 
         Descriptor getDeviceDescriptor(libusb_device* device) const;
+        std::string readString(std::uint8_t index) const;
+        Transport& transport();
 
+        libusb_context* context_;
         Ressource<libusb_device, detail::releaseDevice> device_;
         Ressource<libusb_device_handle, detail::releaseHandle> handle_;
+        Ressource<Transport, detail::releaseTransport> transport_;
         Descriptor descriptor_;
     };
 }
@@ -0,0 +1,85 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/UsbDevice.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace plug::com::usb
+{
+    class EventThread;
+
+    enum class HotplugEvent
+    {
+        arrived,
+        left
+    };
+
+    // Invoked on the libusb event or the polling thread; must not block
+    using HotplugHandler = std::function<void(HotplugEvent event, std::uint16_t productId)>;
+
+
+    namespace detail
+    {
+        void releaseEventThread(EventThread* thread);
+    }
+
+
+    // Reports devices of a vendor and a set of products being plugged in or
+    // removed; the device list is polled if libusb has no hotplug support
+    class HotplugMonitor
+    {
+    public:
+        HotplugMonitor(libusb_context* context, std::uint16_t vendorId, const std::vector<std::uint16_t>& productIds, HotplugHandler handler,
+                       std::chrono::milliseconds pollInterval = std::chrono::milliseconds{1000});
+        HotplugMonitor(const HotplugMonitor&) = delete;
+        ~HotplugMonitor();
+
+        bool isPolling() const noexcept;
+
+        HotplugMonitor& operator=(const HotplugMonitor&) = delete;
+
+    private:
+        void deviceChanged(HotplugEvent event, std::uint16_t vendorId, std::uint16_t productId);
+        std::multiset<std::uint16_t> scan() const;
+        void poll();
+
+        libusb_context* const context_;
+        const std::uint16_t vendorId_;
+        const std::vector<std::uint16_t> productIds_;
+        const HotplugHandler handler_;
+        const std::chrono::milliseconds pollInterval_;
+        int callbackHandle_;
+        Ressource<EventThread, detail::releaseEventThread> eventThread_;
+        std::mutex mutex_;
+        std::condition_variable stopped_;
+        bool running_;
+        std::multiset<std::uint16_t> present_;
+        std::thread pollThread_;
+    };
+}
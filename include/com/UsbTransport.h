@@ -0,0 +1,143 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <thread>
+#include <vector>
+
+struct libusb_context;
+struct libusb_device_handle;
+struct libusb_transfer;
+
+namespace plug::com::usb
+{
+    // Invoked on the event thread for every completed IN transfer; error is
+    // set (and data empty) if the transfer failed
+    using ReceiveHandler = std::function<void(std::span<const std::uint8_t> data, std::exception_ptr error)>;
+
+
+    // Handles libusb events of a context until destroyed
+    class EventThread
+    {
+    public:
+        explicit EventThread(libusb_context* context);
+        EventThread(const EventThread&) = delete;
+        ~EventThread();
+
+        EventThread& operator=(const EventThread&) = delete;
+
+    private:
+        std::atomic<bool> running_;
+        std::thread thread_;
+    };
+
+
+    // Asynchronous interrupt transfers on an open device handle; the IN
+    // endpoint is kept armed with two transfers while receiving
+    class PendingWrite;
+
+
+    class Transport
+    {
+    public:
+        Transport(libusb_context* context, libusb_device_handle* handle);
+        Transport(const Transport&) = delete;
+        ~Transport();
+
+        PendingWrite write(std::uint8_t endpoint, std::span<const std::uint8_t> data);
+
+        void startReceiving(std::uint8_t endpoint, std::size_t packetSize, ReceiveHandler handler);
+        void stopReceiving();
+        bool isReceiving();
+
+        Transport& operator=(const Transport&) = delete;
+
+
+    private:
+        struct WriteRequest;
+        friend class PendingWrite;
+
+        int submit(libusb_transfer* transfer);
+        std::shared_ptr<WriteRequest> acquireWriteRequest();
+        void recycle(std::shared_ptr<WriteRequest> request);
+        void writeCompleted(WriteRequest& request);
+        void cancel(bool readsOnly);
+        void finished(libusb_transfer* transfer);
+        void readCompleted(libusb_transfer* transfer);
+
+        static void onWriteCompleted(libusb_transfer* transfer);
+        static void onReadCompleted(libusb_transfer* transfer);
+
+        EventThread eventThread_;
+        libusb_device_handle* handle_;
+        std::mutex mutex_;
+        std::condition_variable idle_;
+        std::set<libusb_transfer*> inFlight_;
+        bool receiving_;
+        ReceiveHandler receiveHandler_;
+        std::array<std::vector<std::uint8_t>, 2> readBuffers_;
+        std::vector<std::shared_ptr<WriteRequest>> writeRequests_;
+        std::vector<std::shared_ptr<WriteRequest>> writePool_;
+    };
+
+
+    // Result of a write; get() waits for the transfer to complete and returns
+    // the number of bytes written. The request goes back to the transport's
+    // pool once the result is taken or the handle is destroyed
+    class PendingWrite
+    {
+    public:
+        PendingWrite() = default;
+        explicit PendingWrite(std::size_t transferred);
+        explicit PendingWrite(std::exception_ptr error);
+        PendingWrite(PendingWrite&& other) noexcept;
+        PendingWrite(const PendingWrite&) = delete;
+        ~PendingWrite();
+
+        std::size_t get();
+
+        PendingWrite& operator=(PendingWrite&& other) noexcept;
+        PendingWrite& operator=(const PendingWrite&) = delete;
+
+
+    private:
+        friend class Transport;
+
+        explicit PendingWrite(std::shared_ptr<Transport::WriteRequest> request);
+
+        void takeResult();
+
+        std::shared_ptr<Transport::WriteRequest> request_;
+        std::size_t transferred_{0};
+        std::exception_ptr error_;
+    };
+}
@@ -48,6 +48,8 @@ namespace plug
         Amplifier(const Amplifier&) = delete;
         ~Amplifier() override;
 
+        void set_changed(bool);
+
         Amplifier& operator=(const Amplifier&) = delete;
 
     private:
@@ -57,7 +59,9 @@ namespace plug
         unsigned char gain, volume, treble, middle, bass;
         cabinets cabinet;
         unsigned char noise_gate, presence, gain2, master_vol, threshold, depth, bias, sag, usb_gain;
-        bool changed, brightness;
+        bool changed, brightness, loading;
+
+        void send_live();
 
     public slots:
         // set basic variables
@@ -23,9 +23,11 @@
 
 #include "data_structs.h"
 #include "effects_enum.h"
+#include "EffectPreset.h"
 #include "FxSlot.h"
 #include <QMainWindow>
 #include <memory>
+#include <vector>
 
 namespace Ui
 {
@@ -48,12 +50,14 @@ namespace plug
         bool get_changed() const;
 
         fx_pedal_settings getSettings() const;
+        void load_presets(const std::vector<EffectPreset>& presets);
 
         Effect& operator=(const Effect&) = delete;
 
     private:
         void setTitleTexts(int slotNumber, const QString& name);
         void setDialValues(int d1, int d2, int d3, int d4, int d5, int d6);
+        void send_live();
 
         const std::unique_ptr<Ui::Effect> ui;
         FxSlot slot;
@@ -66,6 +70,8 @@ namespace plug
         unsigned char knob6;
         bool enabled;
         bool changed;
+        bool loading;
+        std::vector<fx_pedal_settings> presetEffects;
         QString temp1;
         QString temp2;
 
@@ -86,6 +92,7 @@ namespace plug
 
         void load(fx_pedal_settings);
         void load_default_fx();
+        void recall_preset(int);
 
         void showAndActivate();
     };
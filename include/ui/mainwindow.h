@@ -22,9 +22,18 @@
 #pragma once
 
 #include "data_structs.h"
+#include "EffectPreset.h"
 #include <QMainWindow>
 #include <array>
+#include <exception>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class QProgressBar;
+class QProgressDialog;
+struct libusb_context;
 
 namespace Ui
 {
@@ -41,10 +50,23 @@ namespace plug
     class LoadFromAmp;
     class Settings;
     class QuickPresets;
+    class SignalChain;
+    class DeviceModel;
 
     namespace com
     {
-        class Mustang;
+        class MustangWorker;
+        class MustangUpdater;
+        class PresetCache;
+        class EffectPresetTable;
+        struct InitialData;
+        struct CachedState;
+
+        namespace usb
+        {
+            class HotplugMonitor;
+            enum class HotplugEvent;
+        }
     }
 }
 
@@ -57,7 +79,7 @@ namespace plug
         Q_OBJECT
 
     public:
-        explicit MainWindow(QWidget* parent = nullptr);
+        explicit MainWindow(libusb_context* context, QWidget* parent = nullptr);
         MainWindow(const MainWindow&) = delete;
         ~MainWindow() override;
 
@@ -79,14 +101,37 @@ namespace plug
         void change_title(const QString&);
         void update_firmware();
         void empty_other(int, Effect*);
+        void recall_effect_preset(EffectKnob knob, std::uint8_t slot);
 
     private:
+        void send_settings(std::optional<amp_settings> amplifier_settings, const std::vector<Effect*>& components);
+        void connect_started(std::size_t numberOfPresets, const std::string& key, const std::optional<com::CachedState>& cached);
+        void show_cached_state(const com::CachedState& state);
+        void store_state();
+        void device_changed(com::usb::HotplugEvent event);
+        void preset_name_received(std::size_t slot, const std::string& name);
+        void amp_started(const com::InitialData& initialData, const DeviceModel& model);
+        void bank_loaded(const SignalChain& signalChain);
+        void bank_saved(int slot, const SignalChain& signalChain);
+        void effect_saved(const EffectPreset& preset);
+        void effect_presets_changed();
+        void firmware_progress(std::size_t packetsSent, std::size_t packetsTotal);
+        void firmware_cancel_requested();
+        void firmware_updated(std::exception_ptr error);
+
         const std::unique_ptr<Ui::MainWindow> ui;
+        libusb_context* const usbContext;
 
         QString current_name;
         std::vector<std::string> presetNames;
+        std::string deviceKey;
         bool connected;
-        std::unique_ptr<com::Mustang> amp_ops;
+        bool reconnect;
+        const std::unique_ptr<com::PresetCache> presetCache;
+        const std::unique_ptr<com::EffectPresetTable> effectPresetTable;
+        std::unique_ptr<com::MustangWorker> worker;
+        std::unique_ptr<com::usb::HotplugMonitor> deviceMonitor;
+        std::unique_ptr<com::MustangUpdater> updater;
         Amplifier* amp;
         std::array<Effect*, 8> effectComponents;
         SaveOnAmp* save;
@@ -95,6 +140,8 @@ namespace plug
         Settings* settings_win;
         SaveToFile* saver;
         QuickPresets* quickpres;
+        QProgressBar* connectProgress;
+        QProgressDialog* firmwareProgress;
 
     private slots:
         void about();
@@ -103,9 +150,13 @@ namespace plug
         void show_library();
         void show_default_effects();
         void loadPreset(std::size_t number);
+        void show_error(const QString& message);
+        void show_latency(double milliseconds);
 
 
     signals:
         void started();
+        void deviceError(const QString& message);
+        void updateSent(double latencyMilliseconds);
     };
 }
@@ -41,6 +41,8 @@ namespace plug
         explicit QuickPresets(QWidget* parent = nullptr);
 
         void load_names(const std::vector<std::string>& names);
+        void add_name(std::size_t slot, const std::string& name);
+        void select_defaults();
         void delete_items();
         void change_name(int, QString*);
 
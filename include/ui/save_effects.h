@@ -21,8 +21,12 @@
 
 #pragma once
 
+#include "EffectPreset.h"
 #include <QDialog>
+#include <QStringList>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace Ui
 {
@@ -41,14 +45,24 @@ namespace plug
         SaveEffects(const SaveEffects&) = delete;
         ~SaveEffects() override;
 
+        void load_presets(const std::vector<EffectPreset>& effectPresets);
+
         SaveEffects& operator=(const SaveEffects&) = delete;
 
 
     private:
+        EffectKnob selected_knob() const;
+        std::optional<EffectPreset> selected_preset() const;
+        void update_names();
+
         const std::unique_ptr<Ui::Save_effects> ui;
+        QStringList slotNames;
+        std::vector<EffectPreset> presets;
 
     private slots:
         void select_checkbox();
+        void select_slot(int);
         void send();
+        void recall();
     };
 }
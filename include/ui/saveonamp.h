@@ -43,12 +43,14 @@ namespace plug
         ~SaveOnAmp() override;
 
         void load_names(const std::vector<std::string>& names);
+        void add_name(std::size_t slot, const std::string& name);
         void delete_items();
 
         SaveOnAmp& operator=(const SaveOnAmp&) = delete;
 
     public slots:
         void change_index(int, const QString&);
+        void change_name(int, QString*);
 
     private:
         const std::unique_ptr<Ui::SaveOnAmp> ui;
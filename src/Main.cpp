@@ -34,7 +34,7 @@ int main(int argc, char* argv[])
 
     plug::com::usb::Context context{};
 
-    plug::MainWindow window;
+    plug::MainWindow window{context.get()};
     window.show();
 
     return app.exec();
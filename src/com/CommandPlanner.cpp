@@ -0,0 +1,231 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/CommandPlanner.h"
+#include "com/PacketSerializer.h"
+#include "com/IdLookup.h"
+#include <algorithm>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Packets sent if each setting is written on its own:
+        // clear, apply, settings, apply
+        inline constexpr std::size_t packetsPerWrite{4};
+        inline constexpr std::size_t packetsPerClear{2};
+
+        // Any model of a DSP can be used to clear it
+        inline constexpr std::array<effects, 4> clearModels{{effects::OVERDRIVE, effects::SINE_CHORUS,
+                                                             effects::MONO_DELAY, effects::SMALL_HALL_REVERB}};
+
+        bool isCleared(const fx_pedal_settings& effect)
+        {
+            return (effect.enabled == false) || (effect.effect_num == effects::EMPTY);
+        }
+
+        // Serializes straight into the raw packet that gets queued or compared
+        template <class Payload, class Value>
+        PacketRawType toBytes(void (*serialize)(const Value&, PacketSpan<Payload>), const Value& value)
+        {
+            PacketRawType bytes;
+            serialize(value, PacketSpan<Payload>{bytes});
+            return bytes;
+        }
+
+        // Packets are compared by the fields of their schema only
+        template <class Payload>
+        bool isSamePacket(const PacketRawType& lhs, const PacketRawType& rhs)
+        {
+            const PacketView<Payload> lhsView{lhs};
+            const PacketView<Payload> rhsView{rhs};
+            return equalFields(lhsView.getHeader(), rhsView.getHeader()) && equalFields(lhsView.getPayload(), rhsView.getPayload());
+        }
+
+        std::uint8_t dspId(const PacketRawType& packet)
+        {
+            return PacketView<EmptyPayload>{packet}.getHeader().get<schema::header::dsp>();
+        }
+    }
+
+
+    std::optional<std::size_t> effectDspIndex(const fx_pedal_settings& effect)
+    {
+        switch (lookupEffect(effect.effect_num).dsp)
+        {
+            case DSP::effect0:
+                return 0;
+            case DSP::effect1:
+                return 1;
+            case DSP::effect2:
+                return 2;
+            case DSP::effect3:
+                return 3;
+            default:
+                return {};
+        }
+    }
+
+    // Effects are mapped by their DSP; empty effects by their position,
+    // as in the effect packets of a preset
+    DspState toDspState(const SignalChain& signalChain)
+    {
+        DspState state{signalChain.amp(), {}};
+        const auto effects = signalChain.effects();
+
+        for (std::size_t i = 0; i < std::min(effects.size(), state.effects.size()); ++i)
+        {
+            if (!effectDspIndex(effects[i]))
+            {
+                state.effects[i] = effects[i];
+            }
+        }
+
+        std::for_each(effects.cbegin(), effects.cend(), [&state](const auto& effect)
+                      {
+                          if (const auto index = effectDspIndex(effect); index)
+                          {
+                              state.effects[*index] = effect;
+                          } });
+        return state;
+    }
+
+    // Clears go first and are applied together, followed by all settings
+    // packets in DSP order and a single apply
+    CommandPlan planCommands(const DspState& current, const std::optional<amp_settings>& amp, std::span<const fx_pedal_settings> effects)
+    {
+        auto state = current;
+        std::vector<PacketRawType> clears;
+        std::vector<PacketRawType> writes;
+        std::size_t naivePackets{0};
+
+        if (amp)
+        {
+            const auto& currentAmp = state.amp;
+
+            if (const auto settingsPacket = toBytes(serializeAmpSettings, *amp); !currentAmp || !isSamePacket<AmpPayload>(toBytes(serializeAmpSettings, *currentAmp), settingsPacket))
+            {
+                writes.push_back(settingsPacket);
+            }
+
+            if (const auto usbGainPacket = toBytes(serializeAmpSettingsUsbGain, *amp); !currentAmp || !isSamePacket<AmpPayload>(toBytes(serializeAmpSettingsUsbGain, *currentAmp), usbGainPacket))
+            {
+                writes.push_back(usbGainPacket);
+            }
+            state.amp = amp;
+            naivePackets += packetsPerWrite;
+        }
+
+        for (const auto& value : effects)
+        {
+            const auto index = effectDspIndex(value);
+            const std::optional<fx_pedal_settings> currentEffect = index ? state.effects[*index] : std::nullopt;
+            const bool sameEffect = currentEffect && !isCleared(*currentEffect) && !isCleared(value) && (currentEffect->effect_num == value.effect_num) && (currentEffect->slot.id() == value.slot.id());
+
+            if (!sameEffect && !(currentEffect && isCleared(*currentEffect) && isCleared(value)))
+            {
+                clears.push_back(toBytes(serializeClearEffectSettings, value));
+            }
+
+            if (!isCleared(value))
+            {
+                if (const auto settingsPacket = toBytes(serializeEffectSettings, value); !sameEffect || !isSamePacket<EffectPayload>(toBytes(serializeEffectSettings, *currentEffect), settingsPacket))
+                {
+                    writes.push_back(settingsPacket);
+                }
+            }
+
+            if (index)
+            {
+                state.effects[*index] = value;
+            }
+            else
+            {
+                std::for_each(state.effects.begin(), state.effects.end(), [&value](auto& effect)
+                              {
+                                  if (effect && (effect->slot.id() == value.slot.id()))
+                                  {
+                                      effect.reset();
+                                  } });
+            }
+            naivePackets += isCleared(value) ? packetsPerClear : packetsPerWrite;
+        }
+
+        const auto byDsp = [](const PacketRawType& lhs, const PacketRawType& rhs)
+        { return dspId(lhs) < dspId(rhs); };
+        std::stable_sort(clears.begin(), clears.end(), byDsp);
+        std::stable_sort(writes.begin(), writes.end(), byDsp);
+
+        PacketRawType applyCommand;
+        serializeApplyCommand(PacketSpan<EmptyPayload>{applyCommand});
+        std::vector<PacketRawType> commands;
+        commands.reserve(clears.size() + writes.size() + 2);
+
+        for (const auto* phase : {&clears, &writes})
+        {
+            if (!phase->empty())
+            {
+                commands.insert(commands.end(), phase->cbegin(), phase->cend());
+                commands.push_back(applyCommand);
+            }
+        }
+
+        const std::size_t saved = naivePackets > commands.size() ? naivePackets - commands.size() : 0;
+        return CommandPlan{std::move(commands), state, saved};
+    }
+
+    // DSPs without an effect in the target are cleared unless known to be
+    // cleared already
+    CommandPlan planSignalChain(const DspState& current, const SignalChain& target)
+    {
+        const auto targetState = toDspState(target);
+        std::vector<fx_pedal_settings> effects;
+        effects.reserve(targetState.effects.size());
+
+        for (std::size_t i = 0; i < targetState.effects.size(); ++i)
+        {
+            const auto& effect = targetState.effects[i];
+
+            if (effect && effectDspIndex(*effect))
+            {
+                effects.push_back(*effect);
+            }
+            else if (const auto& currentEffect = current.effects[i]; !currentEffect || !isCleared(*currentEffect))
+            {
+                const auto slot = effect ? effect->slot : FxSlot{static_cast<std::uint8_t>(i)};
+                effects.push_back(fx_pedal_settings{slot, clearModels[i], 0, 0, 0, 0, 0, 0, false});
+            }
+        }
+
+        return planCommands(current, target.amp(), effects);
+    }
+
+    CommandPlan planSignalChain(const SignalChain& current, const SignalChain& target)
+    {
+        return planSignalChain(toDspState(current), target);
+    }
+
+    // Banks are the same if the amp would not need a single write to get
+    // from one to the other
+    bool isSameBank(const SignalChain& lhs, const SignalChain& rhs)
+    {
+        return (lhs.name() == rhs.name()) && planSignalChain(lhs, rhs).commands.empty();
+    }
+}
@@ -43,6 +43,17 @@ namespace plug::com
             inline constexpr std::uint16_t mustangIII_IV_V_v2{0x0016};
         }
 
+        // PIDs while in firmware update mode
+        namespace usbUpdatePID
+        {
+            inline constexpr std::uint16_t mustangI_II{0x0006};
+            inline constexpr std::uint16_t mustangIII_IV_V{0x0007};
+            inline constexpr std::uint16_t mustangMini{0x0011};
+            inline constexpr std::uint16_t mustangFloor{0x0013};
+            inline constexpr std::uint16_t mustangI_II_v2{0x0015};
+            inline constexpr std::uint16_t mustangIII_IV_V_v2{0x0017};
+        }
+
         inline constexpr std::initializer_list<std::uint16_t> pids{
             usbPID::mustangI_II,
             usbPID::mustangIII_IV_V,
@@ -52,12 +63,30 @@ namespace plug::com
             usbPID::mustangI_II_v2,
             usbPID::mustangIII_IV_V_v2};
 
+        inline constexpr std::initializer_list<std::uint16_t> updatePids{
+            usbUpdatePID::mustangI_II,
+            usbUpdatePID::mustangIII_IV_V,
+            usbUpdatePID::mustangMini,
+            usbUpdatePID::mustangFloor,
+            usbUpdatePID::mustangI_II_v2,
+            usbUpdatePID::mustangIII_IV_V_v2};
+
+        bool isSupported(std::uint16_t vid, std::uint16_t pid)
+        {
+            return (vid == usbVID) && (std::find(pids.begin(), pids.end(), pid) != pids.end());
+        }
+
+        bool isUpdateMode(std::uint16_t vid, std::uint16_t pid)
+        {
+            return (vid == usbVID) && (std::find(updatePids.begin(), updatePids.end(), pid) != updatePids.end());
+        }
+
         DeviceModel getModel(std::uint16_t pid)
         {
             switch (pid)
             {
                 case usbPID::mustangI_II:
-                    return DeviceModel{"Mustang I/II", DeviceModel::Category::MustangV1, 24};
+                    return DeviceModel{"Mustang I/II", DeviceModel::Category::MustangV1, 24, 12};
                 case usbPID::mustangIII_IV_V:
                     return DeviceModel{"Mustang III/IV/V", DeviceModel::Category::MustangV1, 100};
                 case usbPID::mustangBronco:
@@ -67,7 +96,7 @@ namespace plug::com
                 case usbPID::mustangFloor:
                     return DeviceModel{"Mustang Floor", DeviceModel::Category::MustangV1, 0};
                 case usbPID::mustangI_II_v2:
-                    return DeviceModel{"Mustang I/II", DeviceModel::Category::MustangV2, 24};
+                    return DeviceModel{"Mustang I/II", DeviceModel::Category::MustangV2, 24, 12};
                 case usbPID::mustangIII_IV_V_v2:
                     return DeviceModel{"Mustang III/IV/V", DeviceModel::Category::MustangV2, 100};
                 default:
@@ -77,19 +106,58 @@ namespace plug::com
 
     }
 
-    std::unique_ptr<Mustang> connect()
+    std::unique_ptr<Mustang> connect(libusb_context* context)
     {
-        auto devices = usb::listDevices();
+        auto devices = usb::listDevices(context, isSupported);
+
+        if (devices.empty())
+        {
+            throw CommunicationException{"No device found"};
+        }
 
-        auto itr = std::find_if(devices.begin(), devices.end(), [](const auto& dev)
-                                { return (dev.vendorId() == usbVID) && std::any_of(pids.begin(), pids.end(), [&dev](std::uint16_t pid)
-                                                                                   { return dev.productId() == pid; }); });
+        auto& device = devices.front();
+        return std::make_unique<Mustang>(getModel(device.productId()), std::make_shared<UsbComm>(std::move(device)));
+    }
 
-        if (itr == devices.end())
+    std::vector<std::unique_ptr<Mustang>> connectAll(libusb_context* context, std::chrono::milliseconds receiveTimeout)
+    {
+        auto devices = usb::listDevices(context, isSupported);
+        std::vector<std::unique_ptr<Mustang>> amps;
+        amps.reserve(devices.size());
+
+        std::for_each(devices.begin(), devices.end(), [&amps, receiveTimeout](auto& device)
+                      {
+            const auto model = getModel(device.productId());
+
+            try
+            {
+                amps.push_back(std::make_unique<Mustang>(model, std::make_shared<UsbComm>(std::move(device), receiveTimeout)));
+            }
+            catch (const std::exception&)
+            {
+            } });
+
+        if (amps.empty())
         {
             throw CommunicationException{"No device found"};
         }
-        return std::make_unique<Mustang>(getModel(itr->productId()), std::make_shared<UsbComm>(std::move(*itr)));
+        return amps;
+    }
+
+    std::shared_ptr<Connection> connectUpdateMode(libusb_context* context)
+    {
+        auto devices = usb::listDevices(context, isUpdateMode);
+
+        if (devices.empty())
+        {
+            throw CommunicationException{"No device in update mode found"};
+        }
+        return std::make_shared<UsbComm>(std::move(devices.front()));
+    }
+
+    std::unique_ptr<usb::HotplugMonitor> monitorDevices(libusb_context* context, usb::HotplugHandler handler)
+    {
+        return std::make_unique<usb::HotplugMonitor>(context, usbVID, std::vector<std::uint16_t>(pids), std::move(handler));
     }
 
 }
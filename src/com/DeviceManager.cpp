@@ -0,0 +1,162 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/DeviceManager.h"
+#include "com/CommunicationException.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Shared by the tasks of one broadcast; the result is ready once
+        // every task has either run or been discarded by its worker
+        class Broadcast
+        {
+        public:
+            explicit Broadcast(std::size_t numberOfDevices)
+                : start(std::chrono::steady_clock::now()),
+                  results(numberOfDevices, BroadcastResult{std::chrono::steady_clock::duration::zero(), std::make_exception_ptr(CommunicationException{"Device not connected"})}),
+                  promise()
+            {
+            }
+
+            Broadcast(const Broadcast&) = delete;
+
+            ~Broadcast()
+            {
+                promise.set_value(std::move(results));
+            }
+
+            void run(std::size_t device, const MustangWorker::Task& task, Mustang& mustang)
+            {
+                std::exception_ptr error;
+
+                try
+                {
+                    task(mustang);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                results[device] = BroadcastResult{std::chrono::steady_clock::now() - start, error};
+            }
+
+            std::future<std::vector<BroadcastResult>> result()
+            {
+                return promise.get_future();
+            }
+
+            Broadcast& operator=(const Broadcast&) = delete;
+
+        private:
+            const std::chrono::steady_clock::time_point start;
+            std::vector<BroadcastResult> results;
+            std::promise<std::vector<BroadcastResult>> promise;
+        };
+    }
+
+
+    DeviceManager::DeviceManager(ErrorHandler errorHandler)
+        : onError(errorHandler), workers()
+    {
+    }
+
+    DeviceManager::~DeviceManager()
+    {
+        clear();
+    }
+
+    // The Mustang is handed over to a new worker, which runs onConnected
+    // first
+    std::size_t DeviceManager::add(std::unique_ptr<Mustang> device, MustangWorker::Task onConnected, std::optional<std::chrono::milliseconds> receiveTimeout)
+    {
+        const auto index = workers.size();
+        workers.push_back(std::make_unique<MustangWorker>([this, index](std::exception_ptr error)
+                                                          { onError(index, error); }));
+
+        auto owner = std::make_shared<std::unique_ptr<Mustang>>(std::move(device));
+        workers.back()->connect([owner]
+                                { return std::move(*owner); },
+                                [onConnected, receiveTimeout](Mustang& mustang)
+                                {
+                                    if (receiveTimeout)
+                                    {
+                                        mustang.setReceiveTimeout(*receiveTimeout);
+                                    }
+                                    onConnected(mustang);
+                                });
+        return index;
+    }
+
+    // Blocks until every device is closed, as pending tasks are discarded
+    // once the workers are gone
+    void DeviceManager::clear()
+    {
+        std::vector<std::future<void>> closed;
+
+        std::for_each(workers.cbegin(), workers.cend(), [&closed](const auto& w)
+                      {
+            auto done = std::make_shared<std::promise<void>>();
+            closed.push_back(done->get_future());
+            w->disconnect();
+            w->execute([done]
+                       { done->set_value(); }); });
+        std::for_each(closed.begin(), closed.end(), [](auto& f)
+                      { f.wait(); });
+        workers.clear();
+    }
+
+    std::size_t DeviceManager::size() const
+    {
+        return workers.size();
+    }
+
+    MustangWorker& DeviceManager::worker(std::size_t device)
+    {
+        if (device >= workers.size())
+        {
+            throw std::out_of_range{"Invalid device: " + std::to_string(device)};
+        }
+        return *workers[device];
+    }
+
+    std::future<std::vector<BroadcastResult>> DeviceManager::broadcast(MustangWorker::Task task)
+    {
+        auto state = std::make_shared<Broadcast>(workers.size());
+        auto result = state->result();
+
+        for (std::size_t device = 0; device < workers.size(); ++device)
+        {
+            workers[device]->post([state, device, task](Mustang& mustang)
+                                  { state->run(device, task, mustang); });
+        }
+        return result;
+    }
+
+    std::future<std::vector<BroadcastResult>> DeviceManager::applySignalChain(const SignalChain& signalChain)
+    {
+        return broadcast([signalChain](Mustang& mustang)
+                         { mustang.applySignalChain(signalChain); });
+    }
+}
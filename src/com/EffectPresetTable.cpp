@@ -0,0 +1,71 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/EffectPresetTable.h"
+#include <algorithm>
+
+namespace plug::com
+{
+    namespace
+    {
+        bool isBefore(const EffectPreset& lhs, EffectKnob knob, std::uint8_t slot)
+        {
+            return (lhs.knob < knob) || ((lhs.knob == knob) && (lhs.slot < slot));
+        }
+    }
+
+    void EffectPresetTable::clear()
+    {
+        entries.clear();
+    }
+
+    // Replaces a preset stored on the same knob and slot
+    void EffectPresetTable::put(const EffectPreset& preset)
+    {
+        const auto itr = std::find_if_not(entries.begin(), entries.end(), [&preset](const auto& entry)
+                                          { return isBefore(entry, preset.knob, preset.slot); });
+
+        if ((itr != entries.end()) && (itr->knob == preset.knob) && (itr->slot == preset.slot))
+        {
+            *itr = preset;
+        }
+        else
+        {
+            entries.insert(itr, preset);
+        }
+    }
+
+    std::optional<EffectPreset> EffectPresetTable::get(EffectKnob knob, std::uint8_t slot) const
+    {
+        const auto itr = std::find_if(entries.cbegin(), entries.cend(), [knob, slot](const auto& entry)
+                                      { return (entry.knob == knob) && (entry.slot == slot); });
+
+        if (itr == entries.cend())
+        {
+            return std::nullopt;
+        }
+        return *itr;
+    }
+
+    const std::vector<EffectPreset>& EffectPresetTable::presets() const
+    {
+        return entries;
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/FirmwareImage.h"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace plug::com
+{
+    namespace
+    {
+        // build date in the format of __DATE__, e.g. "Jan 31 2013"
+        inline constexpr std::size_t dateOffset{0x1a};
+        inline constexpr std::size_t dateSize{11};
+        inline constexpr std::size_t payloadOffset{0x110};
+        inline constexpr std::size_t headerSize{4};
+        inline constexpr std::size_t chunkSize{packetRawTypeSize - 8};
+
+
+        // Read-only mapping of a whole file
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string& filename)
+                : data(nullptr), size(0)
+            {
+                const int fd = ::open(filename.c_str(), O_RDONLY);
+
+                if (fd < 0)
+                {
+                    throw std::system_error{errno, std::generic_category(), "Cannot open " + filename};
+                }
+
+                struct stat info{};
+
+                if (::fstat(fd, &info) != 0)
+                {
+                    const int error = errno;
+                    ::close(fd);
+                    throw std::system_error{error, std::generic_category(), "Cannot read " + filename};
+                }
+
+                size = static_cast<std::size_t>(info.st_size);
+
+                if (size > 0)
+                {
+                    data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                }
+                const int error = errno;
+                ::close(fd);
+
+                if (data == MAP_FAILED)
+                {
+                    throw std::system_error{error, std::generic_category(), "Cannot read " + filename};
+                }
+            }
+
+            MappedFile(const MappedFile&) = delete;
+
+            ~MappedFile()
+            {
+                if (data != nullptr)
+                {
+                    ::munmap(data, size);
+                }
+            }
+
+            std::span<const std::uint8_t> bytes() const
+            {
+                return {static_cast<const std::uint8_t*>(data), size};
+            }
+
+            MappedFile& operator=(const MappedFile&) = delete;
+
+        private:
+            void* data;
+            std::size_t size;
+        };
+
+
+        PacketRawType packet(std::uint8_t type, std::uint8_t value0, std::uint8_t value1, std::span<const std::uint8_t> payload)
+        {
+            PacketRawType p{};
+            p[0] = type;
+            p[1] = 0x03;
+            p[2] = value0;
+            p[3] = value1;
+            std::copy(payload.begin(), payload.end(), std::next(p.begin(), headerSize));
+            return p;
+        }
+
+        void validate(std::span<const std::uint8_t> image)
+        {
+            if (image.size() <= payloadOffset)
+            {
+                throw std::invalid_argument{"Invalid firmware image: size of " + std::to_string(image.size()) + " bytes is too small"};
+            }
+
+            const auto date = image.subspan(dateOffset, dateSize);
+
+            if (!std::all_of(date.begin(), date.end(), [](std::uint8_t c)
+                             { return (c >= 0x20) && (c < 0x7f); }))
+            {
+                throw std::invalid_argument{"Invalid firmware image: no build date"};
+            }
+        }
+    }
+
+
+    // The chunks are numbered from zero, the number wraps after 0xff
+    std::vector<PacketRawType> toFirmwarePackets(std::span<const std::uint8_t> image)
+    {
+        validate(image);
+
+        const auto payload = image.subspan(payloadOffset);
+        std::vector<PacketRawType> packets;
+        packets.reserve(2 + (payload.size() + chunkSize - 1) / chunkSize);
+        packets.push_back(packet(0x02, 0x01, 0x06, image.subspan(dateOffset, dateSize)));
+
+        std::uint8_t number{0};
+
+        for (std::size_t offset = 0; offset < payload.size(); offset += chunkSize)
+        {
+            const auto chunk = payload.subspan(offset, std::min(chunkSize, payload.size() - offset));
+            packets.push_back(packet(0x03, number++, static_cast<std::uint8_t>(chunk.size()), chunk));
+        }
+
+        packets.push_back(packet(0x04, 0x00, 0x00, {}));
+        return packets;
+    }
+
+    std::vector<PacketRawType> loadFirmware(const std::string& filename)
+    {
+        return toFirmwarePackets(MappedFile{filename}.bytes());
+    }
+}
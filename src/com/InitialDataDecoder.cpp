@@ -0,0 +1,187 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/InitialDataDecoder.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Devices without a known number of presets have either 24 or 100
+        inline constexpr std::size_t smallPresetCount{24};
+        inline constexpr std::size_t largePresetCount{100};
+        inline constexpr std::size_t packetsPerPresetName{2};
+
+        // Effect preset names are sent with the DSP of saving one, the knob
+        // in the first unknown header field, 24 characters of name
+        inline constexpr std::uint8_t dlyRevKnobId{0x02};
+        inline constexpr std::size_t effectPresetNameLength{24};
+
+        // Every response stream (bank data, preset names, effect presets)
+        // is closed by a packet starting with "0x1c 0x01 0x00"
+        inline constexpr std::array<std::uint8_t, 3> confirmationPacketHeader{{0x1c, 0x01, 0x00}};
+
+
+        bool isEffectPresetName(const PacketRawType& packet)
+        {
+            try
+            {
+                return PacketView<EmptyPayload>{packet}.getHeader().getDSP() == DSP::opSaveEffectName;
+            }
+            catch (const std::domain_error&)
+            {
+                return false;
+            }
+        }
+    }
+
+
+    bool isConfirmationPacket(std::span<const std::uint8_t> data)
+    {
+        return (data.size() >= confirmationPacketHeader.size()) && std::equal(confirmationPacketHeader.cbegin(), confirmationPacketHeader.cend(), data.begin());
+    }
+
+    SignalChain decode_data(const std::array<PacketRawType, 7>& data)
+    {
+        const auto name = decodeNameFromData(PacketView<NamePayload>{data[0]});
+        const auto amp = decodeAmpFromData(PacketView<AmpPayload>{data[1]}, PacketView<AmpPayload>{data[6]});
+        std::vector<fx_pedal_settings> effects;
+        effects.reserve(4);
+        std::transform(std::next(data.cbegin(), 2), std::next(data.cbegin(), 6), std::back_inserter(effects), [](const auto& packet)
+                       { return decodeEffectFromData(PacketView<EffectPayload>{packet}); });
+
+        return SignalChain{name, amp, effects};
+    }
+
+
+    InitialDataDecoder::InitialDataDecoder(const DeviceModel& model, NameHandler nameHandler, StateHandler stateHandler, EffectPresetHandler effectPresetHandler)
+        : onName(nameHandler), onState(stateHandler), onEffectPreset(effectPresetHandler), numberOfPresets(model.numberOfPresets()),
+          numberOfEffectPresets(model.numberOfEffectPresets()), phase(Phase::presetNames), received(0), state{{}}, effectPreset()
+    {
+    }
+
+    void InitialDataDecoder::push(const PacketRawType& packet)
+    {
+        switch (phase)
+        {
+            case Phase::presetNames:
+                pushPresetName(packet);
+                break;
+            case Phase::currentState:
+                state[received++] = packet;
+
+                if (received == state.size())
+                {
+                    onState(decode_data(state));
+                    phase = Phase::stateTrailer;
+                }
+                break;
+            case Phase::stateTrailer:
+                if (isConfirmationPacket(packet))
+                {
+                    phase = Phase::effectPresets;
+                    received = 0;
+                }
+                break;
+            default:
+                pushEffectPreset(packet);
+                break;
+        }
+    }
+
+    bool InitialDataDecoder::hasState() const
+    {
+        return phase == Phase::stateTrailer || phase == Phase::effectPresets;
+    }
+
+    // Every effect preset of both knobs is closed by a confirmation packet;
+    // without a known number of them the end isn't recognised
+    bool InitialDataDecoder::isComplete() const
+    {
+        constexpr std::size_t numberOfKnobs{2};
+        return (phase == Phase::effectPresets) && (numberOfEffectPresets != 0) && (received == numberOfKnobs * numberOfEffectPresets);
+    }
+
+    // Each preset name is followed by a second packet of the same slot
+    void InitialDataDecoder::pushPresetName(const PacketRawType& packet)
+    {
+        if ((numberOfPresets == 0) && (received == smallPresetCount * packetsPerPresetName))
+        {
+            // The current state starts with the name of a preset below 24
+            const auto slot = PacketView<EmptyPayload>{packet}.getHeader().getSlot();
+            numberOfPresets = (slot == smallPresetCount ? largePresetCount : smallPresetCount);
+        }
+
+        if ((numberOfPresets != 0) && (received == numberOfPresets * packetsPerPresetName))
+        {
+            phase = Phase::currentState;
+            received = 0;
+            push(packet);
+            return;
+        }
+
+        if ((received % packetsPerPresetName) == 0)
+        {
+            onName(received / packetsPerPresetName, decodeNameFromData(PacketView<NamePayload>{packet}));
+        }
+        ++received;
+    }
+
+    // Presets that can't be decoded are skipped
+    void InitialDataDecoder::pushEffectPreset(const PacketRawType& packet)
+    {
+        if (isConfirmationPacket(packet))
+        {
+            ++received;
+
+            if (effectPreset)
+            {
+                onEffectPreset(*effectPreset);
+                effectPreset.reset();
+            }
+        }
+        else if (isEffectPresetName(packet))
+        {
+            const PacketView<NamePayload> view{packet};
+            const auto header = view.getHeader();
+            const auto name = decodeNameFromData(view);
+            effectPreset = EffectPreset{header.getUnknown()[0] == dlyRevKnobId ? EffectKnob::dlyRev : EffectKnob::mod,
+                                        header.getSlot(),
+                                        name.substr(0, effectPresetNameLength),
+                                        {}};
+            effectPreset->effects.reserve(2);
+        }
+        else if (effectPreset)
+        {
+            try
+            {
+                effectPreset->effects.push_back(decodeEffectFromData(PacketView<EffectPayload>{packet}));
+            }
+            catch (const std::invalid_argument&)
+            {
+                effectPreset.reset();
+            }
+        }
+    }
+}
@@ -23,52 +23,67 @@
 #include "com/PacketSerializer.h"
 #include "com/CommunicationException.h"
 #include "com/Packet.h"
+#include "com/InitialDataDecoder.h"
 #include <algorithm>
+#include <span>
 
 namespace plug::com
 {
-    SignalChain decode_data(const std::array<PacketRawType, 7>& data)
+    namespace
     {
-        const auto name = decodeNameFromData(fromRawData<NamePayload>(data[0]));
-        const auto amp = decodeAmpFromData(fromRawData<AmpPayload>(data[1]), fromRawData<AmpPayload>(data[6]));
-        const auto effects = decodeEffectsFromData({{fromRawData<EffectPayload>(data[2]), fromRawData<EffectPayload>(data[3]),
-                                                     fromRawData<EffectPayload>(data[4]), fromRawData<EffectPayload>(data[5])}});
-
-        return SignalChain{name, amp, effects};
+        // Number of commands sent ahead of their acks
+        inline constexpr std::size_t commandWindow{3};
     }
 
-    std::vector<std::uint8_t> receivePacket(Connection& conn)
+    std::size_t receivePacket(Connection& conn, PacketRawType& packet)
     {
-        return conn.receive(packetRawTypeSize);
+        return conn.receiveInto(packet);
     }
 
 
     void sendCommand(Connection& conn, const PacketRawType& packet)
     {
+        conn.discardReceived();
         conn.send(packet);
-        receivePacket(conn);
+        PacketRawType response;
+        receivePacket(conn, response);
     }
 
-    void sendApplyCommand(Connection& conn)
+    void sendAcknowledgedCommand(Connection& conn, const PacketRawType& packet)
     {
-        sendCommand(conn, serializeApplyCommand().getBytes());
+        conn.discardReceived();
+        conn.send(packet);
+        PacketRawType response;
+
+        if (receivePacket(conn, response) == 0)
+        {
+            throw CommunicationException{"Command not acknowledged"};
+        }
     }
 
     std::array<PacketRawType, 7> loadBankData(Connection& conn, std::uint8_t slot)
     {
         std::array<PacketRawType, 7> data{{}};
+        PacketRawType trailer{};
 
         const auto loadCommand = serializeLoadSlotCommand(slot);
+        conn.discardReceived();
         auto n = conn.send(loadCommand.getBytes());
 
         for (std::size_t i = 0; n != 0; ++i)
         {
-            const auto recvData = receivePacket(conn);
-            n = recvData.size();
-
-            if (i < 7)
+            if (i < data.size())
             {
-                std::copy(recvData.cbegin(), recvData.cend(), data[i].begin());
+                n = receivePacket(conn, data[i]);
+            }
+            else
+            {
+                n = receivePacket(conn, trailer);
+
+                if (isConfirmationPacket(std::span{trailer}.first(n)))
+                {
+                    break;
+                }
             }
         }
         return data;
@@ -76,11 +91,11 @@ namespace plug::com
 
 
     Mustang::Mustang(DeviceModel deviceModel, std::shared_ptr<Connection> connection)
-        : model(deviceModel), conn(connection)
+        : model(deviceModel), conn(connection), pipelineCommands(false), dspState()
     {
     }
 
-    InitialData Mustang::start_amp()
+    InitialData Mustang::start_amp(const PresetNameHandler& onPresetName)
     {
         if (conn->isOpen() == false)
         {
@@ -89,61 +104,85 @@ namespace plug::com
 
         initializeAmp();
 
-        return loadData();
+        const auto initialData = loadData(onPresetName);
+        dspState = toDspState(initialData.signalChain);
+        return initialData;
     }
 
     void Mustang::stop_amp()
     {
+        dspState = DspState{};
         conn->close();
     }
 
     void Mustang::set_effect(fx_pedal_settings value)
     {
-        const auto clearEffectPacket = serializeClearEffectSettings(value);
-        sendCommand(*conn, clearEffectPacket.getBytes());
-        sendApplyCommand(*conn);
-
-        if ((value.enabled == true) && (value.effect_num != effects::EMPTY))
-        {
-            const auto settingsPacket = serializeEffectSettings(value);
-            sendCommand(*conn, settingsPacket.getBytes());
-            sendApplyCommand(*conn);
-        }
+        transaction().set_effect(value).commit();
     }
 
     void Mustang::set_amplifier(amp_settings value)
     {
-        const auto settingsPacket = serializeAmpSettings(value);
-        sendCommand(*conn, settingsPacket.getBytes());
-        sendApplyCommand(*conn);
-
-        const auto settingsGainPacket = serializeAmpSettingsUsbGain(value);
-        sendCommand(*conn, settingsGainPacket.getBytes());
-        sendApplyCommand(*conn);
+        transaction().set_amplifier(value).commit();
     }
 
-    void Mustang::save_on_amp(std::string_view name, std::uint8_t slot)
+    // Returns the bank as read back from the amp
+    SignalChain Mustang::save_on_amp(std::string_view name, std::uint8_t slot)
     {
         const auto data = serializeName(slot, name).getBytes();
         sendCommand(*conn, data);
-        loadBankData(*conn, slot);
+        const auto signalChain = decode_data(loadBankData(*conn, slot));
+        dspState = toDspState(signalChain);
+        return signalChain;
     }
 
     SignalChain Mustang::load_memory_bank(std::uint8_t slot)
     {
-        return decode_data(loadBankData(*conn, slot));
+        const auto signalChain = decode_data(loadBankData(*conn, slot));
+        dspState = toDspState(signalChain);
+        return signalChain;
     }
 
     void Mustang::save_effects(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects)
     {
         const auto saveNamePacket = serializeSaveEffectName(slot, name, effects);
-        sendCommand(*conn, saveNamePacket.getBytes());
-
         const auto packets = serializeSaveEffectPacket(slot, effects);
-        std::for_each(packets.cbegin(), packets.cend(), [this](const auto& p)
-                      { sendCommand(*conn, p.getBytes()); });
 
-        sendCommand(*conn, serializeApplyCommand(effects[0]).getBytes());
+        std::vector<PacketRawType> commands;
+        commands.reserve(packets.size() + 2);
+        commands.push_back(saveNamePacket.getBytes());
+        std::transform(packets.cbegin(), packets.cend(), std::back_inserter(commands), [](const auto& p)
+                       { return p.getBytes(); });
+        commands.push_back(serializeApplyCommand(effects[0]).getBytes());
+
+        try
+        {
+            sendCommands(commands);
+        }
+        catch (...)
+        {
+            dspState = DspState{};
+            throw;
+        }
+
+        std::for_each(effects.cbegin(), effects.cend(), [this](const auto& effect)
+                      {
+                          if (const auto index = effectDspIndex(effect); index)
+                          {
+                              dspState.effects[*index].reset();
+                          } });
+    }
+
+    Mustang::Transaction Mustang::transaction()
+    {
+        return Transaction{*this};
+    }
+
+    // Sends only the DSPs that differ from the known state
+    std::size_t Mustang::applySignalChain(const SignalChain& target)
+    {
+        const auto plan = planSignalChain(dspState, target);
+        sendPlan(plan);
+        return plan.savedPackets;
     }
 
     DeviceModel Mustang::getDeviceModel() const
@@ -151,37 +190,175 @@ namespace plug::com
         return model;
     }
 
+    std::string Mustang::getDeviceName() const
+    {
+        return conn->name();
+    }
+
+    // Stop-and-wait is the default; pipelining relies on the amp confirming
+    // every command in order
+    void Mustang::setPipelining(bool enabled)
+    {
+        pipelineCommands = enabled;
+    }
+
+    void Mustang::setReceiveTimeout(std::chrono::milliseconds timeout)
+    {
+        conn->setReceiveTimeout(timeout);
+    }
 
-    InitialData Mustang::loadData()
+    std::string Mustang::getDeviceIdentity() const
     {
-        std::vector<std::array<std::uint8_t, 64>> recieved_data;
+        return conn->identity();
+    }
+
+    const DspState& Mustang::getDspState() const
+    {
+        return dspState;
+    }
+
+
+    // Packets are decoded as they arrive; names are reported right away. The
+    // transfer ends with the last effect preset, or on timeout if the stream
+    // can't be followed
+    InitialData Mustang::loadData(const PresetNameHandler& onPresetName)
+    {
+        constexpr std::size_t maxPresets{100};
+        InitialData initialData{};
+        initialData.presetNames.reserve(model.numberOfPresets() > 0 ? model.numberOfPresets() : maxPresets);
+
+        InitialDataDecoder decoder{model, [&initialData, &onPresetName](std::size_t slot, const std::string& name)
+                                   {
+                                       initialData.presetNames.push_back(name);
+
+                                       if (onPresetName)
+                                       {
+                                           onPresetName(slot, name);
+                                       }
+                                   },
+                                   [&initialData](const SignalChain& signalChain)
+                                   { initialData.signalChain = signalChain; },
+                                   [&initialData](const EffectPreset& preset)
+                                   { initialData.effectPresets.push_back(preset); }};
 
         const auto loadCommand = serializeLoadCommand();
+        conn->discardReceived();
         auto recieved = conn->send(loadCommand.getBytes());
 
-        while (recieved != 0)
+        while ((recieved != 0) && !decoder.isComplete())
+        {
+            PacketRawType packet{};
+            recieved = receivePacket(*conn, packet);
+
+            if (recieved != 0)
+            {
+                decoder.push(packet);
+            }
+        }
+
+        return initialData;
+    }
+
+    // Commands that weren't confirmed in the pipeline are sent again with
+    // stop-and-wait; the next call pipelines again
+    void Mustang::sendCommands(std::span<const PacketRawType> commands)
+    {
+        const std::size_t acked = (pipelineCommands ? sendPipelined(commands) : 0);
+
+        std::for_each(std::next(commands.begin(), static_cast<std::ptrdiff_t>(acked)), commands.end(), [this](const auto& command)
+                      { sendAcknowledgedCommand(*conn, command); });
+    }
+
+    // Up to commandWindow commands are kept in flight. The confirmation
+    // doesn't tell which command it belongs to, so acks are assigned in
+    // order; a missing or unexpected ack drains the outstanding acks and
+    // stops. Returns the number of commands confirmed in order.
+    std::size_t Mustang::sendPipelined(std::span<const PacketRawType> commands)
+    {
+        std::size_t sent{0};
+        std::size_t acked{0};
+        conn->discardReceived();
+
+        while (acked < commands.size())
+        {
+            const auto n = std::min(commandWindow - (sent - acked), commands.size() - sent);
+
+            if (n > 0)
+            {
+                conn->sendBatch(commands.subspan(sent, n));
+                sent += n;
+            }
+
+            PacketRawType response{};
+            const auto received = receivePacket(*conn, response);
+
+            if ((received == 0) || !isConfirmationPacket(std::span{response}.first(received)))
+            {
+                for (std::size_t i = acked + 1; i < sent; ++i)
+                {
+                    receivePacket(*conn, response);
+                }
+                break;
+            }
+            ++acked;
+        }
+        return acked;
+    }
+
+    // The state is taken over once every command was acknowledged; an
+    // interrupted plan leaves the DSPs unknown
+    void Mustang::sendPlan(const CommandPlan& plan)
+    {
+        try
         {
-            const auto recvData = receivePacket(*conn);
-            recieved = recvData.size();
-            PacketRawType p{};
-            std::copy(recvData.cbegin(), recvData.cend(), p.begin());
-            recieved_data.push_back(p);
+            sendCommands(plan.commands);
         }
+        catch (...)
+        {
+            dspState = DspState{};
+            throw;
+        }
+        dspState = plan.state;
+    }
+
+    void Mustang::writeSettings(const std::optional<amp_settings>& amp, std::span<const fx_pedal_settings> effects)
+    {
+        sendPlan(planCommands(dspState, amp, effects));
+    }
+
+    Mustang::Transaction::Transaction(Mustang& mustang)
+        : owner(mustang), amp(), effects()
+    {
+    }
 
-        const std::size_t numPresetPackets = model.numberOfPresets() > 0 ? (model.numberOfPresets() * 2) : (recieved_data.size() > 143 ? 200 : 48);
-        std::vector<Packet<NamePayload>> presetListData;
-        presetListData.reserve(numPresetPackets);
-        std::transform(recieved_data.cbegin(), std::next(recieved_data.cbegin(), numPresetPackets), std::back_inserter(presetListData), [](const auto& p)
-                       {
-            Packet<NamePayload> packet{};
-            packet.fromBytes(p);
-            return packet; });
-        auto presetNames = decodePresetListFromData(presetListData);
+    Mustang::Transaction& Mustang::Transaction::set_amplifier(amp_settings value)
+    {
+        amp = value;
+        return *this;
+    }
 
-        std::array<PacketRawType, 7> presetData{{}};
-        std::copy(std::next(recieved_data.cbegin(), numPresetPackets), std::next(recieved_data.cbegin(), numPresetPackets + 7), presetData.begin());
+    // Only the last write per effect slot is kept
+    Mustang::Transaction& Mustang::Transaction::set_effect(fx_pedal_settings value)
+    {
+        const auto itr = std::find_if(effects.begin(), effects.end(), [&value](const auto& effect)
+                                      { return effect.slot.id() == value.slot.id(); });
 
-        return {decode_data(presetData), presetNames};
+        if (itr != effects.end())
+        {
+            *itr = value;
+        }
+        else
+        {
+            effects.push_back(value);
+        }
+        return *this;
+    }
+
+    void Mustang::Transaction::commit()
+    {
+        owner.writeSettings(amp, effects);
+        amp.reset();
+        effects.clear();
     }
 
     void Mustang::initializeAmp()
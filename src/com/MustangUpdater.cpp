@@ -3,7 +3,6 @@
  *        Linux replacement for Fender FUSE software
  *
  * Copyright (C) 2017-2024  offa
- * Copyright (C) 2010-2016  piorekf <piorek@piorekf.org>
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,154 +19,92 @@
  */
 
 #include "com/MustangUpdater.h"
-#include "com/Mustang.h"
-#include "com/Packet.h"
-#include <chrono>
-#include <cstdio>
-#include <cstring>
-#include <unistd.h>
-#include <libusb-1.0/libusb.h>
+#include "com/CommunicationException.h"
+#include "com/FirmwareImage.h"
 
 namespace plug::com
 {
-    namespace
+    MustangUpdater::MustangUpdater(ProgressHandler progressHandler, FinishedHandler finishedHandler)
+        : onProgress(progressHandler), onFinished(finishedHandler), running(false), cancelled(false), thread()
     {
-        // amp's VID and PID while in update mode
-        inline constexpr std::uint16_t USB_UPDATE_VID{0x1ed8};
-        inline constexpr std::uint16_t SMALL_AMPS_USB_UPDATE_PID{0x0006};    // Mustang I and II
-        inline constexpr std::uint16_t BIG_AMPS_USB_UPDATE_PID{0x0007};      // Mustang III, IV, V
-        inline constexpr std::uint16_t MINI_USB_UPDATE_PID{0x0011};          // Mustang Mini
-        inline constexpr std::uint16_t FLOOR_USB_UPDATE_PID{0x0013};         // Mustang Floor
-        inline constexpr std::uint16_t SMALL_AMPS_V2_USB_UPDATE_PID{0x0015}; // Mustang I & II V2
-        inline constexpr std::uint16_t BIG_AMPS_V2_USB_UPDATE_PID{0x0017};   // Mustang III+ V2
     }
 
-    namespace
+    MustangUpdater::~MustangUpdater()
     {
-        void closeUsb(libusb_device_handle* handle)
-        {
-            if (handle != nullptr)
-            {
-                const int ret = libusb_release_interface(handle, 0);
+        cancel();
 
-                if (ret != LIBUSB_ERROR_NO_DEVICE)
-                {
-                    libusb_attach_kernel_driver(handle, 0);
-                }
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
 
-                libusb_close(handle);
-                libusb_exit(nullptr);
-            }
+    void MustangUpdater::start(const std::string& filename, Factory factory)
+    {
+        if (running.load())
+        {
+            throw CommunicationException{"Update already running"};
         }
 
+        if (thread.joinable())
+        {
+            thread.join();
+        }
 
-        inline constexpr std::chrono::milliseconds timeout{500};
-        inline constexpr std::size_t sizeOfPacket = packetRawTypeSize;
+        auto packets = loadFirmware(filename);
+        cancelled.store(false);
+        running.store(true);
+        thread = std::thread{&MustangUpdater::run, this, std::move(packets), std::move(factory)};
     }
 
+    void MustangUpdater::cancel()
+    {
+        cancelled.store(true);
+    }
 
-    int updateFirmware(const char* filename)
+    // The transfers are paced by the answers only, a packet without answer
+    // fails the update; the amp may restart on the finish packet, so its
+    // answer is optional
+    void MustangUpdater::run(std::vector<PacketRawType> packets, Factory factory)
     {
-        // initialize libusb
-        int ret = libusb_init(nullptr);
-        if (ret != 0)
-        {
-            return ret;
-        }
+        std::exception_ptr error;
+        std::shared_ptr<Connection> conn;
 
-        // get handle for the device
-        libusb_device_handle* amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, SMALL_AMPS_USB_UPDATE_PID);
-        if (amp_hand == nullptr)
+        try
         {
-            amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, BIG_AMPS_USB_UPDATE_PID);
-            if (amp_hand == nullptr)
+            conn = factory();
+            PacketRawType answer{};
+
+            for (std::size_t i = 0; i < packets.size(); ++i)
             {
-                amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, SMALL_AMPS_V2_USB_UPDATE_PID);
-                if (amp_hand == nullptr)
+                if (cancelled.load())
                 {
-                    amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, BIG_AMPS_V2_USB_UPDATE_PID);
-                    if (amp_hand == nullptr)
-                    {
-                        amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, MINI_USB_UPDATE_PID);
-                        if (amp_hand == nullptr)
-                        {
-                            amp_hand = libusb_open_device_with_vid_pid(nullptr, USB_UPDATE_VID, FLOOR_USB_UPDATE_PID);
-                            if (amp_hand == nullptr)
-                            {
-                                libusb_exit(nullptr);
-                                return -100;
-                            }
-                        }
-                    }
+                    throw CommunicationException{"Update cancelled"};
                 }
-            }
-        }
 
-        // detach kernel driver
-        ret = libusb_kernel_driver_active(amp_hand, 0);
-        if (ret != 0)
-        {
-            ret = libusb_detach_kernel_driver(amp_hand, 0);
-            if (ret != 0)
-            {
-                closeUsb(amp_hand);
-                return ret;
+                conn->discardReceived();
+                conn->send(packets[i]);
+
+                const bool isFinishPacket = (i + 1 == packets.size());
+
+                if ((conn->receiveInto(answer) == 0) && !isFinishPacket)
+                {
+                    throw CommunicationException{"No answer to firmware packet " + std::to_string(i + 1) + " of " + std::to_string(packets.size())};
+                }
+                onProgress(i + 1, packets.size());
             }
         }
-
-        // claim the device
-        ret = libusb_claim_interface(amp_hand, 0);
-        if (ret != 0)
+        catch (...)
         {
-            closeUsb(amp_hand);
-            return ret;
+            error = std::current_exception();
         }
 
-        FILE* file = fopen(filename, "rb");
-        // send date when firmware was created
-        fseek(file, 0x1a, SEEK_SET);
-        unsigned char array[sizeOfPacket];
-        memset(array, 0x00, sizeOfPacket);
-        array[0] = 0x02;
-        array[1] = 0x03;
-        array[2] = 0x01;
-        array[3] = 0x06;
-        [[maybe_unused]] const auto n = fread(array + 4, 1, 11, file);
-        int recieved{0};
-        ret = libusb_interrupt_transfer(amp_hand, 0x01, array, sizeOfPacket, &recieved, timeout.count());
-        libusb_interrupt_transfer(amp_hand, 0x81, array, sizeOfPacket, &recieved, timeout.count());
-        usleep(10000);
-
-        // send firmware
-        fseek(file, 0x110, SEEK_SET);
-        for (;;)
+        if (conn != nullptr)
         {
-            memset(array, 0x00, sizeOfPacket);
-            unsigned char number{0};
-            array[0] = array[1] = 0x03;
-            array[2] = number;
-            ++number;
-            array[3] = static_cast<std::uint8_t>(fread(array + 4, 1, sizeOfPacket - 8, file));
-            ret = libusb_interrupt_transfer(amp_hand, 0x01, array, sizeOfPacket, &recieved, timeout.count());
-            libusb_interrupt_transfer(amp_hand, 0x81, array, sizeOfPacket, &recieved, timeout.count());
-            usleep(10000);
-
-            if (feof(file) != 0) // if reached end of the file
-            {
-                break; // exit loop
-            }
+            conn->close();
         }
-        fclose(file);
-
-        // send "finished" packet
-        memset(array, 0x00, sizeOfPacket);
-        array[0] = 0x04;
-        array[1] = 0x03;
-        libusb_interrupt_transfer(amp_hand, 0x01, array, sizeOfPacket, &recieved, timeout.count());
-        libusb_interrupt_transfer(amp_hand, 0x81, array, sizeOfPacket, &recieved, timeout.count());
-
-        closeUsb(amp_hand);
 
-        return 0;
+        running.store(false);
+        onFinished(error);
     }
 }
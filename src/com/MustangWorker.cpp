@@ -0,0 +1,234 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/MustangWorker.h"
+#include "com/CommunicationException.h"
+#include <algorithm>
+#include <utility>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Token bucket refilled once per measured round trip
+        inline constexpr std::size_t updateBurst{2};
+        inline constexpr std::chrono::milliseconds initialRoundTrip{10};
+        inline constexpr int roundTripSmoothing{8};
+    }
+
+    MustangWorker::MustangWorker(ErrorHandler errorHandler, LatencyHandler latencyHandler)
+        : onError(errorHandler), onUpdateSent(latencyHandler), mustang(nullptr), updates(), sendRate(updateBurst, initialRoundTrip, TokenBucket::Clock::now()), tasks(),
+          enqueued(0), flushBarrier(0), flushArmed(false), pending(0), running(true), thread(&MustangWorker::run, this)
+    {
+    }
+
+    // Pending tasks are discarded
+    MustangWorker::~MustangWorker()
+    {
+        running.store(false);
+        pending.release();
+        thread.join();
+    }
+
+    void MustangWorker::connect(Factory factory, Task onConnected)
+    {
+        enqueue([this, factory, onConnected]
+                {
+                    mustang = factory();
+
+                    try
+                    {
+                        onConnected(*mustang);
+                    }
+                    catch (...)
+                    {
+                        mustang.reset();
+                        throw;
+                    } });
+    }
+
+    void MustangWorker::disconnect()
+    {
+        enqueue([this]
+                {
+                    if (mustang)
+                    {
+                        auto device = std::move(mustang);
+                        device->stop_amp();
+                    } });
+    }
+
+    void MustangWorker::post(Task task)
+    {
+        enqueue([this, task]
+                {
+                    if (!mustang)
+                    {
+                        throw CommunicationException{"Device not connected"};
+                    }
+                    task(*mustang);
+                });
+    }
+
+    void MustangWorker::execute(std::function<void()> task)
+    {
+        enqueue(task);
+    }
+
+    void MustangWorker::update(amp_settings value)
+    {
+        if (updates.push(value))
+        {
+            armFlush();
+        }
+    }
+
+    void MustangWorker::update(fx_pedal_settings value)
+    {
+        if (updates.push(value))
+        {
+            armFlush();
+        }
+    }
+
+    CoalescingStats MustangWorker::coalescingStats() const
+    {
+        return updates.stats();
+    }
+
+    void MustangWorker::enqueue(std::function<void()> task)
+    {
+        enqueued.fetch_add(1);
+        tasks.push(std::move(task));
+        pending.release();
+    }
+
+    // The flush runs after all tasks queued so far, but before any later one
+    void MustangWorker::armFlush()
+    {
+        flushBarrier.store(enqueued.load());
+        flushArmed.store(true);
+        pending.release();
+    }
+
+    // Updates arriving while waiting for a token replace the pending ones
+    void MustangWorker::flushUpdates()
+    {
+        flushArmed.store(false);
+        sendRate.tryConsume(TokenBucket::Clock::now());
+
+        const auto queued = updates.take();
+
+        if (queued.size() == 0)
+        {
+            return;
+        }
+
+        if (!mustang)
+        {
+            updates.drop(queued.size());
+            return;
+        }
+
+        try
+        {
+            const auto start = TokenBucket::Clock::now();
+            auto transaction = mustang->transaction();
+
+            if (queued.amp)
+            {
+                transaction.set_amplifier(*queued.amp);
+            }
+
+            std::for_each(queued.effects.cbegin(), queued.effects.cend(), [&transaction](const auto& effect)
+                          { transaction.set_effect(effect); });
+            transaction.commit();
+
+            const auto end = TokenBucket::Clock::now();
+            const auto current = sendRate.refillInterval();
+            sendRate.setRefillInterval(current + ((end - start) - current) / roundTripSmoothing);
+
+            if (onUpdateSent)
+            {
+                onUpdateSent(end - queued.lastUpdate);
+            }
+        }
+        catch (...)
+        {
+            updates.drop(queued.size());
+            throw;
+        }
+    }
+
+    // An armed flush waits for a token only while no later task is queued;
+    // the wait is bounded, so other tasks never sleep behind the rate limit
+    void MustangWorker::run()
+    {
+        std::optional<std::function<void()>> next;
+        std::uint64_t started{0};
+
+        while (running.load())
+        {
+            if (!next)
+            {
+                next = tasks.tryPop();
+            }
+
+            if (flushArmed.load() && (started >= flushBarrier.load()))
+            {
+                const auto now = TokenBucket::Clock::now();
+                const auto wait = sendRate.waitTime(now);
+
+                if (next || (wait <= TokenBucket::Clock::duration::zero()))
+                {
+                    runTask([this]
+                            { flushUpdates(); });
+                }
+                else
+                {
+                    static_cast<void>(pending.try_acquire_until(now + wait));
+                }
+                continue;
+            }
+
+            if (!next)
+            {
+                // A push not yet linked releases again once it is
+                pending.acquire();
+                continue;
+            }
+
+            ++started;
+            runTask(*std::exchange(next, std::nullopt));
+        }
+    }
+
+    void MustangWorker::runTask(const std::function<void()>& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            onError(std::current_exception());
+        }
+    }
+}
@@ -79,56 +79,57 @@ namespace plug::com
 
         constexpr DSP dspFromEffect(effects effect)
         {
-            switch (effect)
-            {
-                case effects::OVERDRIVE:
-                case effects::WAH:
-                case effects::TOUCH_WAH:
-                case effects::FUZZ:
-                case effects::FUZZ_TOUCH_WAH:
-                case effects::SIMPLE_COMP:
-                case effects::COMPRESSOR:
-                    return DSP::effect0;
-
-                case effects::SINE_CHORUS:
-                case effects::TRIANGLE_CHORUS:
-                case effects::SINE_FLANGER:
-                case effects::TRIANGLE_FLANGER:
-                case effects::VIBRATONE:
-                case effects::VINTAGE_TREMOLO:
-                case effects::SINE_TREMOLO:
-                case effects::RING_MODULATOR:
-                case effects::STEP_FILTER:
-                case effects::PHASER:
-                case effects::PITCH_SHIFTER:
-                    return DSP::effect1;
-
-                case effects::MONO_DELAY:
-                case effects::MONO_ECHO_FILTER:
-                case effects::STEREO_ECHO_FILTER:
-                case effects::MULTITAP_DELAY:
-                case effects::PING_PONG_DELAY:
-                case effects::DUCKING_DELAY:
-                case effects::REVERSE_DELAY:
-                case effects::TAPE_DELAY:
-                case effects::STEREO_TAPE_DELAY:
-                    return DSP::effect2;
-
-                case effects::SMALL_HALL_REVERB:
-                case effects::LARGE_HALL_REVERB:
-                case effects::SMALL_ROOM_REVERB:
-                case effects::LARGE_ROOM_REVERB:
-                case effects::SMALL_PLATE_REVERB:
-                case effects::LARGE_PLATE_REVERB:
-                case effects::AMBIENT_REVERB:
-                case effects::ARENA_REVERB:
-                case effects::FENDER_63_SPRING_REVERB:
-                case effects::FENDER_65_SPRING_REVERB:
-                    return DSP::effect3;
+            return lookupEffect(effect).dsp;
+        }
 
-                default:
-                    return DSP::none;
-            }
+        template <class Payload, class Serializer>
+        Packet<Payload> toPacket(Serializer serialize)
+        {
+            PacketRawType data{};
+            serialize(PacketSpan<Payload>{data});
+            return fromRawData<Payload>(data);
+        }
+
+        // Packets and packet views share the accessors
+        template <class AmpPacket>
+        amp_settings decodeAmp(const AmpPacket& packet, const AmpPacket& packetUsbGain)
+        {
+            const auto payload = packet.getPayload();
+
+            amp_settings settings{};
+            settings.amp_num = lookupAmpById(payload.getModel());
+            settings.gain = payload.getGain();
+            settings.volume = payload.getVolume();
+            settings.treble = payload.getTreble();
+            settings.middle = payload.getMiddle();
+            settings.bass = payload.getBass();
+            settings.cabinet = lookupCabinetById(payload.getCabinet());
+            settings.noise_gate = payload.getNoiseGate();
+            settings.master_vol = payload.getMasterVolume();
+            settings.gain2 = payload.getGain2();
+            settings.presence = payload.getPresence();
+            settings.threshold = payload.getThreshold();
+            settings.depth = payload.getDepth();
+            settings.bias = payload.getBias();
+            settings.sag = payload.getSag();
+            settings.brightness = payload.getBrightness();
+            settings.usb_gain = packetUsbGain.getPayload().getUsbGain();
+            return settings;
+        }
+
+        template <class EffectPacket>
+        fx_pedal_settings decodeEffect(const EffectPacket& packet)
+        {
+            const auto payload = packet.getPayload();
+            return fx_pedal_settings{FxSlot{payload.getSlot()},
+                                     lookupEffectById(payload.getModel()),
+                                     payload.getKnob1(),
+                                     payload.getKnob2(),
+                                     payload.getKnob3(),
+                                     payload.getKnob4(),
+                                     payload.getKnob5(),
+                                     payload.getKnob6(),
+                                     true};
         }
     }
 
@@ -138,48 +139,38 @@ namespace plug::com
         return packet.getPayload().getName();
     }
 
+    std::string decodeNameFromData(PacketView<NamePayload> packet)
+    {
+        return packet.getPayload().getName();
+    }
+
     amp_settings decodeAmpFromData(const Packet<AmpPayload>& packet, const Packet<AmpPayload>& packetUsbGain)
     {
-        const auto payload = packet.getPayload();
-
-        amp_settings settings{};
-        settings.amp_num = lookupAmpById(payload.getModel());
-        settings.gain = payload.getGain();
-        settings.volume = payload.getVolume();
-        settings.treble = payload.getTreble();
-        settings.middle = payload.getMiddle();
-        settings.bass = payload.getBass();
-        settings.cabinet = lookupCabinetById(payload.getCabinet());
-        settings.noise_gate = payload.getNoiseGate();
-        settings.master_vol = payload.getMasterVolume();
-        settings.gain2 = payload.getGain2();
-        settings.presence = payload.getPresence();
-        settings.threshold = payload.getThreshold();
-        settings.depth = payload.getDepth();
-        settings.bias = payload.getBias();
-        settings.sag = payload.getSag();
-        settings.brightness = payload.getBrightness();
-        settings.usb_gain = packetUsbGain.getPayload().getUsbGain();
-        return settings;
+        return decodeAmp(packet, packetUsbGain);
+    }
+
+    amp_settings decodeAmpFromData(PacketView<AmpPayload> packet, PacketView<AmpPayload> packetUsbGain)
+    {
+        return decodeAmp(packet, packetUsbGain);
+    }
+
+    fx_pedal_settings decodeEffectFromData(const Packet<EffectPayload>& packet)
+    {
+        return decodeEffect(packet);
+    }
+
+    fx_pedal_settings decodeEffectFromData(PacketView<EffectPayload> packet)
+    {
+        return decodeEffect(packet);
     }
 
     std::vector<fx_pedal_settings> decodeEffectsFromData(const std::array<Packet<EffectPayload>, 4>& packet)
     {
         std::vector<fx_pedal_settings> effects;
+        effects.reserve(packet.size());
 
         std::transform(packet.cbegin(), packet.cend(), std::back_inserter(effects), [](const auto& p)
-                       {
-            const auto payload = p.getPayload();
-            return fx_pedal_settings{FxSlot{payload.getSlot()},
-                    lookupEffectById(payload.getModel()),
-                    payload.getKnob1(),
-                    payload.getKnob2(),
-                    payload.getKnob3(),
-                    payload.getKnob4(),
-                    payload.getKnob5(),
-                    payload.getKnob6(),
-                    true
-                    }; });
+                       { return decodeEffectFromData(p); });
         return effects;
     }
 
@@ -197,15 +188,17 @@ namespace plug::com
         return presetNames;
     }
 
-    Packet<AmpPayload> serializeAmpSettings(const amp_settings& value)
+    void serializeAmpSettings(const amp_settings& value, PacketSpan<AmpPayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::data);
         header.setDSP(DSP::amp);
         header.setUnknown(0x00, 0x01, 0x01);
 
-        AmpPayload payload{};
+        auto payload = packet.getPayload();
         payload.setVolume(value.volume);
         payload.setGain(value.gain);
         payload.setGain2(value.gain2);
@@ -216,10 +209,9 @@ namespace plug::com
         payload.setPresence(value.presence);
         payload.setBias(value.bias);
         payload.setNoiseGate(clampToRange<std::uint8_t, 0x05>(value.noise_gate));
-        payload.setCabinet(plug::value(value.cabinet));
+        payload.setCabinet(lookupCabinet(value.cabinet).id);
         payload.setSag(clampToRange<std::uint8_t, 0x02>(value.sag));
         payload.setBrightness(value.brightness);
-        payload.setUnknown(0x80, 0x80, 0x01);
 
         if (value.noise_gate == 0x05)
         {
@@ -231,113 +223,77 @@ namespace plug::com
             payload.setDepth(0x80);
         }
 
-        switch (value.amp_num)
-        {
-            case amps::FENDER_57_DELUXE:
-                payload.setModel(0x67);
-                payload.setUnknownAmpSpecific(0x01, 0x01, 0x01, 0x01, 0x53);
-                break;
-
-            case amps::FENDER_59_BASSMAN:
-                payload.setModel(0x64);
-                payload.setUnknownAmpSpecific(0x02, 0x02, 0x02, 0x02, 0x67);
-                break;
-
-            case amps::FENDER_57_CHAMP:
-                payload.setModel(0x7c);
-                payload.setUnknownAmpSpecific(0x0c, 0x0c, 0x0c, 0x0c, 0x00);
-                break;
-
-            case amps::FENDER_65_DELUXE_REVERB:
-                payload.setModel(0x53);
-                payload.setUnknownAmpSpecific(0x03, 0x03, 0x03, 0x03, 0x6a);
-                payload.setUnknown(0x00, 0x00, 0x01);
-                break;
-
-            case amps::FENDER_65_PRINCETON:
-                payload.setModel(0x6a);
-                payload.setUnknownAmpSpecific(0x04, 0x04, 0x04, 0x04, 0x61);
-                break;
-
-            case amps::FENDER_65_TWIN_REVERB:
-                payload.setModel(0x75);
-                payload.setUnknownAmpSpecific(0x05, 0x05, 0x05, 0x05, 0x72);
-                break;
-
-            case amps::FENDER_SUPER_SONIC:
-                payload.setModel(0x72);
-                payload.setUnknownAmpSpecific(0x06, 0x06, 0x06, 0x06, 0x79);
-                break;
-
-            case amps::BRITISH_60S:
-                payload.setModel(0x61);
-                payload.setUnknownAmpSpecific(0x07, 0x07, 0x07, 0x07, 0x5e);
-                break;
-
-            case amps::BRITISH_70S:
-                payload.setModel(0x79);
-                payload.setUnknownAmpSpecific(0x0b, 0x0b, 0x0b, 0x0b, 0x7c);
-                break;
-
-            case amps::BRITISH_80S:
-                payload.setModel(0x5e);
-                payload.setUnknownAmpSpecific(0x09, 0x09, 0x09, 0x09, 0x5d);
-                break;
-
-            case amps::AMERICAN_90S:
-                payload.setModel(0x5d);
-                payload.setUnknownAmpSpecific(0x0a, 0x0a, 0x0a, 0x0a, 0x6d);
-                break;
-
-            case amps::METAL_2000:
-                payload.setModel(0x6d);
-                payload.setUnknownAmpSpecific(0x08, 0x08, 0x08, 0x08, 0x75);
-                break;
-        }
+        const auto& ids = lookupAmp(value.amp_num);
+        const auto& [s0, s1, s2, s3, s4] = ids.specific;
+        const auto& [u0, u1, u2] = ids.unknown;
+        payload.setModel(ids.id);
+        payload.setUnknownAmpSpecific(s0, s1, s2, s3, s4);
+        payload.setUnknown(u0, u1, u2);
+    }
 
-        return Packet<AmpPayload>{header, payload};
+    Packet<AmpPayload> serializeAmpSettings(const amp_settings& value)
+    {
+        return toPacket<AmpPayload>([&value](auto packet)
+                                    { serializeAmpSettings(value, packet); });
     }
 
-    Packet<AmpPayload> serializeAmpSettingsUsbGain(const amp_settings& value)
+    void serializeAmpSettingsUsbGain(const amp_settings& value, PacketSpan<AmpPayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::data);
         header.setDSP(DSP::usbGain);
         header.setUnknown(0x00, 0x01, 0x01);
 
-        AmpPayload payload{};
+        auto payload = packet.getPayload();
         payload.setUsbGain(value.usb_gain);
+    }
 
-        return Packet<AmpPayload>{header, payload};
+    Packet<AmpPayload> serializeAmpSettingsUsbGain(const amp_settings& value)
+    {
+        return toPacket<AmpPayload>([&value](auto packet)
+                                    { serializeAmpSettingsUsbGain(value, packet); });
     }
 
-    Packet<NamePayload> serializeName(std::uint8_t slot, std::string_view name)
+    void serializeName(std::uint8_t slot, std::string_view name, PacketSpan<NamePayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::operation);
         header.setDSP(DSP::opSave);
         header.setSlot(slot);
         header.setUnknown(0x00, 0x01, 0x01);
 
-        NamePayload payload{};
+        auto payload = packet.getPayload();
         payload.setName(name);
+    }
 
-        return Packet<NamePayload>{header, payload};
+    Packet<NamePayload> serializeName(std::uint8_t slot, std::string_view name)
+    {
+        return toPacket<NamePayload>([slot, name](auto packet)
+                                     { serializeName(slot, name, packet); });
     }
 
-    Packet<EffectPayload> serializeEffectSettings(const fx_pedal_settings& value)
+    void serializeEffectSettings(const fx_pedal_settings& value, PacketSpan<EffectPayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::data);
         header.setUnknown(0x00, 0x01, 0x01);
         header.setDSP(dspFromEffect(value.effect_num));
 
-        EffectPayload payload{};
+        auto payload = packet.getPayload();
+        const auto& ids = lookupEffect(value.effect_num);
+        const auto& [u0, u1, u2] = ids.unknown;
+        payload.setModel(ids.id);
         payload.setSlot(value.slot.id());
-        payload.setUnknown(0x00, 0x08, 0x01);
+        payload.setUnknown(u0, u1, u2);
         payload.setKnob1(value.knob1);
         payload.setKnob2(value.knob2);
         payload.setKnob3(value.knob3);
@@ -351,203 +307,54 @@ namespace plug::com
 
         switch (value.effect_num)
         {
-            case effects::OVERDRIVE:
-                payload.setModel(0x3c);
-                break;
-
-            case effects::WAH:
-                payload.setModel(0x49);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::TOUCH_WAH:
-                payload.setModel(0x4a);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::FUZZ:
-                payload.setModel(0x1a);
-                break;
-
-            case effects::FUZZ_TOUCH_WAH:
-                payload.setModel(0x1c);
-                break;
-
             case effects::SIMPLE_COMP:
-                payload.setModel(0x88);
                 payload.setKnob1(clampToRange<std::uint8_t, 0x03>(value.knob1));
                 payload.setKnob2(0x00);
                 payload.setKnob3(0x00);
                 payload.setKnob4(0x00);
                 payload.setKnob5(0x00);
-                payload.setUnknown(0x08, 0x08, 0x01);
-                break;
-
-            case effects::COMPRESSOR:
-                payload.setModel(0x07);
-                break;
-
-            case effects::SINE_CHORUS:
-                payload.setModel(0x12);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::TRIANGLE_CHORUS:
-                payload.setModel(0x13);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::SINE_FLANGER:
-                payload.setModel(0x18);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::TRIANGLE_FLANGER:
-                payload.setModel(0x19);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::VIBRATONE:
-                payload.setModel(0x2d);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::VINTAGE_TREMOLO:
-                payload.setModel(0x40);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::SINE_TREMOLO:
-                payload.setModel(0x41);
-                payload.setUnknown(0x01, 0x01, 0x01);
                 break;
 
             case effects::RING_MODULATOR:
-                payload.setModel(0x22);
                 payload.setKnob4(clampToRange<std::uint8_t, 0x01>(value.knob4));
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::STEP_FILTER:
-                payload.setModel(0x29);
-                payload.setUnknown(0x01, 0x01, 0x01);
                 break;
 
             case effects::PHASER:
-                payload.setModel(0x4f);
                 payload.setKnob5(clampToRange<std::uint8_t, 0x01>(value.knob5));
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::PITCH_SHIFTER:
-                payload.setModel(0x1f);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::MONO_DELAY:
-                payload.setModel(0x16);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::MONO_ECHO_FILTER:
-                payload.setModel(0x43);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::STEREO_ECHO_FILTER:
-                payload.setModel(0x48);
-                payload.setUnknown(0x02, 0x01, 0x01);
                 break;
 
             case effects::MULTITAP_DELAY:
-                payload.setModel(0x44);
                 payload.setKnob5(clampToRange<std::uint8_t, 0x03>(value.knob5));
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::PING_PONG_DELAY:
-                payload.setModel(0x45);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::DUCKING_DELAY:
-                payload.setModel(0x15);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::REVERSE_DELAY:
-                payload.setModel(0x46);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::TAPE_DELAY:
-                payload.setModel(0x2b);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::STEREO_TAPE_DELAY:
-                payload.setModel(0x2a);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::SMALL_HALL_REVERB:
-                payload.setModel(0x24);
-                break;
-
-            case effects::LARGE_HALL_REVERB:
-                payload.setModel(0x3a);
-                break;
-
-            case effects::SMALL_ROOM_REVERB:
-                payload.setModel(0x26);
-                break;
-
-            case effects::LARGE_ROOM_REVERB:
-                payload.setModel(0x3b);
-                break;
-
-            case effects::SMALL_PLATE_REVERB:
-                payload.setModel(0x4e);
-                break;
-
-            case effects::LARGE_PLATE_REVERB:
-                payload.setModel(0x4b);
-                break;
-
-            case effects::AMBIENT_REVERB:
-                payload.setModel(0x4c);
-                break;
-
-            case effects::ARENA_REVERB:
-                payload.setModel(0x4d);
-                break;
-
-            case effects::FENDER_63_SPRING_REVERB:
-                payload.setModel(0x21);
-                break;
-
-            case effects::FENDER_65_SPRING_REVERB:
-                payload.setModel(0x0b);
                 break;
 
             default:
                 break;
         }
+    }
 
-        return Packet<EffectPayload>{header, payload};
+    Packet<EffectPayload> serializeEffectSettings(const fx_pedal_settings& value)
+    {
+        return toPacket<EffectPayload>([&value](auto packet)
+                                       { serializeEffectSettings(value, packet); });
     }
 
-    Packet<EffectPayload> serializeClearEffectSettings(fx_pedal_settings effect)
+    void serializeClearEffectSettings(const fx_pedal_settings& effect, PacketSpan<EffectPayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::data);
         header.setDSP(dspFromEffect(effect.effect_num));
         header.setUnknown(0x00, 0x01, 0x01);
-        EffectPayload payload{};
+        auto payload = packet.getPayload();
         payload.setUnknown(0x00, 0x08, 0x01);
+    }
 
-        return Packet<EffectPayload>{header, payload};
+    Packet<EffectPayload> serializeClearEffectSettings(fx_pedal_settings effect)
+    {
+        return toPacket<EffectPayload>([&effect](auto packet)
+                                       { serializeClearEffectSettings(effect, packet); });
     }
 
     Packet<NamePayload> serializeSaveEffectName(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects)
@@ -625,13 +432,20 @@ namespace plug::com
         return Packet<EmptyPayload>{header, EmptyPayload{}};
     }
 
-    Packet<EmptyPayload> serializeApplyCommand()
+    void serializeApplyCommand(PacketSpan<EmptyPayload> packet)
     {
-        Header header{};
+        packet.clear();
+
+        auto header = packet.getHeader();
         header.setStage(Stage::ready);
         header.setType(Type::data);
         header.setDSP(DSP::none);
-        return Packet<EmptyPayload>{header, EmptyPayload{}};
+    }
+
+    Packet<EmptyPayload> serializeApplyCommand()
+    {
+        return toPacket<EmptyPayload>([](auto packet)
+                                      { serializeApplyCommand(packet); });
     }
 
     Packet<EmptyPayload> serializeApplyCommand(fx_pedal_settings effect)
@@ -0,0 +1,79 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/PresetCache.h"
+
+namespace plug::com
+{
+    PresetCache::PresetCache(std::size_t numberOfSlots)
+        : mutex(), slots(numberOfSlots)
+    {
+    }
+
+    void PresetCache::reset(std::size_t numberOfSlots)
+    {
+        std::lock_guard lock{mutex};
+        slots.assign(numberOfSlots, std::nullopt);
+    }
+
+    std::size_t PresetCache::size() const
+    {
+        std::lock_guard lock{mutex};
+        return slots.size();
+    }
+
+    std::optional<SignalChain> PresetCache::get(std::uint8_t slot) const
+    {
+        std::lock_guard lock{mutex};
+
+        if (slot >= slots.size())
+        {
+            return std::nullopt;
+        }
+        return slots[slot];
+    }
+
+    bool PresetCache::contains(std::uint8_t slot) const
+    {
+        std::lock_guard lock{mutex};
+        return (slot < slots.size()) && slots[slot].has_value();
+    }
+
+    // Slots out of range are ignored, e.g. after a disconnect
+    void PresetCache::put(std::uint8_t slot, const SignalChain& signalChain)
+    {
+        std::lock_guard lock{mutex};
+
+        if (slot < slots.size())
+        {
+            slots[slot] = signalChain;
+        }
+    }
+
+    void PresetCache::invalidate(std::uint8_t slot)
+    {
+        std::lock_guard lock{mutex};
+
+        if (slot < slots.size())
+        {
+            slots[slot].reset();
+        }
+    }
+}
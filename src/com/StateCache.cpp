@@ -0,0 +1,342 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/StateCache.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace plug::com
+{
+    namespace
+    {
+        inline constexpr std::array<char, 4> magic{{'P', 'L', 'U', 'G'}};
+        inline constexpr std::uint8_t formatVersion{1};
+        inline constexpr std::size_t maxCount{0xffff};
+
+
+        void writeByte(std::ostream& stream, std::uint8_t value)
+        {
+            stream.put(static_cast<char>(value));
+        }
+
+        void writeCount(std::ostream& stream, std::size_t value)
+        {
+            if (value > maxCount)
+            {
+                throw std::length_error{"State cache entry too large: " + std::to_string(value)};
+            }
+            writeByte(stream, static_cast<std::uint8_t>(value & 0xff));
+            writeByte(stream, static_cast<std::uint8_t>(value >> 8));
+        }
+
+        void writeString(std::ostream& stream, const std::string& value)
+        {
+            writeCount(stream, value.size());
+            stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        void writeEffects(std::ostream& stream, const std::vector<fx_pedal_settings>& effects)
+        {
+            writeCount(stream, effects.size());
+
+            std::for_each(effects.cbegin(), effects.cend(), [&stream](const auto& effect)
+                          {
+                writeByte(stream, effect.slot.id());
+                writeByte(stream, value(effect.effect_num));
+                writeByte(stream, effect.knob1);
+                writeByte(stream, effect.knob2);
+                writeByte(stream, effect.knob3);
+                writeByte(stream, effect.knob4);
+                writeByte(stream, effect.knob5);
+                writeByte(stream, effect.knob6);
+                writeByte(stream, effect.enabled ? 1 : 0); });
+        }
+
+        void writeSignalChain(std::ostream& stream, const SignalChain& signalChain)
+        {
+            const auto amp = signalChain.amp();
+
+            writeString(stream, signalChain.name());
+            writeByte(stream, value(amp.amp_num));
+            writeByte(stream, amp.gain);
+            writeByte(stream, amp.volume);
+            writeByte(stream, amp.treble);
+            writeByte(stream, amp.middle);
+            writeByte(stream, amp.bass);
+            writeByte(stream, value(amp.cabinet));
+            writeByte(stream, amp.noise_gate);
+            writeByte(stream, amp.master_vol);
+            writeByte(stream, amp.gain2);
+            writeByte(stream, amp.presence);
+            writeByte(stream, amp.threshold);
+            writeByte(stream, amp.depth);
+            writeByte(stream, amp.bias);
+            writeByte(stream, amp.sag);
+            writeByte(stream, amp.brightness ? 1 : 0);
+            writeByte(stream, amp.usb_gain);
+            writeEffects(stream, signalChain.effects());
+        }
+
+
+        std::uint8_t readByte(std::istream& stream)
+        {
+            const auto value = stream.get();
+
+            if (value == std::istream::traits_type::eof())
+            {
+                throw std::runtime_error{"State cache truncated"};
+            }
+            return static_cast<std::uint8_t>(value);
+        }
+
+        std::size_t readCount(std::istream& stream)
+        {
+            const std::size_t low = readByte(stream);
+            const std::size_t high = readByte(stream);
+            return low | (high << 8);
+        }
+
+        std::string readString(std::istream& stream)
+        {
+            std::string value(readCount(stream), '\0');
+            stream.read(value.data(), static_cast<std::streamsize>(value.size()));
+
+            if (static_cast<std::size_t>(stream.gcount()) != value.size())
+            {
+                throw std::runtime_error{"State cache truncated"};
+            }
+            return value;
+        }
+
+        template <class Enum>
+        Enum readEnum(std::istream& stream, Enum last)
+        {
+            const auto id = readByte(stream);
+
+            if (id > value(last))
+            {
+                throw std::invalid_argument{"Invalid id in state cache: " + std::to_string(id)};
+            }
+            return static_cast<Enum>(id);
+        }
+
+        std::vector<fx_pedal_settings> readEffects(std::istream& stream)
+        {
+            std::vector<fx_pedal_settings> result(readCount(stream), fx_pedal_settings{FxSlot{0}, effects::EMPTY, 0, 0, 0, 0, 0, 0});
+
+            std::generate(result.begin(), result.end(), [&stream]
+                          {
+                const FxSlot slot{readByte(stream)};
+                const auto effect = readEnum(stream, effects::FENDER_65_SPRING_REVERB);
+                const auto knob1 = readByte(stream);
+                const auto knob2 = readByte(stream);
+                const auto knob3 = readByte(stream);
+                const auto knob4 = readByte(stream);
+                const auto knob5 = readByte(stream);
+                const auto knob6 = readByte(stream);
+                const bool enabled = (readByte(stream) != 0);
+                return fx_pedal_settings{slot, effect, knob1, knob2, knob3, knob4, knob5, knob6, enabled}; });
+            return result;
+        }
+
+        SignalChain readSignalChain(std::istream& stream)
+        {
+            const auto name = readString(stream);
+
+            amp_settings amp{};
+            amp.amp_num = readEnum(stream, amps::METAL_2000);
+            amp.gain = readByte(stream);
+            amp.volume = readByte(stream);
+            amp.treble = readByte(stream);
+            amp.middle = readByte(stream);
+            amp.bass = readByte(stream);
+            amp.cabinet = readEnum(stream, cabinets::cabSS112);
+            amp.noise_gate = readByte(stream);
+            amp.master_vol = readByte(stream);
+            amp.gain2 = readByte(stream);
+            amp.presence = readByte(stream);
+            amp.threshold = readByte(stream);
+            amp.depth = readByte(stream);
+            amp.bias = readByte(stream);
+            amp.sag = readByte(stream);
+            amp.brightness = (readByte(stream) != 0);
+            amp.usb_gain = readByte(stream);
+
+            return SignalChain{name, amp, readEffects(stream)};
+        }
+
+        EffectKnob readKnob(std::istream& stream)
+        {
+            const auto knob = readByte(stream);
+
+            if (knob > static_cast<std::uint8_t>(EffectKnob::dlyRev))
+            {
+                throw std::invalid_argument{"Invalid effect knob in state cache: " + std::to_string(knob)};
+            }
+            return static_cast<EffectKnob>(knob);
+        }
+
+        std::filesystem::path cacheFile(const std::filesystem::path& directory, const std::string& key)
+        {
+            return directory / (key + ".cache");
+        }
+    }
+
+
+    std::string stateCacheKey(const DeviceModel& model, const std::string& deviceName, const std::string& deviceIdentity)
+    {
+        const std::string category = [&model]
+        {
+            switch (model.category())
+            {
+                case DeviceModel::Category::MustangV1:
+                    return "v1";
+                case DeviceModel::Category::MustangV2:
+                    return "v2";
+                default:
+                    return "other";
+            }
+        }();
+
+        std::string key = model.name() + "-" + category + "-" + deviceName + "-" + deviceIdentity;
+        std::replace_if(key.begin(), key.end(), [](char c)
+                        { return std::isalnum(static_cast<unsigned char>(c)) == 0; }, '_');
+        return key;
+    }
+
+    void writeStateCache(std::ostream& stream, const std::string& key, const CachedState& state)
+    {
+        stream.write(magic.data(), magic.size());
+        writeByte(stream, formatVersion);
+        writeString(stream, key);
+
+        writeCount(stream, state.presetNames.size());
+        std::for_each(state.presetNames.cbegin(), state.presetNames.cend(), [&stream](const auto& name)
+                      { writeString(stream, name); });
+
+        writeSignalChain(stream, state.signalChain);
+
+        writeCount(stream, state.banks.size());
+        std::for_each(state.banks.cbegin(), state.banks.cend(), [&stream](const auto& bank)
+                      {
+            writeByte(stream, bank ? 1 : 0);
+
+            if (bank)
+            {
+                writeSignalChain(stream, *bank);
+            } });
+
+        writeCount(stream, state.effectPresets.size());
+        std::for_each(state.effectPresets.cbegin(), state.effectPresets.cend(), [&stream](const auto& preset)
+                      {
+            writeByte(stream, static_cast<std::uint8_t>(preset.knob));
+            writeByte(stream, preset.slot);
+            writeString(stream, preset.name);
+            writeEffects(stream, preset.effects); });
+    }
+
+    std::optional<CachedState> readStateCache(std::istream& stream, const std::string& key)
+    {
+        try
+        {
+            std::array<char, magic.size()> header{};
+            stream.read(header.data(), header.size());
+
+            if ((header != magic) || (readByte(stream) != formatVersion) || (readString(stream) != key))
+            {
+                return std::nullopt;
+            }
+
+            CachedState state{};
+            state.presetNames.resize(readCount(stream));
+            std::generate(state.presetNames.begin(), state.presetNames.end(), [&stream]
+                          { return readString(stream); });
+
+            state.signalChain = readSignalChain(stream);
+
+            state.banks.resize(readCount(stream));
+            std::generate(state.banks.begin(), state.banks.end(), [&stream]() -> std::optional<SignalChain>
+                          {
+                if (readByte(stream) == 0)
+                {
+                    return std::nullopt;
+                }
+                return readSignalChain(stream); });
+
+            const auto numberOfEffectPresets = readCount(stream);
+            state.effectPresets.reserve(numberOfEffectPresets);
+
+            for (std::size_t i = 0; i < numberOfEffectPresets; ++i)
+            {
+                const auto knob = readKnob(stream);
+                const auto slot = readByte(stream);
+                auto name = readString(stream);
+                state.effectPresets.push_back(EffectPreset{knob, slot, std::move(name), readEffects(stream)});
+            }
+            return state;
+        }
+        catch (const std::runtime_error&)
+        {
+            return std::nullopt;
+        }
+        catch (const std::invalid_argument&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    // Written to a temporary file first, so an interrupted write keeps
+    // the previous cache
+    void saveStateCache(const std::filesystem::path& directory, const std::string& key, const CachedState& state)
+    {
+        std::filesystem::create_directories(directory);
+
+        const auto file = cacheFile(directory, key);
+        auto temporary = file;
+        temporary += ".tmp";
+
+        {
+            std::ofstream stream{temporary, std::ios::binary | std::ios::trunc};
+            writeStateCache(stream, key, state);
+
+            if (!stream.flush())
+            {
+                throw std::runtime_error{"Unable to write state cache: " + temporary.string()};
+            }
+        }
+        std::filesystem::rename(temporary, file);
+    }
+
+    std::optional<CachedState> loadStateCache(const std::filesystem::path& directory, const std::string& key)
+    {
+        std::ifstream stream{cacheFile(directory, key), std::ios::binary};
+
+        if (!stream)
+        {
+            return std::nullopt;
+        }
+        return readStateCache(stream, key);
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/UpdateCoalescer.h"
+#include "com/CommandPlanner.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Effects are bound to their DSP, whatever slot they're in; empty
+        // effects have no DSP and address their slot
+        bool isSameTarget(const fx_pedal_settings& pending, const fx_pedal_settings& value)
+        {
+            if (const auto dsp = effectDspIndex(value); dsp)
+            {
+                return effectDspIndex(pending) == dsp;
+            }
+            return pending.slot.id() == value.slot.id();
+        }
+    }
+
+
+    TokenBucket::TokenBucket(std::size_t capacity, Clock::duration refillInterval, Clock::time_point now)
+        : maxTokens(static_cast<double>(capacity)), tokens(static_cast<double>(capacity)), interval(refillInterval), last(now)
+    {
+    }
+
+    bool TokenBucket::tryConsume(Clock::time_point now)
+    {
+        refill(now);
+
+        if (tokens < 1.0)
+        {
+            return false;
+        }
+        tokens -= 1.0;
+        return true;
+    }
+
+    TokenBucket::Clock::duration TokenBucket::waitTime(Clock::time_point now)
+    {
+        refill(now);
+
+        if (tokens >= 1.0)
+        {
+            return Clock::duration::zero();
+        }
+        return std::chrono::duration_cast<Clock::duration>(interval * (1.0 - tokens));
+    }
+
+    void TokenBucket::setRefillInterval(Clock::duration value)
+    {
+        interval = value;
+    }
+
+    TokenBucket::Clock::duration TokenBucket::refillInterval() const
+    {
+        return interval;
+    }
+
+    void TokenBucket::refill(Clock::time_point now)
+    {
+        if (interval > Clock::duration::zero())
+        {
+            const auto elapsed = std::chrono::duration<double>(now - last) / std::chrono::duration<double>(interval);
+            tokens = std::min(maxTokens, tokens + elapsed);
+        }
+        else
+        {
+            tokens = maxTokens;
+        }
+        last = now;
+    }
+
+
+    UpdateCoalescer::UpdateCoalescer()
+        : mutex(), amp(), effects(), lastUpdate(), counters{0, 0}
+    {
+    }
+
+    bool UpdateCoalescer::push(amp_settings value, TokenBucket::Clock::time_point now)
+    {
+        std::lock_guard lock{mutex};
+        const bool wasEmpty = isEmpty();
+        lastUpdate = now;
+
+        if (amp)
+        {
+            ++counters.coalesced;
+        }
+        amp = value;
+        return wasEmpty;
+    }
+
+    bool UpdateCoalescer::push(fx_pedal_settings value, TokenBucket::Clock::time_point now)
+    {
+        std::lock_guard lock{mutex};
+        const bool wasEmpty = isEmpty();
+        lastUpdate = now;
+
+        // the update moves to the end, so the planner sees the updates in
+        // the order they were made
+        const auto replaced = std::remove_if(effects.begin(), effects.end(), [&value](const auto& pending)
+                                             { return isSameTarget(pending, value); });
+        counters.coalesced += static_cast<std::uint64_t>(std::distance(replaced, effects.end()));
+        effects.erase(replaced, effects.end());
+        effects.push_back(value);
+        return wasEmpty;
+    }
+
+    PendingUpdates UpdateCoalescer::take()
+    {
+        std::lock_guard lock{mutex};
+        return PendingUpdates{std::exchange(amp, std::nullopt), std::exchange(effects, {}), lastUpdate};
+    }
+
+    void UpdateCoalescer::drop(std::size_t count)
+    {
+        std::lock_guard lock{mutex};
+        counters.dropped += count;
+    }
+
+    CoalescingStats UpdateCoalescer::stats() const
+    {
+        std::lock_guard lock{mutex};
+        return counters;
+    }
+
+    bool UpdateCoalescer::isEmpty() const
+    {
+        return !amp && effects.empty();
+    }
+}
@@ -21,7 +21,12 @@
 #include "com/UsbComm.h"
 #include "com/CommunicationException.h"
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <utility>
 
 namespace plug::com
 {
@@ -29,6 +34,8 @@ namespace plug::com
     {
         inline constexpr std::uint8_t endpointSend{0x01};
         inline constexpr std::uint8_t endpointRecv{0x81};
+        inline constexpr std::size_t receiveQueueCapacity{512};
+        inline constexpr std::size_t maxBatchSize{16};
 
         usb::Device openDevice(usb::Device&& device)
         {
@@ -37,9 +44,68 @@ namespace plug::com
         }
     }
 
-    UsbComm::UsbComm(usb::Device device)
-        : device_(openDevice(std::move(device))), name_(device_.name())
+    // Fixed size ring of received packets; if it's full, further packets
+    // are lost and the next receive reports the overflow
+    struct UsbComm::ReceiveQueue
     {
+        struct Entry
+        {
+            PacketRawType data;
+            std::size_t size;
+        };
+
+        void push(std::span<const std::uint8_t> data)
+        {
+            if (count == entries.size())
+            {
+                overflow = true;
+                return;
+            }
+
+            auto& entry = entries[(head + count) % entries.size()];
+            entry.size = std::min(data.size(), entry.data.size());
+            std::copy_n(data.begin(), entry.size, entry.data.begin());
+            ++count;
+        }
+
+        std::size_t pop(std::span<std::uint8_t> buffer)
+        {
+            const auto& entry = entries[head];
+            const auto n = std::min(entry.size, buffer.size());
+            std::copy_n(entry.data.cbegin(), n, buffer.begin());
+            head = (head + 1) % entries.size();
+            --count;
+            return n;
+        }
+
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::array<Entry, receiveQueueCapacity> entries;
+        std::size_t head{0};
+        std::size_t count{0};
+        bool overflow{false};
+        std::exception_ptr error;
+    };
+
+
+    UsbComm::UsbComm(usb::Device device, std::chrono::milliseconds receiveTimeout)
+        : device_(openDevice(std::move(device))), received_(std::make_shared<ReceiveQueue>()), receiveTimeout_(receiveTimeout)
+    {
+        device_.startReceiving(endpointRecv, packetRawTypeSize, [queue = received_](std::span<const std::uint8_t> data, std::exception_ptr error)
+                               {
+                                   {
+                                       std::lock_guard lock{queue->mutex};
+
+                                       if (error)
+                                       {
+                                           queue->error = error;
+                                       }
+                                       else
+                                       {
+                                           queue->push(data);
+                                       }
+                                   }
+                                   queue->ready.notify_one(); });
     }
 
     void UsbComm::close()
@@ -52,18 +118,74 @@ namespace plug::com
         return device_.isOpen();
     }
 
-    std::vector<std::uint8_t> UsbComm::receive(std::size_t recvSize)
+    std::size_t UsbComm::sendBatch(std::span<const PacketRawType> packets)
     {
-        return device_.receive(endpointRecv, recvSize);
+        std::array<usb::PendingWrite, maxBatchSize> pending;
+        std::size_t n{0};
+
+        for (std::size_t offset = 0; offset < packets.size(); offset += pending.size())
+        {
+            const auto chunk = packets.subspan(offset, std::min(pending.size(), packets.size() - offset));
+            std::transform(chunk.begin(), chunk.end(), pending.begin(), [this](const auto& packet)
+                           { return device_.writeAsync(endpointSend, packet); });
+            n = std::accumulate(pending.begin(), std::next(pending.begin(), chunk.size()), n, [](std::size_t sum, auto& result)
+                                { return sum + result.get(); });
+        }
+        return n;
     }
 
+    std::size_t UsbComm::receiveInto(std::span<std::uint8_t> buffer)
+    {
+        std::unique_lock lock{received_->mutex};
+
+        if (!received_->ready.wait_for(lock, receiveTimeout_.load(), [this]
+                                       { return (received_->count > 0) || received_->overflow || received_->error; }))
+        {
+            return 0;
+        }
+
+        if (std::exchange(received_->overflow, false))
+        {
+            throw CommunicationException{"Receive queue overflow, packets were lost"};
+        }
+
+        if (received_->count == 0)
+        {
+            std::rethrow_exception(std::exchange(received_->error, nullptr));
+        }
+        return received_->pop(buffer);
+    }
+
+    void UsbComm::setReceiveTimeout(std::chrono::milliseconds timeout)
+    {
+        receiveTimeout_.store(timeout);
+    }
+
+    void UsbComm::discardReceived()
+    {
+        std::lock_guard lock{received_->mutex};
+        received_->count = 0;
+        received_->overflow = false;
+    }
+
+    // Read on demand, an amp in update mode may have no product string
     std::string UsbComm::name() const
     {
-        return name_;
+        return device_.name();
+    }
+
+    // The serial number if the amp reports one, otherwise the port it's plugged into
+    std::string UsbComm::identity() const
+    {
+        if (auto serial = device_.serialNumber(); !serial.empty())
+        {
+            return serial;
+        }
+        return device_.location();
     }
 
-    std::size_t UsbComm::sendImpl(std::uint8_t* data, std::size_t size)
+    std::size_t UsbComm::sendImpl(const std::uint8_t* data, std::size_t size)
     {
-        return device_.write(endpointSend, data, size);
+        return device_.writeAsync(endpointSend, {data, size}).get();
     }
 }
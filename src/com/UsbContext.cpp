@@ -25,34 +25,41 @@
 
 namespace plug::com::usb
 {
+    namespace detail
+    {
+        void releaseContext(libusb_context* context)
+        {
+            libusb_exit(context);
+        }
+    }
+
+
     Context::Context()
+        : context_(init())
     {
-        init();
     }
 
-    Context::~Context()
+    libusb_context* Context::get() const noexcept
     {
-        deinit();
+        return context_.get();
     }
 
-    void Context::init()
+    libusb_context* Context::init()
     {
-        if (const int status = libusb_init(nullptr); status != LIBUSB_SUCCESS)
+        libusb_context* context{nullptr};
+
+        if (const int status = libusb_init(&context); status != LIBUSB_SUCCESS)
         {
             throw UsbException{status};
         }
-    }
-
-    void Context::deinit()
-    {
-        libusb_exit(nullptr);
+        return context;
     }
 
 
-    std::vector<Device> listDevices()
+    std::vector<Device> listDevices(libusb_context* context)
     {
         libusb_device** devices;
-        const auto n = libusb_get_device_list(nullptr, &devices);
+        const auto n = libusb_get_device_list(context, &devices);
 
         if (n < 0)
         {
@@ -62,11 +69,11 @@ namespace plug::com::usb
         std::vector<Device> devicesFound;
         devicesFound.reserve(n);
 
-        std::for_each(devices, std::next(devices, n), [&devicesFound](auto* dev)
+        std::for_each(devices, std::next(devices, n), [&devicesFound, context](auto* dev)
                       {
             try
             {
-                devicesFound.emplace_back(dev);
+                devicesFound.emplace_back(context, dev);
             }
             catch (const UsbException&)
             {
@@ -75,4 +82,29 @@ namespace plug::com::usb
         libusb_free_device_list(devices, 1);
         return devicesFound;
     }
+
+    std::vector<Device> listDevices(libusb_context* context, const DeviceFilter& filter)
+    {
+        libusb_device** devices;
+        const auto n = libusb_get_device_list(context, &devices);
+
+        if (n < 0)
+        {
+            throw UsbException(n);
+        }
+
+        std::vector<Device> devicesFound;
+
+        std::for_each(devices, std::next(devices, n), [&devicesFound, &filter, context](auto* dev)
+                      {
+            libusb_device_descriptor descriptor;
+
+            if ((libusb_get_device_descriptor(dev, &descriptor) == LIBUSB_SUCCESS) && filter(descriptor.idVendor, descriptor.idProduct))
+            {
+                devicesFound.emplace_back(context, dev, descriptor);
+            } });
+
+        libusb_free_device_list(devices, 1);
+        return devicesFound;
+    }
 }
@@ -43,11 +43,21 @@ namespace plug::com::usb
             libusb_release_interface(handle, 0);
             libusb_close(handle);
         }
+
+        void releaseTransport(Transport* transport)
+        {
+            delete transport;
+        }
     }
 
 
-    Device::Device(libusb_device* device)
-        : device_(libusb_ref_device(device)), handle_(nullptr), descriptor_(getDeviceDescriptor(device))
+    Device::Device(libusb_context* context, libusb_device* device)
+        : context_(context), device_(libusb_ref_device(device)), handle_(nullptr), transport_(nullptr), descriptor_(getDeviceDescriptor(device))
+    {
+    }
+
+    Device::Device(libusb_context* context, libusb_device* device, const libusb_device_descriptor& descriptor)
+        : context_(context), device_(libusb_ref_device(device)), handle_(nullptr), transport_(nullptr), descriptor_({descriptor.idVendor, descriptor.idProduct, descriptor.iProduct, descriptor.iSerialNumber})
     {
     }
 
@@ -74,6 +84,7 @@ namespace plug::com::usb
 
     void Device::close()
     {
+        transport_ = nullptr;
         handle_ = nullptr;
     }
 
@@ -94,14 +105,36 @@ namespace plug::com::usb
 
     std::string Device::name() const
     {
-        std::array<std::uint8_t, 256> buffer{{}};
-        const int n = libusb_get_string_descriptor_ascii(handle_.get(), descriptor_.stringDescriptorIndex, buffer.data(), buffer.size());
+        return readString(descriptor_.stringDescriptorIndex);
+    }
+
+    // Empty if the device doesn't report a serial number
+    std::string Device::serialNumber() const
+    {
+        if (descriptor_.serialNumberIndex == 0)
+        {
+            return "";
+        }
+        return readString(descriptor_.serialNumberIndex);
+    }
+
+    // Bus and port path, eg. "1-2.4"; stable as long as the device stays plugged into the same port
+    std::string Device::location() const
+    {
+        std::array<std::uint8_t, 7> ports{{}};
+        const int n = libusb_get_port_numbers(device_.get(), ports.data(), ports.size());
 
         if (n < 0)
         {
             throw UsbException{n};
         }
-        return std::string{buffer.cbegin(), std::next(buffer.cbegin(), n)};
+
+        std::string path = std::to_string(libusb_get_bus_number(device_.get()));
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n); ++i)
+        {
+            path += (i == 0 ? "-" : ".") + std::to_string(ports[i]);
+        }
+        return path;
     }
 
     std::size_t Device::write(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize)
@@ -128,6 +161,24 @@ namespace plug::com::usb
         return buffer;
     }
 
+    PendingWrite Device::writeAsync(std::uint8_t endpoint, std::span<const std::uint8_t> data)
+    {
+        return transport().write(endpoint, data);
+    }
+
+    void Device::startReceiving(std::uint8_t endpoint, std::size_t packetSize, ReceiveHandler handler)
+    {
+        transport().startReceiving(endpoint, packetSize, std::move(handler));
+    }
+
+    void Device::stopReceiving()
+    {
+        if (transport_ != nullptr)
+        {
+            transport_->stopReceiving();
+        }
+    }
+
     Device::Descriptor Device::getDeviceDescriptor(libusb_device* device) const
     {
         libusb_device_descriptor descriptor;
@@ -136,7 +187,28 @@ namespace plug::com::usb
         {
             throw UsbException{result};
         }
-        return {descriptor.idVendor, descriptor.idProduct, descriptor.iProduct};
+        return {descriptor.idVendor, descriptor.idProduct, descriptor.iProduct, descriptor.iSerialNumber};
+    }
+
+    std::string Device::readString(std::uint8_t index) const
+    {
+        std::array<std::uint8_t, 256> buffer{{}};
+        const int n = libusb_get_string_descriptor_ascii(handle_.get(), index, buffer.data(), buffer.size());
+
+        if (n < 0)
+        {
+            throw UsbException{n};
+        }
+        return std::string{buffer.cbegin(), std::next(buffer.cbegin(), n)};
+    }
+
+    Transport& Device::transport()
+    {
+        if (transport_ == nullptr)
+        {
+            transport_.reset(new Transport{context_, handle_.get()});
+        }
+        return *transport_;
     }
 
 }
@@ -0,0 +1,147 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/UsbHotplug.h"
+#include "com/UsbContext.h"
+#include "com/UsbException.h"
+#include "com/UsbTransport.h"
+#include <algorithm>
+#include <iterator>
+#include <libusb-1.0/libusb.h>
+
+namespace plug::com::usb
+{
+    namespace detail
+    {
+        void releaseEventThread(EventThread* thread)
+        {
+            delete thread;
+        }
+    }
+
+
+    HotplugMonitor::HotplugMonitor(libusb_context* context, std::uint16_t vendorId, const std::vector<std::uint16_t>& productIds, HotplugHandler handler, std::chrono::milliseconds pollInterval)
+        : context_(context), vendorId_(vendorId), productIds_(productIds), handler_(std::move(handler)), pollInterval_(pollInterval),
+          callbackHandle_(0), eventThread_(nullptr), running_(true), present_(), pollThread_()
+    {
+        if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG) != 0)
+        {
+            const auto callback = [](libusb_context*, libusb_device* device, libusb_hotplug_event event, void* userData) -> int
+            {
+                libusb_device_descriptor descriptor{};
+
+                if (libusb_get_device_descriptor(device, &descriptor) == LIBUSB_SUCCESS)
+                {
+                    static_cast<HotplugMonitor*>(userData)->deviceChanged(event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED ? HotplugEvent::arrived : HotplugEvent::left,
+                                                                          descriptor.idVendor, descriptor.idProduct);
+                }
+                return 0;
+            };
+
+            if (const int result = libusb_hotplug_register_callback(context_, static_cast<libusb_hotplug_event>(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+                                                                    LIBUSB_HOTPLUG_NO_FLAGS, vendorId_, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                                                    callback, this, &callbackHandle_);
+                result != LIBUSB_SUCCESS)
+            {
+                throw UsbException{result};
+            }
+            eventThread_.reset(new EventThread{context_});
+        }
+        else
+        {
+            present_ = scan();
+            pollThread_ = std::thread{&HotplugMonitor::poll, this};
+        }
+    }
+
+    HotplugMonitor::~HotplugMonitor()
+    {
+        if (eventThread_ != nullptr)
+        {
+            libusb_hotplug_deregister_callback(context_, callbackHandle_);
+            eventThread_.reset();
+        }
+        else
+        {
+            {
+                std::lock_guard lock{mutex_};
+                running_ = false;
+            }
+            stopped_.notify_all();
+            pollThread_.join();
+        }
+    }
+
+    bool HotplugMonitor::isPolling() const noexcept
+    {
+        return eventThread_ == nullptr;
+    }
+
+    void HotplugMonitor::deviceChanged(HotplugEvent event, std::uint16_t vendorId, std::uint16_t productId)
+    {
+        if ((vendorId == vendorId_) && (std::find(productIds_.cbegin(), productIds_.cend(), productId) != productIds_.cend()))
+        {
+            handler_(event, productId);
+        }
+    }
+
+    std::multiset<std::uint16_t> HotplugMonitor::scan() const
+    {
+        const auto devices = listDevices(context_, [this](std::uint16_t vendorId, std::uint16_t productId)
+                                         { return (vendorId == vendorId_) && (std::find(productIds_.cbegin(), productIds_.cend(), productId) != productIds_.cend()); });
+        std::multiset<std::uint16_t> found;
+
+        std::transform(devices.cbegin(), devices.cend(), std::inserter(found, found.end()), [](const auto& device)
+                       { return device.productId(); });
+        return found;
+    }
+
+    // Compares the matching devices of each scan with the previous one
+    void HotplugMonitor::poll()
+    {
+        std::unique_lock lock{mutex_};
+
+        while (!stopped_.wait_for(lock, pollInterval_, [this]
+                                  { return !running_; }))
+        {
+            lock.unlock();
+
+            try
+            {
+                const auto current = scan();
+                std::vector<std::uint16_t> left;
+                std::vector<std::uint16_t> arrived;
+                std::set_difference(present_.cbegin(), present_.cend(), current.cbegin(), current.cend(), std::back_inserter(left));
+                std::set_difference(current.cbegin(), current.cend(), present_.cbegin(), present_.cend(), std::back_inserter(arrived));
+                present_ = current;
+
+                std::for_each(left.cbegin(), left.cend(), [this](std::uint16_t productId)
+                              { deviceChanged(HotplugEvent::left, vendorId_, productId); });
+                std::for_each(arrived.cbegin(), arrived.cend(), [this](std::uint16_t productId)
+                              { deviceChanged(HotplugEvent::arrived, vendorId_, productId); });
+            }
+            catch (const UsbException&)
+            {
+            }
+
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,388 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "com/UsbTransport.h"
+#include "com/UsbException.h"
+#include <algorithm>
+#include <chrono>
+#include <libusb-1.0/libusb.h>
+
+namespace plug::com::usb
+{
+    namespace
+    {
+        inline constexpr std::chrono::milliseconds usbTimeout{500};
+        inline constexpr std::chrono::microseconds eventPollInterval{50'000};
+
+        int toErrorCode(int status)
+        {
+            switch (status)
+            {
+                case LIBUSB_TRANSFER_COMPLETED:
+                    return LIBUSB_SUCCESS;
+                case LIBUSB_TRANSFER_TIMED_OUT:
+                    return LIBUSB_ERROR_TIMEOUT;
+                case LIBUSB_TRANSFER_CANCELLED:
+                    return LIBUSB_ERROR_INTERRUPTED;
+                case LIBUSB_TRANSFER_STALL:
+                    return LIBUSB_ERROR_PIPE;
+                case LIBUSB_TRANSFER_NO_DEVICE:
+                    return LIBUSB_ERROR_NO_DEVICE;
+                case LIBUSB_TRANSFER_OVERFLOW:
+                    return LIBUSB_ERROR_OVERFLOW;
+                default:
+                    return LIBUSB_ERROR_IO;
+            }
+        }
+
+        void handleEvents(libusb_context* context, const std::atomic<bool>& running)
+        {
+            while (running)
+            {
+                timeval timeout{0, static_cast<decltype(timeval::tv_usec)>(eventPollInterval.count())};
+                libusb_handle_events_timeout_completed(context, &timeout, nullptr);
+            }
+        }
+
+        libusb_transfer* allocTransfer()
+        {
+            libusb_transfer* transfer = libusb_alloc_transfer(0);
+
+            if (transfer == nullptr)
+            {
+                throw UsbException{LIBUSB_ERROR_NO_MEM};
+            }
+            return transfer;
+        }
+    }
+
+
+    // Write transfers, their buffers and completion state are recycled, so
+    // nothing is allocated per write once the pool is warmed up
+    struct Transport::WriteRequest
+    {
+        Transport* owner{nullptr};
+        libusb_transfer* transfer{nullptr};
+        std::vector<std::uint8_t> buffer;
+        std::mutex mutex;
+        std::condition_variable completed;
+        bool done{false};
+        int status{LIBUSB_SUCCESS};
+        std::size_t transferred{0};
+    };
+
+
+    EventThread::EventThread(libusb_context* context)
+        : running_(true), thread_(handleEvents, context, std::cref(running_))
+    {
+    }
+
+    EventThread::~EventThread()
+    {
+        running_ = false;
+        thread_.join();
+    }
+
+
+    Transport::Transport(libusb_context* context, libusb_device_handle* handle)
+        : eventThread_(context), handle_(handle), receiving_(false)
+    {
+    }
+
+    Transport::~Transport()
+    {
+        stopReceiving();
+        cancel(false);
+
+        // Handles still held keep their (completed) request, but must not
+        // return it to the pool anymore
+        std::for_each(writeRequests_.cbegin(), writeRequests_.cend(), [](const auto& request)
+                      {
+                          {
+                              std::lock_guard lock{request->mutex};
+                              request->owner = nullptr;
+                          }
+                          libusb_free_transfer(request->transfer); });
+    }
+
+    PendingWrite Transport::write(std::uint8_t endpoint, std::span<const std::uint8_t> data)
+    {
+        auto request = acquireWriteRequest();
+        request->buffer.assign(data.begin(), data.end());
+        request->done = false;
+        libusb_fill_interrupt_transfer(request->transfer, handle_, endpoint, request->buffer.data(), static_cast<int>(request->buffer.size()),
+                                       &Transport::onWriteCompleted, request.get(), usbTimeout.count());
+
+        if (const int result = submit(request->transfer); result != LIBUSB_SUCCESS)
+        {
+            {
+                std::lock_guard lock{mutex_};
+                inFlight_.erase(request->transfer);
+                writePool_.push_back(std::move(request));
+            }
+            idle_.notify_all();
+            throw UsbException{result};
+        }
+        return PendingWrite{std::move(request)};
+    }
+
+    void Transport::startReceiving(std::uint8_t endpoint, std::size_t packetSize, ReceiveHandler handler)
+    {
+        stopReceiving();
+        std::unique_lock lock{mutex_};
+        receiveHandler_ = std::move(handler);
+        receiving_ = true;
+
+        for (auto& buffer : readBuffers_)
+        {
+            buffer.resize(packetSize);
+            libusb_transfer* transfer = allocTransfer();
+            libusb_fill_interrupt_transfer(transfer, handle_, endpoint, buffer.data(), static_cast<int>(buffer.size()),
+                                           &Transport::onReadCompleted, this, 0);
+            lock.unlock();
+
+            if (const int result = submit(transfer); result != LIBUSB_SUCCESS)
+            {
+                finished(transfer);
+                stopReceiving();
+                throw UsbException{result};
+            }
+            lock.lock();
+        }
+    }
+
+    void Transport::stopReceiving()
+    {
+        {
+            std::lock_guard lock{mutex_};
+            receiving_ = false;
+        }
+        cancel(true);
+    }
+
+    bool Transport::isReceiving()
+    {
+        std::lock_guard lock{mutex_};
+        return receiving_;
+    }
+
+    int Transport::submit(libusb_transfer* transfer)
+    {
+        {
+            std::lock_guard lock{mutex_};
+            inFlight_.insert(transfer);
+        }
+
+        return libusb_submit_transfer(transfer);
+    }
+
+    std::shared_ptr<Transport::WriteRequest> Transport::acquireWriteRequest()
+    {
+        std::lock_guard lock{mutex_};
+
+        if (!writePool_.empty())
+        {
+            auto request = std::move(writePool_.back());
+            writePool_.pop_back();
+            return request;
+        }
+
+        auto request = std::make_shared<WriteRequest>();
+        request->owner = this;
+        request->transfer = allocTransfer();
+        writeRequests_.push_back(request);
+        return request;
+    }
+
+    void Transport::recycle(std::shared_ptr<WriteRequest> request)
+    {
+        std::lock_guard lock{mutex_};
+        writePool_.push_back(std::move(request));
+    }
+
+    void Transport::cancel(bool readsOnly)
+    {
+        const auto selected = [readsOnly](const libusb_transfer* transfer)
+        { return !readsOnly || (transfer->callback == &Transport::onReadCompleted); };
+
+        std::unique_lock lock{mutex_};
+        std::for_each(inFlight_.cbegin(), inFlight_.cend(), [&selected](libusb_transfer* transfer)
+                      {
+                          if (selected(transfer))
+                          {
+                              libusb_cancel_transfer(transfer);
+                          } });
+        idle_.wait(lock, [this, &selected]
+                   { return std::none_of(inFlight_.cbegin(), inFlight_.cend(), selected); });
+    }
+
+    void Transport::finished(libusb_transfer* transfer)
+    {
+        {
+            std::lock_guard lock{mutex_};
+            inFlight_.erase(transfer);
+            libusb_free_transfer(transfer);
+        }
+        idle_.notify_all();
+    }
+
+    // The result is published while the transport lock is held, so the
+    // request can't be recycled and resubmitted before it left inFlight_
+    void Transport::writeCompleted(WriteRequest& request)
+    {
+        {
+            std::lock_guard lock{mutex_};
+            inFlight_.erase(request.transfer);
+
+            std::lock_guard requestLock{request.mutex};
+            request.status = toErrorCode(request.transfer->status);
+            request.transferred = (request.status == LIBUSB_SUCCESS) ? static_cast<std::size_t>(request.transfer->actual_length) : 0;
+            request.done = true;
+            request.completed.notify_all();
+        }
+        idle_.notify_all();
+    }
+
+    void Transport::readCompleted(libusb_transfer* transfer)
+    {
+        if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+        {
+            receiveHandler_({transfer->buffer, static_cast<std::size_t>(transfer->actual_length)}, nullptr);
+        }
+        else if ((transfer->status != LIBUSB_TRANSFER_CANCELLED) && (transfer->status != LIBUSB_TRANSFER_TIMED_OUT))
+        {
+            receiveHandler_({}, std::make_exception_ptr(UsbException{toErrorCode(transfer->status)}));
+        }
+
+        std::unique_lock lock{mutex_};
+
+        if (receiving_ && ((transfer->status == LIBUSB_TRANSFER_COMPLETED) || (transfer->status == LIBUSB_TRANSFER_TIMED_OUT)))
+        {
+            const int result = libusb_submit_transfer(transfer);
+
+            if (result == LIBUSB_SUCCESS)
+            {
+                return;
+            }
+            lock.unlock();
+            receiveHandler_({}, std::make_exception_ptr(UsbException{result}));
+        }
+        else
+        {
+            lock.unlock();
+        }
+        finished(transfer);
+    }
+
+    void Transport::onWriteCompleted(libusb_transfer* transfer)
+    {
+        auto* request = static_cast<WriteRequest*>(transfer->user_data);
+        request->owner->writeCompleted(*request);
+    }
+
+    void Transport::onReadCompleted(libusb_transfer* transfer)
+    {
+        static_cast<Transport*>(transfer->user_data)->readCompleted(transfer);
+    }
+
+
+    PendingWrite::PendingWrite(std::size_t transferred)
+        : transferred_(transferred)
+    {
+    }
+
+    PendingWrite::PendingWrite(std::exception_ptr error)
+        : error_(std::move(error))
+    {
+    }
+
+    PendingWrite::PendingWrite(std::shared_ptr<Transport::WriteRequest> request)
+        : request_(std::move(request))
+    {
+    }
+
+    PendingWrite::PendingWrite(PendingWrite&& other) noexcept
+        : request_(std::move(other.request_)), transferred_(other.transferred_), error_(std::move(other.error_))
+    {
+    }
+
+    PendingWrite::~PendingWrite()
+    {
+        if (request_ != nullptr)
+        {
+            takeResult();
+        }
+    }
+
+    std::size_t PendingWrite::get()
+    {
+        if (request_ != nullptr)
+        {
+            takeResult();
+        }
+
+        if (error_ != nullptr)
+        {
+            std::rethrow_exception(error_);
+        }
+        return transferred_;
+    }
+
+    PendingWrite& PendingWrite::operator=(PendingWrite&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (request_ != nullptr)
+            {
+                takeResult();
+            }
+            request_ = std::move(other.request_);
+            transferred_ = other.transferred_;
+            error_ = std::move(other.error_);
+        }
+        return *this;
+    }
+
+    void PendingWrite::takeResult()
+    {
+        auto request = std::move(request_);
+        Transport* owner{nullptr};
+        int status{LIBUSB_SUCCESS};
+        {
+            std::unique_lock lock{request->mutex};
+            request->completed.wait(lock, [&request]
+                                    { return request->done; });
+            status = request->status;
+            transferred_ = request->transferred;
+            owner = request->owner;
+        }
+
+        if (owner != nullptr)
+        {
+            owner->recycle(std::move(request));
+        }
+
+        if (status != LIBUSB_SUCCESS)
+        {
+            error_ = std::make_exception_ptr(UsbException{status});
+        }
+    }
+}
@@ -50,7 +50,8 @@ namespace plug
           sag(1),
           usb_gain(0),
           changed(false),
-          brightness(false)
+          brightness(false),
+          loading(false)
     {
         ui->setupUi(this);
 
@@ -83,30 +84,35 @@ namespace plug
     {
         gain = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_volume(int value)
     {
         volume = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_treble(int value)
     {
         treble = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_middle(int value)
     {
         middle = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_bass(int value)
     {
         bass = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_cabinet(int value)
@@ -119,60 +125,70 @@ namespace plug
     {
         noise_gate = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_presence(int value)
     {
         presence = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_gain2(int value)
     {
         gain2 = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_master_vol(int value)
     {
         master_vol = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_threshold(int value)
     {
         threshold = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_depth(int value)
     {
         depth = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_bias(int value)
     {
         bias = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_sag(int value)
     {
         sag = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_brightness(bool value)
     {
         brightness = value;
         changed = true;
+        send_live();
     }
 
     void Amplifier::set_usb_gain(int value)
     {
         usb_gain = static_cast<std::uint8_t>(value);
         changed = true;
+        send_live();
     }
 
     void Amplifier::choose_amp(int ampValue)
@@ -307,6 +323,7 @@ namespace plug
     void Amplifier::load(amp_settings settings)
     {
         changed = true;
+        loading = true;
 
         ui->comboBox->setCurrentIndex(value(settings.amp_num));
         ui->dial->setValue(settings.gain);
@@ -327,6 +344,7 @@ namespace plug
         advanced->set_sag(settings.sag);
         advanced->set_brightness(settings.brightness);
         advanced->set_usb_gain(settings.usb_gain);
+        loading = false;
     }
 
     void Amplifier::get_settings(amp_settings* settings)
@@ -350,6 +368,22 @@ namespace plug
         settings->usb_gain = usb_gain;
     }
 
+    // dial movements are streamed to the amp in live mode
+    void Amplifier::send_live()
+    {
+        QSettings settings;
+
+        if (!loading && settings.value("Settings/liveKnobs").toBool())
+        {
+            send_amp();
+        }
+    }
+
+    void Amplifier::set_changed(bool value)
+    {
+        changed = value;
+    }
+
     void Amplifier::enable_set_button(bool value)
     {
         ui->setButton->setEnabled(value);
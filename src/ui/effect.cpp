@@ -92,7 +92,9 @@ namespace plug
           knob5(0),
           knob6(0),
           enabled(true),
-          changed(false)
+          changed(false),
+          loading(false),
+          presetEffects()
     {
         ui->setupUi(this);
         effect_num = static_cast<effects>(ui->comboBox->currentIndex());
@@ -128,6 +130,7 @@ namespace plug
         connect(ui->dial_6, SIGNAL(valueChanged(int)), this, SLOT(set_knob6(int)));
         connect(ui->setButton, SIGNAL(clicked()), this, SLOT(send_fx()));
         connect(ui->pushButton, SIGNAL(toggled(bool)), this, SLOT(off_switch(bool)));
+        connect(ui->presetBox, SIGNAL(activated(int)), this, SLOT(recall_preset(int)));
 
         QShortcut* close = new QShortcut(QKeySequence(Qt::Key_Escape), this);
         connect(close, SIGNAL(activated()), this, SLOT(close()));
@@ -150,36 +153,42 @@ namespace plug
     {
         knob1 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::set_knob2(int value)
     {
         knob2 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::set_knob3(int value)
     {
         knob3 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::set_knob4(int value)
     {
         knob4 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::set_knob5(int value)
     {
         knob5 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::set_knob6(int value)
     {
         knob6 = static_cast<std::uint8_t>(value);
         set_changed(true);
+        send_live();
     }
 
     void Effect::choose_fx(int value)
@@ -1668,6 +1677,7 @@ namespace plug
     void Effect::load(fx_pedal_settings settings)
     {
         set_changed(true);
+        loading = true;
 
         ui->comboBox->setCurrentIndex(value(settings.effect_num));
         ui->dial->setValue(settings.knob1);
@@ -1676,6 +1686,7 @@ namespace plug
         ui->dial_4->setValue(settings.knob4);
         ui->dial_5->setValue(settings.knob5);
         ui->dial_6->setValue(settings.knob6);
+        loading = false;
     }
 
     void Effect::off_switch(bool value)
@@ -1751,6 +1762,17 @@ namespace plug
         send_fx();
     }
 
+    // dial movements are streamed to the amp in live mode
+    void Effect::send_live()
+    {
+        QSettings settings;
+
+        if (!loading && settings.value("Settings/liveKnobs").toBool())
+        {
+            send_fx();
+        }
+    }
+
     void Effect::set_changed(bool value)
     {
         changed = value;
@@ -1792,6 +1814,45 @@ namespace plug
         this->send_fx();
     }
 
+    // each effect of the knob presets can be recalled on its own
+    void Effect::load_presets(const std::vector<EffectPreset>& presets)
+    {
+        presetEffects.clear();
+
+        while (ui->presetBox->count() > 1)
+        {
+            ui->presetBox->removeItem(1);
+        }
+
+        for (const auto& preset : presets)
+        {
+            const QString knobName = (preset.knob == EffectKnob::mod ? tr("Mod") : tr("Dly/Rev"));
+            const QString slotName = QString("%1%2").arg(QChar('A' + preset.slot / 3)).arg(preset.slot % 3 + 1);
+
+            for (const auto& effect : preset.effects)
+            {
+                if (effect.effect_num != effects::EMPTY)
+                {
+                    presetEffects.push_back(effect);
+                    ui->presetBox->addItem(QString("%1 %2: %3 (%4)").arg(knobName, slotName, QString::fromStdString(preset.name), ui->comboBox->itemText(value(effect.effect_num))));
+                }
+            }
+        }
+        ui->presetBox->setEnabled(!presetEffects.empty());
+    }
+
+    void Effect::recall_preset(int index)
+    {
+        if (index < 1)
+        {
+            return;
+        }
+
+        load(presetEffects[static_cast<std::size_t>(index - 1)]);
+        ui->presetBox->setCurrentIndex(0);
+        send_fx();
+    }
+
     void Effect::showAndActivate()
     {
         show();
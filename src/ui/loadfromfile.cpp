@@ -20,6 +20,7 @@
  */
 
 #include "ui/loadfromfile.h"
+#include "com/IdLookup.h"
 #include "effects_enum.h"
 
 namespace plug
@@ -69,55 +70,11 @@ namespace plug
             {
                 if (xml.name().toString() == "Module")
                 {
-                    switch (xml.attributes().value("ID").toString().toInt())
-                    {
-                        case 0x67:
-                            amp.amp_num = amps::FENDER_57_DELUXE;
-                            break;
-
-                        case 0x64:
-                            amp.amp_num = amps::FENDER_59_BASSMAN;
-                            break;
+                    const auto id = xml.attributes().value("ID").toString().toUInt();
 
-                        case 0x7c:
-                            amp.amp_num = amps::FENDER_57_CHAMP;
-                            break;
-
-                        case 0x53:
-                            amp.amp_num = amps::FENDER_65_DELUXE_REVERB;
-                            break;
-
-                        case 0x6a:
-                            amp.amp_num = amps::FENDER_65_PRINCETON;
-                            break;
-
-                        case 0x75:
-                            amp.amp_num = amps::FENDER_65_TWIN_REVERB;
-                            break;
-
-                        case 0x72:
-                            amp.amp_num = amps::FENDER_SUPER_SONIC;
-                            break;
-
-                        case 0x61:
-                            amp.amp_num = amps::BRITISH_60S;
-                            break;
-
-                        case 0x79:
-                            amp.amp_num = amps::BRITISH_70S;
-                            break;
-
-                        case 0x5e:
-                            amp.amp_num = amps::BRITISH_80S;
-                            break;
-
-                        case 0x5d:
-                            amp.amp_num = amps::AMERICAN_90S;
-                            break;
-
-                        case 0x6d:
-                            amp.amp_num = amps::METAL_2000;
-                            break;
+                    if (const auto model = (id <= 0xff) ? findAmpById(static_cast<std::uint8_t>(id)) : std::nullopt; model)
+                    {
+                        amp.amp_num = *model;
                     }
                 }
                 else if (xml.name().toString() == "Param")
@@ -208,159 +165,11 @@ namespace plug
                     const int position = xml.attributes().value("POS").toString().toInt();
                     effect.slot = FxSlot{static_cast<std::uint8_t>(position)};
 
-                    switch (xml.attributes().value("ID").toString().toInt())
-                    {
-                        case 0x00:
-                            effect.effect_num = effects::EMPTY;
-                            break;
-
-                        case 0x3c:
-                            effect.effect_num = effects::OVERDRIVE;
-                            break;
-
-                        case 0x49:
-                            effect.effect_num = effects::WAH;
-                            break;
-
-                        case 0x4a:
-                            effect.effect_num = effects::TOUCH_WAH;
-                            break;
-
-                        case 0x1a:
-                            effect.effect_num = effects::FUZZ;
-                            break;
-
-                        case 0x1c:
-                            effect.effect_num = effects::FUZZ_TOUCH_WAH;
-                            break;
-
-                        case 0x88:
-                            effect.effect_num = effects::SIMPLE_COMP;
-                            break;
-
-                        case 0x07:
-                            effect.effect_num = effects::COMPRESSOR;
-                            break;
-
-                        case 0x12:
-                            effect.effect_num = effects::SINE_CHORUS;
-                            break;
-
-                        case 0x13:
-                            effect.effect_num = effects::TRIANGLE_CHORUS;
-                            break;
-
-                        case 0x18:
-                            effect.effect_num = effects::SINE_FLANGER;
-                            break;
-
-                        case 0x19:
-                            effect.effect_num = effects::TRIANGLE_FLANGER;
-                            break;
-
-                        case 0x2d:
-                            effect.effect_num = effects::VIBRATONE;
-                            break;
-
-                        case 0x40:
-                            effect.effect_num = effects::VINTAGE_TREMOLO;
-                            break;
-
-                        case 0x41:
-                            effect.effect_num = effects::SINE_TREMOLO;
-                            break;
-
-                        case 0x22:
-                            effect.effect_num = effects::RING_MODULATOR;
-                            break;
-
-                        case 0x29:
-                            effect.effect_num = effects::STEP_FILTER;
-                            break;
-
-                        case 0x4f:
-                            effect.effect_num = effects::PHASER;
-                            break;
-
-                        case 0x1f:
-                            effect.effect_num = effects::PITCH_SHIFTER;
-                            break;
-
-                        case 0x16:
-                            effect.effect_num = effects::MONO_DELAY;
-                            break;
-
-                        case 0x43:
-                            effect.effect_num = effects::MONO_ECHO_FILTER;
-                            break;
-
-                        case 0x48:
-                            effect.effect_num = effects::STEREO_ECHO_FILTER;
-                            break;
-
-                        case 0x44:
-                            effect.effect_num = effects::MULTITAP_DELAY;
-                            break;
-
-                        case 0x45:
-                            effect.effect_num = effects::PING_PONG_DELAY;
-                            break;
-
-                        case 0x15:
-                            effect.effect_num = effects::DUCKING_DELAY;
-                            break;
-
-                        case 0x46:
-                            effect.effect_num = effects::REVERSE_DELAY;
-                            break;
-
-                        case 0x2b:
-                            effect.effect_num = effects::TAPE_DELAY;
-                            break;
-
-                        case 0x2a:
-                            effect.effect_num = effects::STEREO_TAPE_DELAY;
-                            break;
-
-                        case 0x24:
-                            effect.effect_num = effects::SMALL_HALL_REVERB;
-                            break;
-
-                        case 0x3a:
-                            effect.effect_num = effects::LARGE_HALL_REVERB;
-                            break;
-
-                        case 0x26:
-                            effect.effect_num = effects::SMALL_ROOM_REVERB;
-                            break;
-
-                        case 0x3b:
-                            effect.effect_num = effects::LARGE_ROOM_REVERB;
-                            break;
+                    const auto id = xml.attributes().value("ID").toString().toUInt();
 
-                        case 0x4e:
-                            effect.effect_num = effects::SMALL_PLATE_REVERB;
-                            break;
-
-                        case 0x4b:
-                            effect.effect_num = effects::LARGE_PLATE_REVERB;
-                            break;
-
-                        case 0x4c:
-                            effect.effect_num = effects::AMBIENT_REVERB;
-                            break;
-
-                        case 0x4d:
-                            effect.effect_num = effects::ARENA_REVERB;
-                            break;
-
-                        case 0x21:
-                            effect.effect_num = effects::FENDER_63_SPRING_REVERB;
-                            break;
-
-                        case 0x0b:
-                            effect.effect_num = effects::FENDER_65_SPRING_REVERB;
-                            break;
+                    if (const auto model = (id <= 0xff) ? findEffectById(static_cast<std::uint8_t>(id)) : std::nullopt; model)
+                    {
+                        effect.effect_num = *model;
                     }
                 }
                 else if (xml.name().toString() == "Param")
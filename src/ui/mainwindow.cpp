@@ -32,22 +32,40 @@
 #include "ui/savetofile.h"
 #include "ui/settings.h"
 #include "com/Mustang.h"
+#include "com/MustangWorker.h"
+#include "com/PresetCache.h"
+#include "com/StateCache.h"
+#include "com/EffectPresetTable.h"
 #include "com/ConnectionFactory.h"
 #include "com/CommunicationException.h"
 #include "com/MustangUpdater.h"
 #include "ui_defaulteffects.h"
 #include "ui_mainwindow.h"
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QDebug>
 
 namespace plug
 {
     namespace
     {
+        // time for the system to set up a device that was plugged in
+        constexpr std::chrono::milliseconds reconnectDelay{500};
+
+        std::filesystem::path stateCacheDirectory()
+        {
+            return std::filesystem::path{QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString()};
+        }
+
         constexpr int check_fx_family(effects value)
         {
             if (value == effects::EMPTY)
@@ -73,14 +91,39 @@ namespace plug
             return 0;
         }
 
+        QString errorMessage(std::exception_ptr error)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& ex)
+            {
+                return QString::fromStdString(ex.what());
+            }
+            catch (...)
+            {
+                return QObject::tr("Unknown error");
+            }
+        }
+
     }
 
 
-    MainWindow::MainWindow(QWidget* parent)
+    MainWindow::MainWindow(libusb_context* context, QWidget* parent)
         : QMainWindow(parent),
           ui(std::make_unique<Ui::MainWindow>()),
-          presetNames(100, ""),
-          amp_ops(nullptr),
+          usbContext(context),
+          presetNames(),
+          deviceKey(),
+          presetCache(std::make_unique<com::PresetCache>()),
+          effectPresetTable(std::make_unique<com::EffectPresetTable>()),
+          worker(std::make_unique<com::MustangWorker>([this](std::exception_ptr error)
+                                                      { emit deviceError(errorMessage(error)); },
+                                                      [this](auto latency)
+                                                      { emit updateSent(std::chrono::duration<double, std::milli>(latency).count()); })),
+          deviceMonitor(),
+          updater(),
           effectComponents{{new Effect{this, FxSlot{0}},
                             new Effect{this, FxSlot{1}},
                             new Effect{this, FxSlot{2}},
@@ -118,6 +161,14 @@ namespace plug
         {
             settings.setValue("Settings/defaultEffectValues", true);
         }
+        if (!settings.contains("Settings/liveKnobs"))
+        {
+            settings.setValue("Settings/liveKnobs", false);
+        }
+        if (!settings.contains("Settings/pipelineCommands"))
+        {
+            settings.setValue("Settings/pipelineCommands", false);
+        }
 
         // create child objects
         amp = new Amplifier(this);
@@ -128,8 +179,25 @@ namespace plug
         saver = new SaveToFile(this);
         quickpres = new QuickPresets(this);
 
+        connectProgress = new QProgressBar(this);
+        connectProgress->setMaximumWidth(160);
+        connectProgress->setTextVisible(false);
+        connectProgress->hide();
+        ui->statusBar->addPermanentWidget(connectProgress);
+
+        firmwareProgress = new QProgressDialog(tr("Updating firmware..."), tr("Cancel"), 0, 1, this);
+        firmwareProgress->setWindowTitle(tr("Firmware update"));
+        firmwareProgress->setWindowModality(Qt::WindowModal);
+        firmwareProgress->setAutoReset(false);
+        firmwareProgress->setAutoClose(false);
+        firmwareProgress->reset();
+
         connected = false;
 
+        // device errors are reported from the worker thread
+        connect(this, &MainWindow::deviceError, this, &MainWindow::show_error, Qt::QueuedConnection);
+        connect(this, &MainWindow::updateSent, this, &MainWindow::show_latency, Qt::QueuedConnection);
+
         // connect buttons to slots
         connect(ui->Amplifier, SIGNAL(clicked()), amp, SLOT(showAndActivate()));
         connect(ui->EffectButton1, SIGNAL(clicked()), effectComponents[0], SLOT(showAndActivate()));
@@ -226,14 +294,36 @@ namespace plug
             connect(this, SIGNAL(started()), this, SLOT(start_amp()));
         }
 
+        // follow the amplifier being plugged in or removed
+        reconnect = settings.value("Settings/connectOnStartup").toBool();
+
+        try
+        {
+            deviceMonitor = com::monitorDevices(usbContext, [this](com::usb::HotplugEvent event, std::uint16_t)
+                                                { QMetaObject::invokeMethod(this, [this, event]
+                                                                            { device_changed(event); }, Qt::QueuedConnection); });
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "Device monitoring not available: " << ex.what();
+        }
+
         this->show();
-        this->repaint();
 
         emit started();
     }
 
     MainWindow::~MainWindow()
     {
+        updater.reset();
+        deviceMonitor.reset();
+        worker.reset();
+
+        if (connected)
+        {
+            store_state();
+        }
+
         QSettings settings;
         settings.setValue("Windows/mainWindowGeometry", saveGeometry());
         settings.setValue("Windows/mainWindowState", saveState());
@@ -261,33 +351,129 @@ namespace plug
 
     void MainWindow::start_amp()
     {
+        ui->statusBar->showMessage(tr("Connecting..."));
+        ui->actionConnect->setDisabled(true);
+        reconnect = true;
+
+        presetNames.clear();
+        load->delete_items();
+        save->delete_items();
+        quickpres->delete_items();
+
+        connectProgress->setRange(0, 0);
+        connectProgress->show();
+
         QSettings settings;
-        amp_settings amplifier_set{};
-        std::vector<fx_pedal_settings> effects_set{};
-        QString name;
+        const bool pipelining = settings.value("Settings/pipelineCommands").toBool();
+
+        // the cached state is shown first, the preset lists are verified
+        // while the initial data is received
+        worker->connect([this]
+                        { return plug::com::connect(usbContext); },
+                        [this, directory = stateCacheDirectory(), pipelining](com::Mustang& mustang)
+                        {
+            mustang.setPipelining(pipelining);
+            const auto model = mustang.getDeviceModel();
+            const auto key = com::stateCacheKey(model, mustang.getDeviceName(), mustang.getDeviceIdentity());
+            const auto cached = com::loadStateCache(directory, key);
+            QMetaObject::invokeMethod(this, [this, presets = model.numberOfPresets(), key, cached]
+                                      { connect_started(presets, key, cached); }, Qt::QueuedConnection);
+
+            const auto initialData = mustang.start_amp([this](std::size_t slot, const std::string& name)
+                                                       { QMetaObject::invokeMethod(this, [this, slot, name]
+                                                                                   { preset_name_received(slot, name); }, Qt::QueuedConnection); });
+            QMetaObject::invokeMethod(this, [this, initialData, model]
+                                      { amp_started(initialData, model); }, Qt::QueuedConnection); });
+    }
 
-        ui->statusBar->showMessage(tr("Connecting..."));
-        this->repaint(); // this should not be needed!
+    void MainWindow::connect_started(std::size_t numberOfPresets, const std::string& key, const std::optional<com::CachedState>& cached)
+    {
+        deviceKey = key;
+        connectProgress->setRange(0, static_cast<int>(numberOfPresets));
+        connectProgress->setValue(0);
 
-        try
+        if (cached)
         {
-            amp_ops = plug::com::connect();
-            const auto [signalChain, presets] = amp_ops->start_amp();
-            name = QString::fromStdString(signalChain.name());
-            amplifier_set = signalChain.amp();
-            effects_set = signalChain.effects();
-            presetNames = presets;
-        }
-        catch (const std::exception& ex)
-        {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-            return;
+            show_cached_state(*cached);
         }
+    }
 
+    void MainWindow::show_cached_state(const com::CachedState& state)
+    {
+        presetNames = state.presetNames;
         load->load_names(presetNames);
         save->load_names(presetNames);
-        quickpres->load_names(presetNames);
+        std::for_each(presetNames.cbegin(), presetNames.cend(), [this, slot = std::size_t{0}](const auto& name) mutable
+                      { quickpres->add_name(slot++, name); });
+
+        presetCache->reset(state.banks.size());
+        for (std::size_t slot = 0; slot < state.banks.size(); ++slot)
+        {
+            if (state.banks[slot])
+            {
+                presetCache->put(static_cast<std::uint8_t>(slot), *state.banks[slot]);
+            }
+        }
+
+        effectPresetTable->clear();
+        std::for_each(state.effectPresets.cbegin(), state.effectPresets.cend(), [this](const auto& preset)
+                      { effectPresetTable->put(preset); });
+        effect_presets_changed();
+
+        bank_loaded(state.signalChain);
+    }
+
+    // Cached names are replaced as soon as the amp reports a different one
+    void MainWindow::preset_name_received(std::size_t slot, const std::string& name)
+    {
+        if (slot < presetNames.size())
+        {
+            if (presetNames[slot] != name)
+            {
+                QString label = QString("[%1] %2").arg(slot + 1).arg(QString::fromStdString(name));
+
+                presetNames[slot] = name;
+                change_name(static_cast<int>(slot), &label);
+                presetCache->invalidate(static_cast<std::uint8_t>(slot));
+            }
+        }
+        else if (slot == presetNames.size())
+        {
+            presetNames.push_back(name);
+            load->add_name(slot, name);
+            save->add_name(slot, name);
+            quickpres->add_name(slot, name);
+        }
+        connectProgress->setValue(static_cast<int>(slot + 1));
+    }
+
+    void MainWindow::amp_started(const com::InitialData& initialData, const DeviceModel& model)
+    {
+        QSettings settings;
+        const QString name = QString::fromStdString(initialData.signalChain.name());
+        const auto amplifier_set = initialData.signalChain.amp();
+        const auto effects_set = initialData.signalChain.effects();
+        if (presetNames.size() != initialData.presetNames.size())
+        {
+            // the cache held a different number of presets
+            load->delete_items();
+            save->delete_items();
+            quickpres->delete_items();
+            load->load_names(initialData.presetNames);
+            save->load_names(initialData.presetNames);
+            quickpres->load_names(initialData.presetNames);
+        }
+        else
+        {
+            quickpres->select_defaults();
+        }
+        presetNames = initialData.presetNames;
+        connectProgress->hide();
+
+        effectPresetTable->clear();
+        std::for_each(initialData.effectPresets.cbegin(), initialData.effectPresets.cend(), [this](const auto& preset)
+                      { effectPresetTable->put(preset); });
+        effect_presets_changed();
 
         if (name.isEmpty() == true)
         {
@@ -296,7 +482,6 @@ namespace plug
         }
         else
         {
-            const auto model = amp_ops->getDeviceModel();
             setWindowTitle(QString(tr("PLUG - %1 %2: %3"))
                                .arg(QString::fromStdString(model.name()))
                                .arg(model.category() == DeviceModel::Category::MustangV2 ? "(v2)" : "")
@@ -334,39 +519,75 @@ namespace plug
         ui->statusBar->showMessage(tr("Connected"), 3000);
 
         connected = true;
+
+        // only explicit loads and saves fill the preset cache; banks taken
+        // from the state cache are verified once they're loaded
+        const auto numberOfSlots = (model.numberOfPresets() > 0 ? model.numberOfPresets() : presetNames.size());
+
+        if (presetCache->size() != numberOfSlots)
+        {
+            presetCache->reset(numberOfSlots);
+        }
+
+        store_state();
     }
 
     void MainWindow::stop_amp()
     {
+        if (connected)
+        {
+            store_state();
+        }
+
         save->delete_items();
         load->delete_items();
         quickpres->delete_items();
+        presetNames.clear();
+        deviceKey.clear();
 
-        try
-        {
-            amp_ops->stop_amp();
+        worker->disconnect();
+        presetCache->reset(0);
+        effectPresetTable->clear();
+        effect_presets_changed();
 
-            // deactivate buttons
-            amp->enable_set_button(false);
-            std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& effect)
-                          { effect->enable_set_button(false); });
-            ui->actionConnect->setDisabled(false);
-            ui->actionDisconnect->setDisabled(true);
-            ui->actionSave_to_amplifier->setDisabled(true);
-            ui->action_Load_from_amplifier->setDisabled(true);
-            ui->actionSave_effects->setDisabled(true);
-            ui->action_Library_view->setDisabled(true);
-            setWindowTitle(QString(tr("PLUG")));
-            setAccessibleName(QString(tr("Main window: None")));
-            ui->statusBar->showMessage(tr("Disconnected"), 5000);
+        // deactivate buttons
+        amp->enable_set_button(false);
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& effect)
+                      { effect->enable_set_button(false); });
+        ui->actionConnect->setDisabled(false);
+        ui->actionDisconnect->setDisabled(true);
+        ui->actionSave_to_amplifier->setDisabled(true);
+        ui->action_Load_from_amplifier->setDisabled(true);
+        ui->actionSave_effects->setDisabled(true);
+        setWindowTitle(QString(tr("PLUG")));
+        setAccessibleName(QString(tr("Main window: None")));
+        ui->statusBar->showMessage(tr("Disconnected"), 5000);
 
-            connected = false;
+        connected = false;
+        reconnect = false;
+    }
+
+    // Unplugging is shown right away instead of by the next failing
+    // transfer; the amp is connected again once it is back
+    void MainWindow::device_changed(com::usb::HotplugEvent event)
+    {
+        if (event == com::usb::HotplugEvent::left)
+        {
+            if (connected)
+            {
+                stop_amp();
+                reconnect = true;
+                ui->statusBar->showMessage(tr("Amplifier unplugged"), 5000);
+            }
         }
-        catch (const std::exception& ex)
+        else if (reconnect && !connected && ui->actionConnect->isEnabled())
         {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-            return;
+            QTimer::singleShot(reconnectDelay, this, [this]
+                               {
+                if (!connected && ui->actionConnect->isEnabled())
+                {
+                    start_amp();
+                } });
         }
     }
 
@@ -380,18 +601,9 @@ namespace plug
 
         QSettings settings;
 
-        if (!settings.value("Settings/oneSetToSetThemAll").toBool())
+        if (!settings.value("Settings/oneSetToSetThemAll").toBool() || settings.value("Settings/liveKnobs").toBool())
         {
-            try
-            {
-                amp_ops->set_effect(pedal);
-            }
-            catch (const std::exception& ex)
-            {
-                qWarning() << "ERROR: " << ex.what();
-                ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-                return;
-            }
+            worker->update(pedal);
         }
         amp->send_amp();
     }
@@ -404,27 +616,15 @@ namespace plug
         }
 
         QSettings settings;
+        std::vector<Effect*> changedComponents;
 
-        try
-        {
-            if (settings.value("Settings/oneSetToSetThemAll").toBool())
-            {
-                std::for_each(effectComponents.begin(), effectComponents.end(), [this](const auto& comp)
-                              {
-                    if (comp->get_changed())
-                    {
-                        amp_ops->set_effect(comp->getSettings());
-                    } });
-            }
-
-            amp_ops->set_amplifier(amp_settings);
-        }
-        catch (const std::exception& ex)
+        if (settings.value("Settings/oneSetToSetThemAll").toBool())
         {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-            return;
+            std::copy_if(effectComponents.cbegin(), effectComponents.cend(), std::back_inserter(changedComponents), [](const auto& comp)
+                         { return comp->get_changed(); });
         }
+
+        send_settings(amp_settings, changedComponents);
     }
 
     void MainWindow::save_on_amp(char* name, int slot)
@@ -434,16 +634,12 @@ namespace plug
             return;
         }
 
-        try
-        {
-            amp_ops->save_on_amp(name, static_cast<std::uint8_t>(slot));
-        }
-        catch (const std::exception& ex)
-        {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-            return;
-        }
+        worker->post([this, cache = presetCache.get(), presetName = std::string{name}, slot](com::Mustang& mustang)
+                     {
+            const auto signalChain = mustang.save_on_amp(presetName, static_cast<std::uint8_t>(slot));
+            cache->put(static_cast<std::uint8_t>(slot), signalChain);
+            QMetaObject::invokeMethod(this, [this, slot, signalChain]
+                                      { bank_saved(slot, signalChain); }, Qt::QueuedConnection); });
 
         if (name[0] == 0x00)
         {
@@ -457,7 +653,20 @@ namespace plug
         }
 
         current_name = name;
-        presetNames[static_cast<std::size_t>(slot)] = current_name.toStdString();
+    }
+
+    // the name lists follow what the amp has actually stored
+    void MainWindow::bank_saved(int slot, const SignalChain& signalChain)
+    {
+        if (static_cast<std::size_t>(slot) >= presetNames.size())
+        {
+            return;
+        }
+
+        QString label = QString("[%1] %2").arg(slot + 1).arg(QString::fromStdString(signalChain.name()));
+
+        presetNames[static_cast<std::size_t>(slot)] = signalChain.name();
+        change_name(slot, &label);
     }
 
     void MainWindow::load_from_amp(int slot)
@@ -467,50 +676,62 @@ namespace plug
             return;
         }
 
-        QSettings settings;
-        try
+        // a cached preset is shown right away, the amp follows
+        const auto cached = presetCache->get(static_cast<std::uint8_t>(slot));
+
+        if (cached)
         {
-            const auto signalChain = amp_ops->load_memory_bank(static_cast<std::uint8_t>(slot));
-            const QString bankName = QString::fromStdString(signalChain.name());
+            bank_loaded(*cached);
+        }
 
+        // a stale cache entry is replaced by what the amp actually holds
+        worker->post([this, cache = presetCache.get(), slot, cached](com::Mustang& mustang)
+                     {
+            const auto signalChain = mustang.load_memory_bank(static_cast<std::uint8_t>(slot));
+            cache->put(static_cast<std::uint8_t>(slot), signalChain);
 
-            if (bankName.isEmpty())
+            if (!cached || !com::isSameBank(*cached, signalChain))
             {
-                setWindowTitle(QString(tr("PLUG: NONE")));
-                setAccessibleName(QString(tr("Main window: NONE")));
-            }
-            else
-            {
-                setWindowTitle(QString(tr("PLUG: %1")).arg(bankName));
-                setAccessibleName(QString(tr("Main window: %1")).arg(bankName));
-            }
+                QMetaObject::invokeMethod(this, [this, signalChain]
+                                          { bank_loaded(signalChain); }, Qt::QueuedConnection);
+            } });
+    }
 
-            current_name = bankName;
+    void MainWindow::bank_loaded(const SignalChain& signalChain)
+    {
+        QSettings settings;
+        const QString bankName = QString::fromStdString(signalChain.name());
 
-            amp->load(signalChain.amp());
-            if (settings.value("Settings/popupChangedWindows").toBool())
-            {
-                amp->show();
-            }
+        if (bankName.isEmpty())
+        {
+            setWindowTitle(QString(tr("PLUG: NONE")));
+            setAccessibleName(QString(tr("Main window: NONE")));
+        }
+        else
+        {
+            setWindowTitle(QString(tr("PLUG: %1")).arg(bankName));
+            setAccessibleName(QString(tr("Main window: %1")).arg(bankName));
+        }
 
-            const auto effects_set = signalChain.effects();
-            const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
-            std::for_each(effects_set.cbegin(), effects_set.cend(), [this, shouldPopup](const auto& effect)
-                          {
-                const auto component = effectComponents.at(effect.slot.id());
+        current_name = bankName;
 
-                component->load(effect);
-                if ((effect.effect_num != effects::EMPTY) && shouldPopup)
-                {
-                    component->show();
-                } });
-        }
-        catch (const std::exception& ex)
+        amp->load(signalChain.amp());
+        if (settings.value("Settings/popupChangedWindows").toBool())
         {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-            return;
+            amp->show();
         }
+
+        const auto effects_set = signalChain.effects();
+        const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
+        std::for_each(effects_set.cbegin(), effects_set.cend(), [this, shouldPopup](const auto& effect)
+                      {
+            const auto component = effectComponents.at(effect.slot.id());
+
+            component->load(effect);
+            if ((effect.effect_num != effects::EMPTY) && shouldPopup)
+            {
+                component->show();
+            } });
     }
 
     // activate buttons
@@ -529,6 +750,7 @@ namespace plug
 
     void MainWindow::change_name(int slot, QString* name)
     {
+        save->change_name(slot, name);
         load->change_name(slot, name);
         quickpres->change_name(slot, name);
     }
@@ -540,6 +762,11 @@ namespace plug
 
     void MainWindow::save_effects(int slot, char* name, int fx_num, bool mod, bool dly, bool rev)
     {
+        if (fx_num == 0)
+        {
+            return;
+        }
+
         std::vector<fx_pedal_settings> effects(static_cast<std::size_t>(fx_num), {FxSlot{0}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
 
         if (fx_num == 1)
@@ -572,16 +799,49 @@ namespace plug
             set_effect(effects[1]);
         }
 
-        try
-        {
-            amp_ops->save_effects(static_cast<std::uint8_t>(slot), name, effects);
-        }
-        catch (const std::exception& ex)
+        constexpr std::size_t effectNameLength{24};
+        EffectPreset preset{mod ? EffectKnob::mod : EffectKnob::dlyRev, static_cast<std::uint8_t>(slot), std::string{name}.substr(0, effectNameLength), effects};
+
+        worker->post([this, preset](com::Mustang& mustang)
+                     {
+            mustang.save_effects(preset.slot, preset.name, preset.effects);
+            QMetaObject::invokeMethod(this, [this, preset]
+                                      { effect_saved(preset); }, Qt::QueuedConnection); });
+    }
+
+    // The preset lists follow what the amp has actually stored
+    void MainWindow::effect_saved(const EffectPreset& preset)
+    {
+        effectPresetTable->put(preset);
+        effect_presets_changed();
+    }
+
+    // Mod presets go to the second effect, delay and reverb to the third
+    // and fourth, the same slots save_effects takes them from
+    void MainWindow::recall_effect_preset(EffectKnob knob, std::uint8_t slot)
+    {
+        const auto preset = effectPresetTable->get(knob, slot);
+
+        if (!preset)
         {
-            qWarning() << "ERROR: " << ex.what();
-            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
             return;
         }
+
+        std::for_each(preset->effects.cbegin(), preset->effects.cend(), [this](const auto& effect)
+                      {
+            if (const auto family = check_fx_family(effect.effect_num); family >= 2)
+            {
+                Effect* component = effectComponents[static_cast<std::size_t>(family - 1)];
+                component->load(effect);
+                component->send_fx();
+            } });
+    }
+
+    void MainWindow::effect_presets_changed()
+    {
+        seffects->load_presets(effectPresetTable->presets());
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [this](const auto& component)
+                      { component->load_presets(effectPresetTable->presets()); });
     }
 
     void MainWindow::loadfile(QString filename)
@@ -622,10 +882,6 @@ namespace plug
         change_title(fileSettings.name);
 
         amp->load(fileSettings.amp);
-        if (connected)
-        {
-            amp->send_amp();
-        }
 
         const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
 
@@ -634,20 +890,35 @@ namespace plug
             amp->show();
         }
 
-        std::for_each(fileSettings.effects.cbegin(), fileSettings.effects.cend(), [this, shouldPopup](auto& effect)
+        std::vector<Effect*> loadedComponents;
+
+        std::for_each(fileSettings.effects.cbegin(), fileSettings.effects.cend(), [this, shouldPopup, &loadedComponents](auto& effect)
                       {
             const auto& component = effectComponents.at(effect.slot.id());
             component->load(effect);
-
-            if (connected)
-            {
-                component->send_fx();
-            }
+            loadedComponents.push_back(component);
 
             if ((effect.effect_num != effects::EMPTY) && shouldPopup)
             {
                 component->show();
             } });
+
+        // Only the DSPs that differ from the current state are written
+        if (connected)
+        {
+            amp_settings amplifier_settings{};
+            amp->get_settings(&amplifier_settings);
+            std::vector<fx_pedal_settings> effectSettings;
+            std::transform(loadedComponents.cbegin(), loadedComponents.cend(), std::back_inserter(effectSettings), [](const auto& comp)
+                           { return comp->getSettings(); });
+
+            worker->post([signalChain = SignalChain{fileSettings.name.toStdString(), amplifier_settings, effectSettings}](com::Mustang& mustang)
+                         { mustang.applySignalChain(signalChain); });
+
+            amp->set_changed(false);
+            std::for_each(loadedComponents.cbegin(), loadedComponents.cend(), [](const auto& comp)
+                          { comp->set_changed(false); });
+        }
     }
 
     void MainWindow::get_settings(amp_settings* amplifier_settings, std::vector<fx_pedal_settings>& fx_settings)
@@ -721,7 +992,7 @@ namespace plug
     void MainWindow::update_firmware()
     {
         QString filename;
-        QMessageBox::information(this, "Prepare", R"(Please power off the amplifier, then power it back on while holding down:<ul><li>The "Save" button (Mustang I and II)</li><li>The Data Wheel (Mustang III, IV and IV)</li></ul>After pressing "OK" choose firmware file and then update will begin.It will take about one minute. You will be notified when it's finished.)");
+        QMessageBox::information(this, "Prepare", R"(Please power off the amplifier, then power it back on while holding down:<ul><li>The "Save" button (Mustang I and II)</li><li>The Data Wheel (Mustang III, IV and IV)</li></ul>After pressing "OK" choose firmware file and then update will begin. You will be notified when it's finished.)");
 
         filename = QFileDialog::getOpenFileName(this, tr("Open..."), QDir::homePath(), tr("Mustang firmware (*.upd)"));
         if (filename.isEmpty())
@@ -734,22 +1005,71 @@ namespace plug
             this->stop_amp();
         }
 
-        ui->statusBar->showMessage("Updating firmware. Please wait...");
+        if (updater == nullptr)
+        {
+            updater = std::make_unique<com::MustangUpdater>([this](std::size_t packetsSent, std::size_t packetsTotal)
+                                                            { QMetaObject::invokeMethod(this, [this, packetsSent, packetsTotal]
+                                                                                        { firmware_progress(packetsSent, packetsTotal); }, Qt::QueuedConnection); },
+                                                            [this](std::exception_ptr error)
+                                                            { QMetaObject::invokeMethod(this, [this, error]
+                                                                                        { firmware_updated(error); }, Qt::QueuedConnection); });
+            connect(firmwareProgress, &QProgressDialog::canceled, this, &MainWindow::firmware_cancel_requested);
+        }
+
+        try
+        {
+            updater->start(filename.toStdString(), [context = usbContext]
+                           { return com::connectUpdateMode(context); });
+        }
+        catch (const std::exception& ex)
+        {
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+            return;
+        }
+
+        ui->statusBar->showMessage(tr("Updating firmware. Please wait..."));
         ui->centralWidget->setDisabled(true);
         ui->menuBar->setDisabled(true);
-        this->repaint();
-        const int ret = com::updateFirmware(filename.toLatin1().constData());
+        firmwareProgress->setRange(0, 0);
+        firmwareProgress->setValue(0);
+        firmwareProgress->show();
+    }
+
+    void MainWindow::firmware_progress(std::size_t packetsSent, std::size_t packetsTotal)
+    {
+        firmwareProgress->setRange(0, static_cast<int>(packetsTotal));
+        firmwareProgress->setValue(static_cast<int>(packetsSent));
+    }
+
+    // The range is set by the first answered packet, from then on the amp is
+    // being written and cancelling leaves it without a working firmware
+    void MainWindow::firmware_cancel_requested()
+    {
+        if (firmwareProgress->maximum() > 0)
+        {
+            const auto answer = QMessageBox::warning(this, tr("Cancel firmware update"),
+                                                     tr("The firmware is already being written. Cancelling now leaves the amplifier without a working firmware until the update is done again.\n\nCancel anyway?"),
+                                                     QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+
+            if (answer != QMessageBox::Yes)
+            {
+                firmwareProgress->show();
+                return;
+            }
+        }
+        updater->cancel();
+    }
+
+    void MainWindow::firmware_updated(std::exception_ptr error)
+    {
+        firmwareProgress->reset();
         ui->centralWidget->setDisabled(false);
         ui->menuBar->setDisabled(false);
         ui->statusBar->showMessage("", 1);
-        if (ret == -100)
-        {
-            ui->statusBar->showMessage(tr("Error: Suitable device not found!"), 5000);
-            return;
-        }
-        if (ret != 0)
+
+        if (error != nullptr)
         {
-            ui->statusBar->showMessage(QString(tr("Communication error: %1")).arg(ret), 5000);
+            ui->statusBar->showMessage(QString(tr("Firmware update failed: %1")).arg(errorMessage(error)), 5000);
             return;
         }
         QMessageBox::information(this, "Update finished", R"(<b>Update finished</b><br>If "Exit" button is lit - update was succesful<br>If "Save" button is lit - update failed<br><br>Power off the amplifier and then back on to finish the process.)");
@@ -764,20 +1084,41 @@ namespace plug
     void MainWindow::empty_other(int value, Effect* caller)
     {
         const int fx_family = check_fx_family(static_cast<effects>(value));
-        fx_pedal_settings settings{FxSlot{0}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+        std::vector<Effect*> emptiedComponents;
 
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [&caller, &settings, fx_family](const auto& comp)
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [&caller, &emptiedComponents, fx_family](const auto& comp)
                       {
-            if (caller != comp)
+            if ((caller != comp) && (check_fx_family(comp->getSettings().effect_num) == fx_family))
             {
-                settings = comp->getSettings();
-
-                if (check_fx_family(settings.effect_num) == fx_family)
-                {
-                    comp->choose_fx(0);
-                    comp->send_fx();
-                }
+                comp->choose_fx(0);
+                emptiedComponents.push_back(comp);
             } });
+
+        QSettings settings;
+
+        if (connected && !settings.value("Settings/oneSetToSetThemAll").toBool())
+        {
+            send_settings(std::nullopt, emptiedComponents);
+        }
+    }
+
+    // Updates queued together are coalesced and sent in one transaction
+    void MainWindow::send_settings(std::optional<amp_settings> amplifier_settings, const std::vector<Effect*>& components)
+    {
+        if (!connected)
+        {
+            return;
+        }
+
+        if (amplifier_settings)
+        {
+            worker->update(*amplifier_settings);
+        }
+
+        std::for_each(components.cbegin(), components.cend(), [this](const auto& comp)
+                      {
+            worker->update(comp->getSettings());
+            comp->set_changed(false); });
     }
 
     void MainWindow::loadPreset(std::size_t number)
@@ -790,6 +1131,61 @@ namespace plug
         }
     }
 
+    void MainWindow::show_latency(double milliseconds)
+    {
+        QSettings settings;
+
+        if (settings.value("Settings/liveKnobs").toBool())
+        {
+            ui->statusBar->showMessage(QString(tr("Live: %1 ms")).arg(milliseconds, 0, 'f', 1), 2000);
+        }
+    }
+
+    // Keeps what is known about the connected amp for the next start
+    void MainWindow::store_state()
+    {
+        if (deviceKey.empty())
+        {
+            return;
+        }
+
+        com::CachedState state{};
+        state.presetNames = presetNames;
+
+        amp_settings amplifier_settings{};
+        std::vector<fx_pedal_settings> effects_settings;
+        get_settings(&amplifier_settings, effects_settings);
+        state.signalChain = SignalChain{current_name.toStdString(), amplifier_settings, effects_settings};
+
+        state.banks.reserve(presetCache->size());
+        for (std::size_t slot = 0; slot < presetCache->size(); ++slot)
+        {
+            state.banks.push_back(presetCache->get(static_cast<std::uint8_t>(slot)));
+        }
+        state.effectPresets = effectPresetTable->presets();
+
+        try
+        {
+            com::saveStateCache(stateCacheDirectory(), deviceKey, state);
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "Unable to store state cache: " << ex.what();
+        }
+    }
+
+    void MainWindow::show_error(const QString& message)
+    {
+        qWarning() << "ERROR: " << message;
+        ui->statusBar->showMessage(QString(tr("Error: %1")).arg(message), 5000);
+
+        if (!connected)
+        {
+            ui->actionConnect->setDisabled(false);
+            connectProgress->hide();
+        }
+    }
+
 }
 
 #include "ui/moc_mainwindow.moc"
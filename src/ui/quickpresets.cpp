@@ -48,24 +48,35 @@ namespace plug
 
     void QuickPresets::load_names(const std::vector<std::string>& names)
     {
-        QSettings settings;
         std::size_t i = 0;
 
-        std::for_each(names.cbegin(), names.cend(), [&i, this](const auto& nameStr)
-                      {
-            const QString name = QString::fromStdString(nameStr);
-            const auto index = i + 1;
-            ui->comboBox->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_2->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_3->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_4->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_5->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_6->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_7->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_8->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_9->addItem(QString("[%1] %2").arg(index).arg(name));
-            ui->comboBox_10->addItem(QString("[%1] %2").arg(index).arg(name));
-            ++i; });
+        std::for_each(names.cbegin(), names.cend(), [&i, this](const auto& name)
+                      { add_name(i++, name); });
+        select_defaults();
+    }
+
+    // names are appended in slot order while they are received
+    void QuickPresets::add_name(std::size_t slot, const std::string& nameStr)
+    {
+        const QString name = QString::fromStdString(nameStr);
+        const auto index = slot + 1;
+        ui->comboBox->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_2->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_3->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_4->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_5->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_6->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_7->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_8->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_9->addItem(QString("[%1] %2").arg(index).arg(name));
+        ui->comboBox_10->addItem(QString("[%1] %2").arg(index).arg(name));
+    }
+
+    // adds the empty entry after the last name and restores the selections
+    void QuickPresets::select_defaults()
+    {
+        QSettings settings;
+        const int i = ui->comboBox->count();
 
         ui->comboBox->addItem(tr("[Empty]"));
         ui->comboBox_2->addItem(tr("[Empty]"));
@@ -23,23 +23,33 @@
 #include "ui/mainwindow.h"
 #include "ui_save_effects.h"
 #include <QSettings>
+#include <algorithm>
 
 namespace plug
 {
 
     SaveEffects::SaveEffects(QWidget* parent)
         : QDialog(parent),
-          ui(std::make_unique<Ui::Save_effects>())
+          ui(std::make_unique<Ui::Save_effects>()),
+          slotNames(),
+          presets()
     {
         ui->setupUi(this);
 
+        for (int i = 0; i < ui->comboBox->count(); ++i)
+        {
+            slotNames.append(ui->comboBox->itemText(i));
+        }
+
         QSettings settings;
         restoreGeometry(settings.value("Windows/saveEffectPresetWindowGeometry").toByteArray());
 
         connect(ui->checkBox, SIGNAL(clicked()), this, SLOT(select_checkbox()));
         connect(ui->checkBox_2, SIGNAL(clicked()), this, SLOT(select_checkbox()));
         connect(ui->checkBox_3, SIGNAL(clicked()), this, SLOT(select_checkbox()));
+        connect(ui->comboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(select_slot(int)));
         connect(ui->pushButton, SIGNAL(clicked()), this, SLOT(send()));
+        connect(ui->pushButton_3, SIGNAL(clicked()), this, SLOT(recall()));
         connect(ui->pushButton_2, SIGNAL(clicked()), this, SLOT(close()));
     }
 
@@ -63,6 +73,19 @@ namespace plug
         {
             ui->checkBox->setChecked(false);
         }
+        update_names();
+    }
+
+    void SaveEffects::select_slot(int)
+    {
+        const auto preset = selected_preset();
+        const bool knobSelected = (ui->checkBox->isChecked() || ui->checkBox_2->isChecked() || ui->checkBox_3->isChecked());
+
+        if (preset)
+        {
+            ui->lineEdit->setText(QString::fromStdString(preset->name));
+        }
+        ui->pushButton_3->setEnabled(preset.has_value() && knobSelected);
     }
 
     void SaveEffects::send()
@@ -89,6 +112,51 @@ namespace plug
                                                           ui->checkBox->isChecked(), ui->checkBox_2->isChecked(), ui->checkBox_3->isChecked());
         this->close();
     }
+
+    void SaveEffects::recall()
+    {
+        dynamic_cast<MainWindow*>(parent())->recall_effect_preset(selected_knob(), static_cast<std::uint8_t>(ui->comboBox->currentIndex()));
+        this->close();
+    }
+
+    // presets already known from the amp, no need to read them again
+    void SaveEffects::load_presets(const std::vector<EffectPreset>& effectPresets)
+    {
+        presets = effectPresets;
+        update_names();
+    }
+
+    EffectKnob SaveEffects::selected_knob() const
+    {
+        return ui->checkBox->isChecked() ? EffectKnob::mod : EffectKnob::dlyRev;
+    }
+
+    std::optional<EffectPreset> SaveEffects::selected_preset() const
+    {
+        const auto knob = selected_knob();
+        const auto slot = ui->comboBox->currentIndex();
+        const auto itr = std::find_if(presets.cbegin(), presets.cend(), [knob, slot](const auto& preset)
+                                      { return (preset.knob == knob) && (preset.slot == slot); });
+
+        if (itr == presets.cend())
+        {
+            return std::nullopt;
+        }
+        return *itr;
+    }
+
+    void SaveEffects::update_names()
+    {
+        const auto knob = selected_knob();
+
+        for (int i = 0; i < slotNames.size(); ++i)
+        {
+            const auto itr = std::find_if(presets.cbegin(), presets.cend(), [knob, i](const auto& preset)
+                                          { return (preset.knob == knob) && (preset.slot == i); });
+            ui->comboBox->setItemText(i, itr != presets.cend() ? QString("%1: %2").arg(slotNames[i], QString::fromStdString(itr->name)) : slotNames[i]);
+        }
+        select_slot(ui->comboBox->currentIndex());
+    }
 }
 
 #include "ui/moc_save_effects.moc"
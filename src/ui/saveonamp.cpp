@@ -50,10 +50,7 @@ namespace plug
     void SaveOnAmp::save()
     {
         QSettings settings;
-        QString name(QString("[%1] %2").arg(ui->comboBox->currentIndex()).arg(ui->lineEdit->text()));
 
-        ui->comboBox->setItemText(ui->comboBox->currentIndex(), name);
-        dynamic_cast<MainWindow*>(parent())->change_name(ui->comboBox->currentIndex(), &name);
         dynamic_cast<MainWindow*>(parent())->save_on_amp(ui->lineEdit->text().toLatin1().data(), ui->comboBox->currentIndex());
         if (!settings.value("Settings/keepWindowsOpen").toBool())
         {
@@ -63,19 +60,24 @@ namespace plug
 
     void SaveOnAmp::load_names(const std::vector<std::string>& names)
     {
-        std::size_t index{1};
+        std::size_t index{0};
         std::for_each(names.cbegin(), names.cend(), [&index, this](const auto& name)
-                      {
-            ui->comboBox->addItem(QString("[%1] %2").arg(index).arg(QString::fromStdString(name)));
-            ++index; });
+                      { add_name(index++, name); });
+    }
+
+    void SaveOnAmp::add_name(std::size_t slot, const std::string& name)
+    {
+        ui->comboBox->addItem(QString("[%1] %2").arg(slot + 1).arg(QString::fromStdString(name)));
     }
 
     void SaveOnAmp::delete_items()
     {
-        for (int i = 0; i < ui->comboBox->count(); ++i)
-        {
-            ui->comboBox->removeItem(0);
-        }
+        ui->comboBox->clear();
+    }
+
+    void SaveOnAmp::change_name(int slot, QString* name)
+    {
+        ui->comboBox->setItemText(slot, *name);
     }
 
     void SaveOnAmp::change_index(int value, const QString& name)
@@ -20,6 +20,7 @@
  */
 
 #include "ui/savetofile.h"
+#include "com/IdLookup.h"
 #include "ui/mainwindow.h"
 #include "ui_savetofile.h"
 #include <QFileDialog>
@@ -97,86 +98,11 @@ namespace plug
 
     void SaveToFile::writeAmp(amp_settings settings)
     {
-        int model{0};
-        int something{0};
-        int something2{0};
-        int something3{128};
-
-        switch (static_cast<amps>(settings.amp_num))
-        {
-            case amps::FENDER_57_DELUXE:
-                model = 0x67;
-                something = 0x01;
-                something2 = 0x53;
-                break;
-
-            case amps::FENDER_59_BASSMAN:
-                model = 0x64;
-                something = 0x02;
-                something2 = 0x67;
-                break;
-
-            case amps::FENDER_57_CHAMP:
-                model = 0x7c;
-                something = 0x0c;
-                something2 = 0x00;
-                break;
-
-            case amps::FENDER_65_DELUXE_REVERB:
-                model = 0x53;
-                something = 0x03;
-                something2 = 0x6a;
-                something3 = 0x00;
-                break;
-
-            case amps::FENDER_65_PRINCETON:
-                model = 0x6a;
-                something = 0x04;
-                something2 = 0x61;
-                break;
-
-            case amps::FENDER_65_TWIN_REVERB:
-                model = 0x75;
-                something = 0x05;
-                something2 = 0x72;
-                break;
-
-            case amps::FENDER_SUPER_SONIC:
-                model = 0x72;
-                something = 0x06;
-                something2 = 0x79;
-                break;
-
-            case amps::BRITISH_60S:
-                model = 0x61;
-                something = 0x07;
-                something2 = 0x5e;
-                break;
-
-            case amps::BRITISH_70S:
-                model = 0x79;
-                something = 0x0b;
-                something2 = 0x7c;
-                break;
-
-            case amps::BRITISH_80S:
-                model = 0x5e;
-                something = 0x09;
-                something2 = 0x5d;
-                break;
-
-            case amps::AMERICAN_90S:
-                model = 0x5d;
-                something = 0x0a;
-                something2 = 0x6d;
-                break;
-
-            case amps::METAL_2000:
-                model = 0x6d;
-                something = 0x08;
-                something2 = 0x75;
-                break;
-        }
+        const auto& ids = lookupAmp(settings.amp_num);
+        const int model{ids.id};
+        const int something{ids.specific[0]};
+        const int something2{ids.specific[4]};
+        const int something3{ids.unknown[0]};
 
         xml->writeStartElement("Amplifier");
         xml->writeStartElement("Module");
@@ -347,162 +273,7 @@ namespace plug
 
     void SaveToFile::writeFX(fx_pedal_settings settings)
     {
-        int model{0};
-
-        switch (static_cast<effects>(settings.effect_num))
-        {
-            case effects::EMPTY:
-                model = 0x00;
-                break;
-
-            case effects::OVERDRIVE:
-                model = 0x3c;
-                break;
-
-            case effects::WAH:
-                model = 0x49;
-                break;
-
-            case effects::TOUCH_WAH:
-                model = 0x4a;
-                break;
-
-            case effects::FUZZ:
-                model = 0x1a;
-                break;
-
-            case effects::FUZZ_TOUCH_WAH:
-                model = 0x1c;
-                break;
-
-            case effects::SIMPLE_COMP:
-                model = 0x88;
-                break;
-
-            case effects::COMPRESSOR:
-                model = 0x07;
-                break;
-
-            case effects::SINE_CHORUS:
-                model = 0x12;
-                break;
-
-            case effects::TRIANGLE_CHORUS:
-                model = 0x13;
-                break;
-
-            case effects::SINE_FLANGER:
-                model = 0x18;
-                break;
-
-            case effects::TRIANGLE_FLANGER:
-                model = 0x19;
-                break;
-
-            case effects::VIBRATONE:
-                model = 0x2d;
-                break;
-
-            case effects::VINTAGE_TREMOLO:
-                model = 0x40;
-                break;
-
-            case effects::SINE_TREMOLO:
-                model = 0x41;
-                break;
-
-            case effects::RING_MODULATOR:
-                model = 0x22;
-                break;
-
-            case effects::STEP_FILTER:
-                model = 0x29;
-                break;
-
-            case effects::PHASER:
-                model = 0x4f;
-                break;
-
-            case effects::PITCH_SHIFTER:
-                model = 0x1f;
-                break;
-
-            case effects::MONO_DELAY:
-                model = 0x16;
-                break;
-
-            case effects::MONO_ECHO_FILTER:
-                model = 0x43;
-                break;
-
-            case effects::STEREO_ECHO_FILTER:
-                model = 0x48;
-                break;
-
-            case effects::MULTITAP_DELAY:
-                model = 0x44;
-                break;
-
-            case effects::PING_PONG_DELAY:
-                model = 0x45;
-                break;
-
-            case effects::DUCKING_DELAY:
-                model = 0x15;
-                break;
-
-            case effects::REVERSE_DELAY:
-                model = 0x46;
-                break;
-
-            case effects::TAPE_DELAY:
-                model = 0x2b;
-                break;
-
-            case effects::STEREO_TAPE_DELAY:
-                model = 0x2a;
-                break;
-
-            case effects::SMALL_HALL_REVERB:
-                model = 0x24;
-                break;
-
-            case effects::LARGE_HALL_REVERB:
-                model = 0x3a;
-                break;
-
-            case effects::SMALL_ROOM_REVERB:
-                model = 0x26;
-                break;
-
-            case effects::LARGE_ROOM_REVERB:
-                model = 0x3b;
-                break;
-
-            case effects::SMALL_PLATE_REVERB:
-                model = 0x4e;
-                break;
-
-            case effects::LARGE_PLATE_REVERB:
-                model = 0x4b;
-                break;
-
-            case effects::AMBIENT_REVERB:
-                model = 0x4c;
-                break;
-
-            case effects::ARENA_REVERB:
-                model = 0x4d;
-                break;
-
-            case effects::FENDER_63_SPRING_REVERB:
-                model = 0x21;
-                break;
-
-            case effects::FENDER_65_SPRING_REVERB:
-                model = 0x0b;
-                break;
-        }
+        const int model{lookupEffect(settings.effect_num).id};
 
         xml->writeStartElement("Module");
         xml->writeAttribute("ID", QString("%1").arg(model));
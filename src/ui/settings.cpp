@@ -38,12 +38,16 @@ namespace plug
         ui->checkBox_4->setChecked(settings.value("Settings/keepWindowsOpen").toBool());
         ui->checkBox_5->setChecked(settings.value("Settings/popupChangedWindows").toBool());
         ui->checkBox_6->setChecked(settings.value("Settings/defaultEffectValues").toBool());
+        ui->checkBox_7->setChecked(settings.value("Settings/liveKnobs").toBool());
+        ui->checkBox_8->setChecked(settings.value("Settings/pipelineCommands").toBool());
 
         connect(ui->checkBox_2, SIGNAL(toggled(bool)), this, SLOT(change_connect(bool)));
         connect(ui->checkBox_3, SIGNAL(toggled(bool)), this, SLOT(change_oneset(bool)));
         connect(ui->checkBox_4, SIGNAL(toggled(bool)), this, SLOT(change_keepopen(bool)));
         connect(ui->checkBox_5, SIGNAL(toggled(bool)), this, SLOT(change_popupwindows(bool)));
         connect(ui->checkBox_6, SIGNAL(toggled(bool)), this, SLOT(change_effectvalues(bool)));
+        connect(ui->checkBox_7, SIGNAL(toggled(bool)), this, SLOT(change_liveknobs(bool)));
+        connect(ui->checkBox_8, SIGNAL(toggled(bool)), this, SLOT(change_pipelining(bool)));
     }
 
     void Settings::change_connect(bool value)
@@ -80,6 +84,20 @@ namespace plug
 
         settings.setValue("Settings/defaultEffectValues", value);
     }
+
+    void Settings::change_liveknobs(bool value)
+    {
+        QSettings settings;
+
+        settings.setValue("Settings/liveKnobs", value);
+    }
+
+    void Settings::change_pipelining(bool value)
+    {
+        QSettings settings;
+
+        settings.setValue("Settings/pipelineCommands", value);
+    }
 }
 
 #include "ui/moc_settings.moc"
@@ -0,0 +1,186 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/CommandPlanner.h"
+#include "com/PacketSerializer.h"
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class CommandPlannerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+        }
+
+        void TearDown() override
+        {
+        }
+
+        static constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                          cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                          4, 1, 5, true, 4};
+        static constexpr fx_pedal_settings e0{FxSlot{0}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        static constexpr fx_pedal_settings e1{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 6};
+        static constexpr fx_pedal_settings e2{FxSlot{4}, effects::MONO_DELAY, 3, 3, 3, 3, 3, 3};
+        static constexpr fx_pedal_settings e3{FxSlot{5}, effects::ARENA_REVERB, 9, 8, 7, 6, 5, 4};
+        const SignalChain chain{"abc", amp, {e0, e1, e2, e3}};
+        const PacketRawType applyCmd = serializeApplyCommand().getBytes();
+
+        static fx_pedal_settings e1Changed()
+        {
+            auto changed = e1;
+            changed.knob3 = 9;
+            return changed;
+        }
+    };
+
+
+    TEST_F(CommandPlannerTest, planFromUnknownStateWritesEverything)
+    {
+        const auto plan = planSignalChain(DspState{}, chain);
+
+        EXPECT_THAT(plan.commands, ElementsAre(serializeClearEffectSettings(e0).getBytes(),
+                                               serializeClearEffectSettings(e1).getBytes(),
+                                               serializeClearEffectSettings(e2).getBytes(),
+                                               serializeClearEffectSettings(e3).getBytes(),
+                                               applyCmd,
+                                               serializeAmpSettings(amp).getBytes(),
+                                               serializeEffectSettings(e0).getBytes(),
+                                               serializeEffectSettings(e1).getBytes(),
+                                               serializeEffectSettings(e2).getBytes(),
+                                               serializeEffectSettings(e3).getBytes(),
+                                               serializeAmpSettingsUsbGain(amp).getBytes(),
+                                               applyCmd));
+        EXPECT_THAT(plan.savedPackets, Eq(20 - 12));
+    }
+
+    TEST_F(CommandPlannerTest, planOfSameChainIsEmpty)
+    {
+        const auto plan = planSignalChain(chain, chain);
+
+        EXPECT_THAT(plan.commands, IsEmpty());
+        EXPECT_THAT(plan.savedPackets, Eq(20));
+    }
+
+    TEST_F(CommandPlannerTest, planWritesOnlyChangedDsp)
+    {
+        auto e2Changed = e2;
+        e2Changed.knob3 = 0;
+        const SignalChain target{"abc", amp, {e0, e1, e2Changed, e3}};
+
+        const auto plan = planSignalChain(chain, target);
+
+        EXPECT_THAT(plan.commands, ElementsAre(serializeEffectSettings(e2Changed).getBytes(), applyCmd));
+        EXPECT_THAT(plan.savedPackets, Eq(18));
+    }
+
+    TEST_F(CommandPlannerTest, planWritesOnlyChangedAmpPacket)
+    {
+        auto ampChanged = amp;
+        ampChanged.usb_gain = 7;
+        const SignalChain target{"abc", ampChanged, {e0, e1, e2, e3}};
+
+        const auto plan = planSignalChain(chain, target);
+
+        EXPECT_THAT(plan.commands, ElementsAre(serializeAmpSettingsUsbGain(ampChanged).getBytes(), applyCmd));
+    }
+
+    TEST_F(CommandPlannerTest, planClearsBeforeChangingModel)
+    {
+        constexpr fx_pedal_settings fuzz{FxSlot{0}, effects::FUZZ, 8, 7, 6, 5, 4, 3};
+        const SignalChain target{"abc", amp, {fuzz, e1, e2, e3}};
+
+        const auto plan = planSignalChain(chain, target);
+
+        EXPECT_THAT(plan.commands, ElementsAre(serializeClearEffectSettings(fuzz).getBytes(), applyCmd,
+                                               serializeEffectSettings(fuzz).getBytes(), applyCmd));
+    }
+
+    TEST_F(CommandPlannerTest, planClearsRemovedEffect)
+    {
+        const SignalChain target{"abc", amp, {e0, e2, e3}};
+
+        const auto plan = planSignalChain(chain, target);
+
+        EXPECT_THAT(plan.commands, ElementsAre(serializeClearEffectSettings(e1).getBytes(), applyCmd));
+        EXPECT_THAT(plan.state.effects[1]->enabled, IsFalse());
+    }
+
+    TEST_F(CommandPlannerTest, planSkipsAlreadyClearedDsp)
+    {
+        constexpr fx_pedal_settings empty{FxSlot{1}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+        const SignalChain current{"abc", amp, {e0, empty, e2, e3}};
+        const SignalChain target{"abc", amp, {e0, e2, e3}};
+
+        const auto plan = planSignalChain(current, target);
+
+        EXPECT_THAT(plan.commands, IsEmpty());
+    }
+
+    TEST_F(CommandPlannerTest, planCommandsUpdatesState)
+    {
+        const std::array<fx_pedal_settings, 1> effects{{e1}};
+
+        const auto plan = planCommands(DspState{}, amp, effects);
+
+        EXPECT_THAT(plan.state.amp.has_value(), IsTrue());
+        EXPECT_THAT(plan.state.effects[1]->effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(plan.state.effects[0], Eq(std::nullopt));
+    }
+
+    TEST_F(CommandPlannerTest, toDspStateMapsEffectsByDsp)
+    {
+        const SignalChain signalChain{"abc", amp, {e3, e0}};
+
+        const auto state = toDspState(signalChain);
+
+        EXPECT_THAT(state.effects[0]->effect_num, Eq(effects::OVERDRIVE));
+        EXPECT_THAT(state.effects[1], Eq(std::nullopt));
+        EXPECT_THAT(state.effects[3]->effect_num, Eq(effects::ARENA_REVERB));
+    }
+
+    TEST_F(CommandPlannerTest, isSameBankIfNothingToWrite)
+    {
+        EXPECT_THAT(isSameBank(chain, SignalChain{"abc", amp, {e0, e1, e2, e3}}), IsTrue());
+
+        // as decoded from the amp, with all four effects
+        const std::vector<fx_pedal_settings> effects{e0, {FxSlot{1}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false},
+                                                     {FxSlot{2}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false}, e3};
+        EXPECT_THAT(isSameBank(SignalChain{"abc", amp, effects}, SignalChain{"abc", amp, effects}), IsTrue());
+    }
+
+    TEST_F(CommandPlannerTest, isSameBankDetectsChanges)
+    {
+        auto changedAmp = amp;
+        changedAmp.gain = 99;
+
+        EXPECT_THAT(isSameBank(chain, SignalChain{"xyz", amp, {e0, e1, e2, e3}}), IsFalse());
+        EXPECT_THAT(isSameBank(chain, SignalChain{"abc", changedAmp, {e0, e1, e2, e3}}), IsFalse());
+        EXPECT_THAT(isSameBank(chain, SignalChain{"abc", amp, {e0, e1Changed(), e2, e3}}), IsFalse());
+        EXPECT_THAT(isSameBank(chain, SignalChain{"abc", amp, {e0, e1, e2}}), IsFalse());
+    }
+}
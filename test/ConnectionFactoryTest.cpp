@@ -21,10 +21,12 @@
 #include "com/ConnectionFactory.h"
 #include "com/CommunicationException.h"
 #include "com/Mustang.h"
+#include "mocks/LibUsbMocks.h"
 #include "mocks/UsbDeviceMock.h"
 #include <gmock/gmock-spec-builders.h>
 #include <gmock/gmock.h>
 #include <memory>
+#include <stdexcept>
 
 namespace plug::test
 {
@@ -48,34 +50,117 @@ namespace plug::test
 
         mock::UsbContextMock* contextMock{nullptr};
         mock::UsbDeviceMock* deviceMock{nullptr};
+        libusb_context ctx{};
+        libusb_context* context{&ctx};
     };
 
 
     TEST_F(ConnectionFactoryTest, connectThrowsIfNoDeviceFound)
     {
-        EXPECT_CALL(*contextMock, listDevices).WillOnce(Return(ByMove(std::vector<usb::Device>{})));
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::vector<usb::Device>{})));
 
-        EXPECT_THROW(connect(), CommunicationException);
+        EXPECT_THROW(connect(context), CommunicationException);
     }
 
     TEST_F(ConnectionFactoryTest, connectReturnsFirstDeviceFound)
     {
         std::vector<usb::Device> devices{};
-        devices.emplace_back(nullptr);
-        devices.emplace_back(nullptr);
-        devices.emplace_back(nullptr);
-        EXPECT_CALL(*contextMock, listDevices).WillOnce(Return(ByMove(std::move(devices))));
+        devices.emplace_back(context, nullptr);
+        devices.emplace_back(context, nullptr);
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::move(devices))));
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
-        EXPECT_CALL(*deviceMock, vendorId())
-            .WillOnce(Return(0xf0f0))
-            .WillOnce(Return(0x1ed8));
-        EXPECT_CALL(*deviceMock, productId())
-            .WillOnce(Return(0xff04))
-            .WillRepeatedly(Return(0x0005));
+        EXPECT_CALL(*deviceMock, productId()).WillOnce(Return(0x0005));
 
-        auto device = connect();
+        auto device = connect(context);
         EXPECT_THAT(device, NotNull());
     }
 
+    TEST_F(ConnectionFactoryTest, connectListsSupportedDevicesOnly)
+    {
+        usb::DeviceFilter filter;
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(DoAll(SaveArg<1>(&filter), Return(ByMove(std::vector<usb::Device>{}))));
+
+        EXPECT_THROW(connect(context), CommunicationException);
+        ASSERT_THAT(static_cast<bool>(filter), IsTrue());
+        EXPECT_THAT(filter(0x1ed8, 0x0004), IsTrue());
+        EXPECT_THAT(filter(0x1ed8, 0x0005), IsTrue());
+        EXPECT_THAT(filter(0x1ed8, 0x0016), IsTrue());
+        EXPECT_THAT(filter(0x1ed8, 0xff04), IsFalse());
+        EXPECT_THAT(filter(0xf0f0, 0x0005), IsFalse());
+    }
+
+    TEST_F(ConnectionFactoryTest, connectAllOpensEveryDevice)
+    {
+        std::vector<usb::Device> devices{};
+        devices.emplace_back(context, nullptr);
+        devices.emplace_back(context, nullptr);
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::move(devices))));
+        EXPECT_CALL(*deviceMock, open()).Times(2);
+        EXPECT_CALL(*deviceMock, productId())
+            .WillOnce(Return(0x0005))
+            .WillOnce(Return(0x0014));
+
+        const auto amps = connectAll(context);
+        ASSERT_THAT(amps, SizeIs(2));
+        EXPECT_THAT(amps[0]->getDeviceModel().category(), Eq(DeviceModel::Category::MustangV1));
+        EXPECT_THAT(amps[1]->getDeviceModel().category(), Eq(DeviceModel::Category::MustangV2));
+    }
+
+    TEST_F(ConnectionFactoryTest, connectAllSkipsDevicesFailingToOpen)
+    {
+        std::vector<usb::Device> devices{};
+        devices.emplace_back(context, nullptr);
+        devices.emplace_back(context, nullptr);
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::move(devices))));
+        EXPECT_CALL(*deviceMock, open())
+            .WillOnce(Throw(std::runtime_error{"busy"}))
+            .WillOnce(Return());
+        EXPECT_CALL(*deviceMock, productId()).WillRepeatedly(Return(0x0005));
+
+        EXPECT_THAT(connectAll(context), SizeIs(1));
+    }
+
+    TEST_F(ConnectionFactoryTest, connectAllThrowsIfNoDeviceFound)
+    {
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::vector<usb::Device>{})));
+
+        EXPECT_THROW(connectAll(context), CommunicationException);
+    }
+
+    TEST_F(ConnectionFactoryTest, connectUpdateModeOpensDeviceInUpdateMode)
+    {
+        usb::DeviceFilter filter;
+        std::vector<usb::Device> devices{};
+        devices.emplace_back(context, nullptr);
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(DoAll(SaveArg<1>(&filter), Return(ByMove(std::move(devices)))));
+        EXPECT_CALL(*deviceMock, open());
+
+        EXPECT_THAT(connectUpdateMode(context), NotNull());
+        EXPECT_TRUE(filter(0x1ed8, 0x0006));
+        EXPECT_TRUE(filter(0x1ed8, 0x0017));
+        EXPECT_FALSE(filter(0x1ed8, 0x0005));
+    }
+
+    TEST_F(ConnectionFactoryTest, connectUpdateModeThrowsIfNoDeviceFound)
+    {
+        EXPECT_CALL(*contextMock, listDevices(context, _)).WillOnce(Return(ByMove(std::vector<usb::Device>{})));
+
+        EXPECT_THROW(connectUpdateMode(context), CommunicationException);
+    }
+
+    TEST_F(ConnectionFactoryTest, monitorDevicesWatchesSupportedDevices)
+    {
+        usb::HotplugHandler handler;
+        EXPECT_CALL(*contextMock, monitor(context, 0x1ed8, UnorderedElementsAre(0x0004, 0x0005, 0x000a, 0x0010, 0x0012, 0x0014, 0x0016), _))
+            .WillOnce(SaveArg<3>(&handler));
+
+        std::vector<usb::HotplugEvent> events;
+        const auto monitor = monitorDevices(context, [&events](usb::HotplugEvent event, std::uint16_t)
+                                            { events.push_back(event); });
+        EXPECT_THAT(monitor, NotNull());
+
+        handler(usb::HotplugEvent::left, 0x0005);
+        EXPECT_THAT(events, ElementsAre(usb::HotplugEvent::left));
+    }
+
 }
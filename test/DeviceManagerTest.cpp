@@ -0,0 +1,209 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/DeviceManager.h"
+#include "com/CommunicationException.h"
+#include "mocks/MockConnection.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class DeviceManagerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            manager = std::make_unique<DeviceManager>([this](std::size_t device, std::exception_ptr)
+                                                      {
+                std::lock_guard lock{mutex};
+                failedDevices.push_back(device); });
+        }
+
+        void TearDown() override
+        {
+        }
+
+        std::shared_ptr<mock::MockConnection> addDevice()
+        {
+            auto conn = std::make_shared<NiceMock<mock::MockConnection>>();
+            std::promise<void> connected;
+            manager->add(std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, conn),
+                         [&connected](Mustang&)
+                         { connected.set_value(); });
+            connected.get_future().wait();
+            return conn;
+        }
+
+        std::unique_ptr<DeviceManager> manager;
+        std::mutex mutex;
+        std::vector<std::size_t> failedDevices;
+    };
+
+
+    TEST_F(DeviceManagerTest, addStartsEachDeviceOnItsOwnWorker)
+    {
+        addDevice();
+        addDevice();
+
+        EXPECT_THAT(manager->size(), Eq(2));
+        EXPECT_THAT(&manager->worker(0), Ne(&manager->worker(1)));
+        EXPECT_THROW(manager->worker(2), std::out_of_range);
+    }
+
+    TEST_F(DeviceManagerTest, addSetsReceiveTimeoutPerDevice)
+    {
+        auto first = std::make_shared<NiceMock<mock::MockConnection>>();
+        auto second = std::make_shared<NiceMock<mock::MockConnection>>();
+        EXPECT_CALL(*first, setReceiveTimeout(std::chrono::milliseconds{50}));
+        EXPECT_CALL(*second, setReceiveTimeout(_)).Times(0);
+        std::promise<void> firstConnected;
+        std::promise<void> secondConnected;
+
+        manager->add(std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, first),
+                     [&firstConnected](Mustang&)
+                     { firstConnected.set_value(); },
+                     std::chrono::milliseconds{50});
+        manager->add(std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, second),
+                     [&secondConnected](Mustang&)
+                     { secondConnected.set_value(); });
+        firstConnected.get_future().wait();
+        secondConnected.get_future().wait();
+    }
+
+    TEST_F(DeviceManagerTest, broadcastRunsOnAllDevicesInParallel)
+    {
+        constexpr std::size_t numberOfDevices{3};
+        for (std::size_t i = 0; i < numberOfDevices; ++i)
+        {
+            addDevice();
+        }
+
+        // every task waits for all others, which only works if they run at the same time
+        std::mutex startMutex;
+        std::condition_variable allStarted;
+        std::size_t started{0};
+        std::atomic<std::size_t> concurrent{0};
+
+        auto result = manager->broadcast([&](Mustang&)
+                                         {
+            std::unique_lock lock{startMutex};
+            ++started;
+            allStarted.notify_all();
+
+            if (allStarted.wait_for(lock, std::chrono::seconds{5}, [&started] { return started == numberOfDevices; }))
+            {
+                ++concurrent;
+            } });
+
+        ASSERT_THAT(result.wait_for(std::chrono::seconds{10}), Eq(std::future_status::ready));
+        const auto results = result.get();
+        ASSERT_THAT(results, SizeIs(numberOfDevices));
+        EXPECT_THAT(concurrent.load(), Eq(numberOfDevices));
+        std::for_each(results.cbegin(), results.cend(), [](const auto& r)
+                      {
+            EXPECT_THAT(r.error, Eq(nullptr));
+            EXPECT_THAT(r.latency, Gt(std::chrono::steady_clock::duration::zero())); });
+    }
+
+    TEST_F(DeviceManagerTest, broadcastReportsErrorsPerDevice)
+    {
+        addDevice();
+        addDevice();
+
+        std::atomic<int> calls{0};
+        const auto results = manager->broadcast([&calls](Mustang&)
+                                                {
+            if (calls.fetch_add(1) == 0)
+            {
+                throw CommunicationException{"failed"};
+            } })
+                                 .get();
+
+        ASSERT_THAT(results, SizeIs(2));
+        EXPECT_THAT(std::count_if(results.cbegin(), results.cend(), [](const auto& r)
+                                  { return r.error != nullptr; }),
+                    Eq(1));
+    }
+
+    TEST_F(DeviceManagerTest, broadcastReportsDeviceNotConnected)
+    {
+        addDevice();
+        manager->add(std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, std::make_shared<NiceMock<mock::MockConnection>>()),
+                     [](Mustang&)
+                     { throw CommunicationException{"start failed"}; });
+
+        const auto results = manager->broadcast([](Mustang&) {}).get();
+
+        ASSERT_THAT(results, SizeIs(2));
+        EXPECT_THAT(results[0].error, Eq(nullptr));
+        EXPECT_THAT(results[1].error, Ne(nullptr));
+
+        std::lock_guard lock{mutex};
+        EXPECT_THAT(failedDevices, Each(Eq(1)));
+        EXPECT_THAT(failedDevices, Not(IsEmpty()));
+    }
+
+    TEST_F(DeviceManagerTest, applySignalChainSendsToAllDevices)
+    {
+        auto conn0 = addDevice();
+        auto conn1 = addDevice();
+        EXPECT_CALL(*conn0, sendImpl(_, _)).Times(AtLeast(1)).WillRepeatedly(ReturnArg<1>());
+        EXPECT_CALL(*conn1, sendImpl(_, _)).Times(AtLeast(1)).WillRepeatedly(ReturnArg<1>());
+        const std::vector<std::uint8_t> ack(packetRawTypeSize, 0x01);
+        EXPECT_CALL(*conn0, receive(_)).WillRepeatedly(Return(ack));
+        EXPECT_CALL(*conn1, receive(_)).WillRepeatedly(Return(ack));
+
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3, cabinets::cab4x12G, 3, 5, 3, 2, 1, 4, 1, 5, true, 4};
+        const auto results = manager->applySignalChain(SignalChain{"abc", amp, {}}).get();
+
+        ASSERT_THAT(results, SizeIs(2));
+        EXPECT_THAT(results[0].error, Eq(nullptr));
+        EXPECT_THAT(results[1].error, Eq(nullptr));
+    }
+
+    TEST_F(DeviceManagerTest, clearRemovesAllDevices)
+    {
+        auto conn = addDevice();
+        EXPECT_CALL(*conn, close());
+
+        manager->clear();
+
+        EXPECT_THAT(manager->size(), Eq(0));
+        EXPECT_THAT(manager->broadcast([](Mustang&) {}).get(), IsEmpty());
+    }
+
+    TEST_F(DeviceManagerTest, dtorStopsAllDevices)
+    {
+        auto conn = addDevice();
+        EXPECT_CALL(*conn, close());
+
+        manager.reset();
+    }
+}
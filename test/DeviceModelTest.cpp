@@ -34,5 +34,12 @@ namespace plug::test
         EXPECT_EQ(model.name(), "Mustang I");
         EXPECT_EQ(model.category(), DeviceModel::Category::MustangV1);
         EXPECT_EQ(model.numberOfPresets(), 100);
+        EXPECT_EQ(model.numberOfEffectPresets(), 0);
+    }
+
+    TEST_F(DeviceModelTest, numberOfEffectPresets)
+    {
+        const DeviceModel model{"Mustang I", DeviceModel::Category::MustangV1, 24, 12};
+        EXPECT_EQ(model.numberOfEffectPresets(), 12);
     }
 }
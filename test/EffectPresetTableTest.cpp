@@ -0,0 +1,92 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/EffectPresetTable.h"
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class EffectPresetTableTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+        }
+
+        void TearDown() override
+        {
+        }
+
+        static EffectPreset preset(EffectKnob knob, std::uint8_t slot, const std::string& name)
+        {
+            return EffectPreset{knob, slot, name, {fx_pedal_settings{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0}}};
+        }
+    };
+
+
+    TEST_F(EffectPresetTableTest, emptyInitially)
+    {
+        EffectPresetTable table;
+
+        EXPECT_THAT(table.presets(), IsEmpty());
+        EXPECT_THAT(table.get(EffectKnob::mod, 0), Eq(std::nullopt));
+    }
+
+    TEST_F(EffectPresetTableTest, presetsAreOrderedByKnobAndSlot)
+    {
+        EffectPresetTable table;
+
+        table.put(preset(EffectKnob::dlyRev, 0, "c"));
+        table.put(preset(EffectKnob::mod, 2, "b"));
+        table.put(preset(EffectKnob::mod, 1, "a"));
+
+        ASSERT_THAT(table.presets(), SizeIs(3));
+        EXPECT_THAT(table.presets()[0].name, StrEq("a"));
+        EXPECT_THAT(table.presets()[1].name, StrEq("b"));
+        EXPECT_THAT(table.presets()[2].name, StrEq("c"));
+    }
+
+    TEST_F(EffectPresetTableTest, putReplacesPresetOfSameSlot)
+    {
+        EffectPresetTable table;
+        table.put(preset(EffectKnob::mod, 1, "a"));
+
+        table.put(preset(EffectKnob::mod, 1, "b"));
+
+        EXPECT_THAT(table.presets(), SizeIs(1));
+        EXPECT_THAT(table.get(EffectKnob::mod, 1)->name, StrEq("b"));
+        EXPECT_THAT(table.get(EffectKnob::dlyRev, 1), Eq(std::nullopt));
+    }
+
+    TEST_F(EffectPresetTableTest, clearRemovesAllPresets)
+    {
+        EffectPresetTable table;
+        table.put(preset(EffectKnob::mod, 1, "a"));
+
+        table.clear();
+
+        EXPECT_THAT(table.presets(), IsEmpty());
+    }
+}
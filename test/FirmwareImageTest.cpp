@@ -0,0 +1,135 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/FirmwareImage.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class FirmwareImageTest : public testing::Test
+    {
+    protected:
+        static std::vector<std::uint8_t> createImage(std::size_t payloadSize)
+        {
+            const std::string date{"Jan 31 2013"};
+            std::vector<std::uint8_t> image(0x110 + payloadSize, 0x00);
+            std::copy(date.cbegin(), date.cend(), std::next(image.begin(), 0x1a));
+
+            for (std::size_t i = 0; i < payloadSize; ++i)
+            {
+                image[0x110 + i] = static_cast<std::uint8_t>(i);
+            }
+            return image;
+        }
+
+        static std::vector<std::uint8_t> head(const PacketRawType& packet, std::size_t n)
+        {
+            return {packet.cbegin(), std::next(packet.cbegin(), static_cast<std::ptrdiff_t>(n))};
+        }
+    };
+
+
+    TEST_F(FirmwareImageTest, firstPacketContainsDate)
+    {
+        const auto packets = toFirmwarePackets(createImage(10));
+
+        EXPECT_THAT(head(packets.front(), 16), ElementsAre(0x02, 0x03, 0x01, 0x06, 'J', 'a', 'n', ' ', '3', '1', ' ', '2', '0', '1', '3', 0x00));
+    }
+
+    TEST_F(FirmwareImageTest, lastPacketFinishesUpdate)
+    {
+        const auto packets = toFirmwarePackets(createImage(10));
+
+        PacketRawType expected{};
+        expected[0] = 0x04;
+        expected[1] = 0x03;
+        EXPECT_THAT(packets.back(), Eq(expected));
+    }
+
+    TEST_F(FirmwareImageTest, payloadIsSplitIntoChunks)
+    {
+        const auto packets = toFirmwarePackets(createImage(120));
+
+        ASSERT_THAT(packets, SizeIs(5));
+        EXPECT_THAT(head(packets[1], 6), ElementsAre(0x03, 0x03, 0x00, 56, 0, 1));
+        EXPECT_THAT(head(packets[2], 6), ElementsAre(0x03, 0x03, 0x01, 56, 56, 57));
+        EXPECT_THAT(head(packets[3], 6), ElementsAre(0x03, 0x03, 0x02, 8, 112, 113));
+        EXPECT_THAT(packets[3][4 + 7], Eq(119));
+        EXPECT_THAT(packets[3][4 + 8], Eq(0x00));
+    }
+
+    TEST_F(FirmwareImageTest, payloadOfChunkSizeHasNoEmptyChunk)
+    {
+        const auto packets = toFirmwarePackets(createImage(56));
+
+        ASSERT_THAT(packets, SizeIs(3));
+        EXPECT_THAT(packets[1][3], Eq(56));
+    }
+
+    TEST_F(FirmwareImageTest, sequenceNumberWraps)
+    {
+        const auto packets = toFirmwarePackets(createImage(257 * 56));
+
+        ASSERT_THAT(packets, SizeIs(259));
+        EXPECT_THAT(packets[1][2], Eq(0x00));
+        EXPECT_THAT(packets[256][2], Eq(0xff));
+        EXPECT_THAT(packets[257][2], Eq(0x00));
+    }
+
+    TEST_F(FirmwareImageTest, throwsIfImageHasNoPayload)
+    {
+        EXPECT_THROW(toFirmwarePackets(createImage(0)), std::invalid_argument);
+        EXPECT_THROW(toFirmwarePackets(std::vector<std::uint8_t>(0x20, 0x00)), std::invalid_argument);
+    }
+
+    TEST_F(FirmwareImageTest, throwsIfDateIsInvalid)
+    {
+        auto image = createImage(10);
+        image[0x1a + 3] = 0x00;
+
+        EXPECT_THROW(toFirmwarePackets(image), std::invalid_argument);
+    }
+
+    TEST_F(FirmwareImageTest, loadFirmwareReadsFile)
+    {
+        const auto filename = std::filesystem::temp_directory_path() / ("plug-firmware-image-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".upd");
+        const auto image = createImage(100);
+        std::ofstream{filename, std::ios::binary}.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+
+        const auto packets = loadFirmware(filename.string());
+        std::filesystem::remove(filename);
+
+        EXPECT_THAT(packets, Eq(toFirmwarePackets(image)));
+    }
+
+    TEST_F(FirmwareImageTest, loadFirmwareThrowsIfFileIsMissing)
+    {
+        EXPECT_THROW(loadFirmware("/nonexistent/firmware.upd"), std::system_error);
+    }
+}
@@ -119,4 +119,43 @@ namespace plug::test
     {
         EXPECT_THROW(lookupCabinetById(0xff), std::invalid_argument);
     }
+
+    TEST_F(IdLookupTest, lookupIdRoundTrip)
+    {
+        for (const auto& entry : ampTable)
+        {
+            EXPECT_EQ(lookupAmpById(lookupAmp(entry.amp).id), entry.amp);
+        }
+        for (const auto& entry : effectTable)
+        {
+            EXPECT_EQ(lookupEffectById(lookupEffect(entry.effect).id), entry.effect);
+        }
+        for (const auto& entry : cabinetTable)
+        {
+            EXPECT_EQ(lookupCabinetById(lookupCabinet(entry.cabinet).id), entry.cabinet);
+        }
+    }
+
+    TEST_F(IdLookupTest, lookupIdsOfModel)
+    {
+        constexpr auto amp = lookupAmp(amps::FENDER_65_DELUXE_REVERB);
+        EXPECT_EQ(amp.id, 0x53);
+        EXPECT_THAT(amp.specific, testing::ElementsAre(0x03, 0x03, 0x03, 0x03, 0x6a));
+        EXPECT_THAT(amp.unknown, testing::ElementsAre(0x00, 0x00, 0x01));
+
+        constexpr auto effect = lookupEffect(effects::RING_MODULATOR);
+        EXPECT_EQ(effect.id, 0x22);
+        EXPECT_EQ(effect.dsp, com::DSP::effect1);
+        EXPECT_THAT(effect.unknown, testing::ElementsAre(0x01, 0x08, 0x01));
+
+        EXPECT_EQ(lookupCabinet(cabinets::cab65TWN).id, 0x09);
+    }
+
+    TEST_F(IdLookupTest, findByIdReturnsEmptyOnInvalidId)
+    {
+        static_assert(findAmpById(0x6d) == amps::METAL_2000);
+        EXPECT_EQ(findAmpById(0x00), std::nullopt);
+        EXPECT_EQ(findEffectById(0xff), std::nullopt);
+        EXPECT_EQ(findCabinetById(0x0d), std::nullopt);
+    }
 }
@@ -0,0 +1,197 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/InitialDataDecoder.h"
+#include "com/PacketSerializer.h"
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class InitialDataDecoderTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+        }
+
+        void TearDown() override
+        {
+        }
+
+        InitialDataDecoder createDecoder(std::size_t numberOfPresets, std::size_t numberOfEffectPresets = 0)
+        {
+            return InitialDataDecoder{DeviceModel{"Test Device", DeviceModel::Category::MustangV1, numberOfPresets, numberOfEffectPresets},
+                                      [this](std::size_t slot, const std::string& name)
+                                      { names.emplace_back(slot, name); },
+                                      [this](const SignalChain& signalChain)
+                                      { states.push_back(signalChain); },
+                                      [this](const EffectPreset& preset)
+                                      { effectPresets.push_back(preset); }};
+        }
+
+        void pushPresetNames(InitialDataDecoder& decoder, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                decoder.push(serializeName(static_cast<std::uint8_t>(i), "preset" + std::to_string(i)).getBytes());
+                decoder.push(emptyPacket);
+            }
+        }
+
+        void pushState(InitialDataDecoder& decoder, std::uint8_t slot)
+        {
+            decoder.push(serializeName(slot, "current").getBytes());
+            decoder.push(ampPacket);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                decoder.push(emptyPacket);
+            }
+            decoder.push(confirmationPacket);
+        }
+
+        static constexpr fx_pedal_settings delay{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0};
+        static constexpr fx_pedal_settings reverb{FxSlot{3}, effects::ARENA_REVERB, 6, 7, 8, 9, 1, 0};
+        const PacketRawType emptyPacket{};
+        const PacketRawType ampPacket = []
+        { PacketRawType p{}; p[16] = 0x5e; return p; }();
+        const PacketRawType confirmationPacket = []
+        { PacketRawType p{}; p[0] = 0x1c; p[1] = 0x01; return p; }();
+        std::vector<std::pair<std::size_t, std::string>> names;
+        std::vector<SignalChain> states;
+        std::vector<EffectPreset> effectPresets;
+    };
+
+
+    TEST_F(InitialDataDecoderTest, namesAreReportedAsTheyArrive)
+    {
+        auto decoder = createDecoder(24);
+
+        pushPresetNames(decoder, 2);
+
+        EXPECT_THAT(names, ElementsAre(Pair(0, "preset0"), Pair(1, "preset1")));
+        EXPECT_THAT(decoder.hasState(), IsFalse());
+    }
+
+    TEST_F(InitialDataDecoderTest, stateFollowsPresetNames)
+    {
+        auto decoder = createDecoder(24);
+
+        pushPresetNames(decoder, 24);
+        pushState(decoder, 3);
+
+        EXPECT_THAT(names, SizeIs(24));
+        ASSERT_THAT(states, SizeIs(1));
+        EXPECT_THAT(states[0].name(), StrEq("current"));
+        EXPECT_THAT(decoder.hasState(), IsTrue());
+    }
+
+    TEST_F(InitialDataDecoderTest, unknownNumberOfPresetsDetectsSmallDevice)
+    {
+        auto decoder = createDecoder(0);
+
+        pushPresetNames(decoder, 24);
+        pushState(decoder, 3);
+
+        EXPECT_THAT(names, SizeIs(24));
+        EXPECT_THAT(states, SizeIs(1));
+    }
+
+    TEST_F(InitialDataDecoderTest, unknownNumberOfPresetsDetectsLargeDevice)
+    {
+        auto decoder = createDecoder(0);
+
+        pushPresetNames(decoder, 100);
+        pushState(decoder, 3);
+
+        EXPECT_THAT(names, SizeIs(100));
+        EXPECT_THAT(states, SizeIs(1));
+    }
+
+    TEST_F(InitialDataDecoderTest, effectPresetsAreDecoded)
+    {
+        auto decoder = createDecoder(1);
+        pushPresetNames(decoder, 1);
+        pushState(decoder, 0);
+
+        decoder.push(serializeSaveEffectName(4, "echoes", {delay, reverb}).getBytes());
+        decoder.push(serializeEffectSettings(delay).getBytes());
+        decoder.push(serializeEffectSettings(reverb).getBytes());
+        decoder.push(confirmationPacket);
+
+        ASSERT_THAT(effectPresets, SizeIs(1));
+        EXPECT_THAT(effectPresets[0].knob, Eq(EffectKnob::dlyRev));
+        EXPECT_THAT(effectPresets[0].slot, Eq(4));
+        EXPECT_THAT(effectPresets[0].name, StrEq("echoes"));
+        ASSERT_THAT(effectPresets[0].effects, SizeIs(2));
+        EXPECT_THAT(effectPresets[0].effects[0].effect_num, Eq(effects::MONO_DELAY));
+        EXPECT_THAT(effectPresets[0].effects[1].knob3, Eq(8));
+    }
+
+    TEST_F(InitialDataDecoderTest, invalidEffectPresetIsSkipped)
+    {
+        auto decoder = createDecoder(1);
+        pushPresetNames(decoder, 1);
+        pushState(decoder, 0);
+        PacketRawType invalidEffect = serializeEffectSettings(delay).getBytes();
+        invalidEffect[16] = 0xff;
+
+        decoder.push(serializeSaveEffectName(4, "echoes", {delay}).getBytes());
+        decoder.push(invalidEffect);
+        decoder.push(confirmationPacket);
+
+        EXPECT_THAT(effectPresets, IsEmpty());
+    }
+
+    TEST_F(InitialDataDecoderTest, isCompleteAfterEffectPresetsOfBothKnobs)
+    {
+        auto decoder = createDecoder(1, 1);
+        pushPresetNames(decoder, 1);
+        pushState(decoder, 0);
+
+        decoder.push(serializeSaveEffectName(0, "wobble", {delay}).getBytes());
+        decoder.push(serializeEffectSettings(delay).getBytes());
+        decoder.push(confirmationPacket);
+        EXPECT_THAT(decoder.isComplete(), IsFalse());
+
+        decoder.push(serializeSaveEffectName(0, "echoes", {delay, reverb}).getBytes());
+        decoder.push(serializeEffectSettings(delay).getBytes());
+        decoder.push(serializeEffectSettings(reverb).getBytes());
+        decoder.push(confirmationPacket);
+        EXPECT_THAT(decoder.isComplete(), IsTrue());
+    }
+
+    TEST_F(InitialDataDecoderTest, isNeverCompleteWithUnknownNumberOfEffectPresets)
+    {
+        auto decoder = createDecoder(1);
+        pushPresetNames(decoder, 1);
+        pushState(decoder, 0);
+
+        decoder.push(confirmationPacket);
+        decoder.push(confirmationPacket);
+
+        EXPECT_THAT(decoder.isComplete(), IsFalse());
+    }
+}
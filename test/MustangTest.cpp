@@ -42,6 +42,7 @@ namespace plug::test
         void SetUp() override
         {
             conn = std::make_shared<mock::MockConnection>();
+            EXPECT_CALL(*conn, discardReceived()).Times(AnyNumber());
             m = std::make_unique<com::Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, conn);
         }
 
@@ -54,6 +55,18 @@ namespace plug::test
             return std::vector<std::uint8_t>(packetRawTypeSize, 0x00);
         }
 
+        // Records all sent packets and confirms each of them
+        void ackAllCommands(std::vector<PacketRawType>& sent)
+        {
+            EXPECT_CALL(*conn, sendImpl(_, packetRawTypeSize)).WillRepeatedly(Invoke([&sent](const std::uint8_t* data, std::size_t size)
+                                                                                     {
+                PacketRawType packet{};
+                std::copy_n(data, size, packet.begin());
+                sent.push_back(packet);
+                return size; }));
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillRepeatedly(Return(confirmationData));
+        }
+
         template <class Container>
         [[nodiscard]] auto asBuffer(const Container& c) const
         {
@@ -67,6 +80,8 @@ namespace plug::test
         const std::vector<std::uint8_t> ignoreData = std::vector<std::uint8_t>(packetRawTypeSize);
         const std::vector<std::uint8_t> ignoreAmpData = []
         { std::vector<std::uint8_t> d(packetRawTypeSize, 0x00); d[16] = 0x5e; return d; }();
+        const std::vector<std::uint8_t> confirmationData = []
+        { std::vector<std::uint8_t> d(packetRawTypeSize, 0x00); d[0] = 0x1c; d[1] = 0x01; return d; }();
         const PacketRawType loadCmd = serializeLoadCommand().getBytes();
         const PacketRawType applyCmd = serializeApplyCommand().getBytes();
         static inline constexpr std::size_t numPresetPackets{200};
@@ -151,7 +166,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, effectPresets] = m->start_amp();
         EXPECT_THAT(signalChain.name(), StrEq(actualName));
 
         static_cast<void>(presets);
@@ -195,7 +210,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, effectPresets] = m->start_amp();
         EXPECT_THAT(signalChain.amp(), AmpIs(amp));
 
         static_cast<void>(presets);
@@ -243,7 +258,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, effectPresets] = m->start_amp();
 
         EXPECT_THAT(signalChain.effects()[0], EffectIs(e0));
 
@@ -294,7 +309,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presetList] = m->start_amp();
+        const auto [signalChain, presetList, effectPresets] = m->start_amp();
 
         EXPECT_THAT(presetList.size(), Eq(numPresetPackets / 2));
         EXPECT_THAT(presetList[0], StrEq("abc"));
@@ -340,6 +355,92 @@ namespace plug::test
         m->start_amp();
     }
 
+    TEST_F(MustangTest, startReportsPresetNamesAsReceived)
+    {
+        std::vector<std::string> reported;
+        EXPECT_CALL(*conn, isOpen()).WillOnce(Return(true));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(packetRawTypeSize));
+
+        InSequence s;
+        // Init responses
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(2).WillRepeatedly(Return(ignoreData));
+
+        // Preset names data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(serializeName(0, "abc").getBytes())));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(numPresetPackets - 1).WillRepeatedly(Return(ignoreData));
+
+        // Data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData)).WillOnce(Return(ignoreAmpData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(5).WillRepeatedly(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+
+        m->start_amp([&reported](std::size_t, const std::string& name)
+                     { reported.push_back(name); });
+
+        EXPECT_THAT(reported, SizeIs(numPresetPackets / 2));
+        EXPECT_THAT(reported[0], StrEq("abc"));
+    }
+
+    TEST_F(MustangTest, startCollectsEffectPresets)
+    {
+        constexpr fx_pedal_settings effect{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0};
+        EXPECT_CALL(*conn, isOpen()).WillOnce(Return(true));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(packetRawTypeSize));
+
+        InSequence s;
+        // Init responses and preset names data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(2 + numPresetPackets).WillRepeatedly(Return(ignoreData));
+
+        // Data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData)).WillOnce(Return(ignoreAmpData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(5).WillRepeatedly(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // Effect presets
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(asBuffer(serializeSaveEffectName(2, "wobble", {effect}).getBytes())))
+            .WillOnce(Return(asBuffer(serializeEffectSettings(effect).getBytes())))
+            .WillOnce(Return(confirmationData))
+            .WillOnce(Return(noData));
+
+        const auto initialData = m->start_amp();
+
+        ASSERT_THAT(initialData.effectPresets, SizeIs(1));
+        EXPECT_THAT(initialData.effectPresets[0].name, StrEq("wobble"));
+        EXPECT_THAT(initialData.effectPresets[0].knob, Eq(EffectKnob::mod));
+    }
+
+    TEST_F(MustangTest, startStopsAfterLastEffectPreset)
+    {
+        constexpr fx_pedal_settings effect{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0};
+        m = std::make_unique<com::Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100, 1}, conn);
+        EXPECT_CALL(*conn, isOpen()).WillOnce(Return(true));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(packetRawTypeSize));
+
+        InSequence s;
+        // Init responses and preset names data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(2 + numPresetPackets).WillRepeatedly(Return(ignoreData));
+
+        // Data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData)).WillOnce(Return(ignoreAmpData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(5).WillRepeatedly(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // One effect preset per knob, nothing is read after the last one
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(asBuffer(serializeSaveEffectName(0, "wobble", {effect}).getBytes())))
+            .WillOnce(Return(asBuffer(serializeEffectSettings(effect).getBytes())))
+            .WillOnce(Return(confirmationData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(0);
+
+        const auto initialData = m->start_amp();
+
+        EXPECT_THAT(initialData.effectPresets, SizeIs(1));
+    }
+
     TEST_F(MustangTest, stopAmpClosesConnection)
     {
         EXPECT_CALL(*conn, close());
@@ -369,6 +470,47 @@ namespace plug::test
         m->load_memory_bank(slot);
     }
 
+    TEST_F(MustangTest, loadMemoryBankStopsAtConfirmationPacket)
+    {
+        InSequence s;
+        // Load cmd
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+
+        // Data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreAmpData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
+
+        m->load_memory_bank(slot);
+    }
+
+    TEST_F(MustangTest, loadMemoryBankSkipsUnexpectedPacketsUntilConfirmation)
+    {
+        InSequence s;
+        // Load cmd
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+
+        // Data
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreAmpData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
+
+        m->load_memory_bank(slot);
+    }
+
     TEST_F(MustangTest, loadMemoryBankReceivesName)
     {
         const auto recvData = asBuffer(serializeName(0, "abc").getBytes());
@@ -468,22 +610,81 @@ namespace plug::test
         InSequence s;
         // Data #1
         EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
-        // Apply command
+        // Data #2
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // Single apply command
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
-        // Data #2
+
+        m->set_amplifier(settings);
+    }
+
+    TEST_F(MustangTest, setAmpPipelinesCommandsIfEnabled)
+    {
+        constexpr amp_settings settings{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                        cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                        4, 1, 5, true, 4};
+
+        const auto data = serializeAmpSettings(settings).getBytes();
+        const auto data2 = serializeAmpSettingsUsbGain(settings).getBytes();
+
+
+        InSequence s;
+        // Data #1, data #2, single apply command
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
         EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(3).WillRepeatedly(Return(confirmationData));
 
-        // Apply command
+
+        m->setPipelining(true);
+        m->set_amplifier(settings);
+    }
+
+    TEST_F(MustangTest, setAmpFallsBackToStopAndWaitOnUnexpectedAck)
+    {
+        constexpr amp_settings settings{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                        cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                        4, 1, 5, true, 4};
+
+        constexpr amp_settings settings2{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                         cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                         4, 1, 5, true, 7};
+
+        const auto data = serializeAmpSettings(settings).getBytes();
+        const auto data2 = serializeAmpSettingsUsbGain(settings).getBytes();
+        const auto data3 = serializeAmpSettingsUsbGain(settings2).getBytes();
+
+
+        InSequence s;
+        // Pipelined until the first ack isn't a confirmation
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(3).WillRepeatedly(Return(ignoreData));
+
+        // Unconfirmed commands are sent again with stop-and-wait
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // Pipelined again on the next write
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data3), data3.size())).WillOnce(Return(data3.size()));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(2).WillRepeatedly(Return(confirmationData));
 
 
+        m->setPipelining(true);
         m->set_amplifier(settings);
+        m->set_amplifier(settings2);
     }
 
     TEST_F(MustangTest, setEffectSendsValue)
@@ -496,19 +697,19 @@ namespace plug::test
 
         // Clear effect command
         EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply command
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Data
         EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply command
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         m->set_effect(settings);
     }
@@ -522,11 +723,11 @@ namespace plug::test
 
         // Clear effect command
         EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply command
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         m->set_effect(settings);
     }
@@ -540,16 +741,331 @@ namespace plug::test
         InSequence s;
         // Clear command
         EXPECT_CALL(*conn, sendImpl(BufferIs(clearCmd), clearCmd.size())).WillOnce(Return(clearCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply command
         EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+
+        m->set_effect(settings);
+    }
+
+    TEST_F(MustangTest, setEffectFallsBackToStopAndWaitOnMissingAck)
+    {
+        constexpr fx_pedal_settings settings{FxSlot{2}, effects::EMPTY, 0, 0, 0, 0, 0, 0};
+        const PacketRawType clearCmd = serializeClearEffectSettings(settings).getBytes();
+
 
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearCmd), clearCmd.size())).WillOnce(Return(clearCmd.size()));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(noData))
+            .WillOnce(Return(confirmationData));
 
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearCmd), clearCmd.size())).WillOnce(Return(clearCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+
+        m->setPipelining(true);
         m->set_effect(settings);
     }
 
+    TEST_F(MustangTest, pipelineResendsCommandsAfterMissingAck)
+    {
+        constexpr amp_settings settings{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                        cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                        4, 1, 5, true, 4};
+
+        const auto data = serializeAmpSettings(settings).getBytes();
+        const auto data2 = serializeAmpSettingsUsbGain(settings).getBytes();
+
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+
+        // The second of three acks is missing, the third is drained
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(confirmationData))
+            .WillOnce(Return(noData))
+            .WillOnce(Return(confirmationData));
+
+        // Only the unconfirmed commands are sent again
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+
+        m->setPipelining(true);
+        m->set_amplifier(settings);
+        EXPECT_THAT(m->getDspState().amp.has_value(), IsTrue());
+    }
+
+    TEST_F(MustangTest, commandsDiscardStalePacketsBeforeSending)
+    {
+        constexpr fx_pedal_settings settings{FxSlot{2}, effects::EMPTY, 0, 0, 0, 0, 0, 0};
+        const PacketRawType clearCmd = serializeClearEffectSettings(settings).getBytes();
+
+
+        InSequence s;
+        EXPECT_CALL(*conn, discardReceived());
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearCmd), clearCmd.size())).WillOnce(Return(clearCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, discardReceived());
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+
+        m->set_effect(settings);
+    }
+
+    TEST_F(MustangTest, setAmpSendsOnlyChangedPackets)
+    {
+        constexpr amp_settings settings{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                        cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                        4, 1, 5, true, 4};
+        constexpr amp_settings settings2{amps::BRITISH_70S, 8, 9, 1, 2, 7,
+                                         cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                         4, 1, 5, true, 4};
+
+        const auto data = serializeAmpSettings(settings).getBytes();
+        const auto data2 = serializeAmpSettingsUsbGain(settings).getBytes();
+        const auto data3 = serializeAmpSettings(settings2).getBytes();
+
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // Only bass changed, usb gain packet is skipped
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data3), data3.size())).WillOnce(Return(data3.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+
+        m->set_amplifier(settings);
+        m->set_amplifier(settings2);
+        m->set_amplifier(settings2);
+        EXPECT_THAT(m->getDspState().amp->bass, Eq(7));
+    }
+
+    TEST_F(MustangTest, setEffectSkipsClearIfEffectUnchanged)
+    {
+        constexpr fx_pedal_settings settings{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings settings2{FxSlot{3}, effects::OVERDRIVE, 1, 7, 6, 5, 4, 3};
+        const auto data = serializeEffectSettings(settings).getBytes();
+        const auto data2 = serializeEffectSettings(settings2).getBytes();
+        const PacketRawType clearEffect = serializeClearEffectSettings(settings).getBytes();
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // Same model in the same slot, no clear needed
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        m->set_effect(settings);
+        m->set_effect(settings2);
+        m->set_effect(settings2);
+        EXPECT_THAT(m->getDspState().effects[0]->knob1, Eq(1));
+    }
+
+    TEST_F(MustangTest, setEffectClearsIfEffectChanged)
+    {
+        constexpr fx_pedal_settings settings{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings settings2{FxSlot{3}, effects::FUZZ, 8, 7, 6, 5, 4, 3};
+        const auto data = serializeEffectSettings(settings).getBytes();
+        const auto data2 = serializeEffectSettings(settings2).getBytes();
+        const PacketRawType clearEffect = serializeClearEffectSettings(settings).getBytes();
+        const PacketRawType clearEffect2 = serializeClearEffectSettings(settings2).getBytes();
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect2), clearEffect2.size())).WillOnce(Return(clearEffect2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data2), data2.size())).WillOnce(Return(data2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        m->set_effect(settings);
+        m->set_effect(settings2);
+    }
+
+    TEST_F(MustangTest, interruptedWriteResetsDspState)
+    {
+        constexpr fx_pedal_settings settings{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings settings2{FxSlot{3}, effects::FUZZ, 8, 7, 6, 5, 4, 3};
+        const auto data = serializeEffectSettings(settings).getBytes();
+        const PacketRawType clearEffect = serializeClearEffectSettings(settings).getBytes();
+        const PacketRawType clearEffect2 = serializeClearEffectSettings(settings2).getBytes();
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        // The clear lands, then the transfer fails
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect2), clearEffect2.size())).WillOnce(Return(clearEffect2.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Throw(CommunicationException{"send failed"}));
+
+        // The previous effect is written again in full
+        EXPECT_CALL(*conn, sendImpl(BufferIs(clearEffect), clearEffect.size())).WillOnce(Return(clearEffect.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
+
+        m->set_effect(settings);
+        EXPECT_THROW(m->set_effect(settings2), CommunicationException);
+        EXPECT_THAT(m->getDspState().effects, Each(Eq(std::nullopt)));
+        m->set_effect(settings);
+    }
+
+    TEST_F(MustangTest, unacknowledgedWriteFails)
+    {
+        constexpr amp_settings settings{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                        cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                        4, 1, 5, true, 4};
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+
+        EXPECT_THROW(m->set_amplifier(settings), CommunicationException);
+        EXPECT_THAT(m->getDspState().amp.has_value(), IsFalse());
+    }
+
+    TEST_F(MustangTest, dspStateIsUnknownInitially)
+    {
+        EXPECT_THAT(m->getDspState().amp.has_value(), IsFalse());
+        EXPECT_THAT(m->getDspState().effects, Each(Eq(std::nullopt)));
+    }
+
+    TEST_F(MustangTest, loadMemoryBankUpdatesDspState)
+    {
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreAmpData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
+
+        m->load_memory_bank(slot);
+        EXPECT_THAT(m->getDspState().amp.has_value(), IsTrue());
+        EXPECT_THAT(m->getDspState().effects, Each(Ne(std::nullopt)));
+    }
+
+    TEST_F(MustangTest, transactionSendsOneApplyPerPhase)
+    {
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                   cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                   4, 1, 5, true, 4};
+        constexpr fx_pedal_settings e0{FxSlot{0}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings e1{FxSlot{5}, effects::SINE_FLANGER, 1, 2, 3, 4, 5, 6};
+        std::vector<PacketRawType> sent;
+        ackAllCommands(sent);
+
+        m->transaction().set_effect(e1).set_amplifier(amp).set_effect(e0).commit();
+
+        EXPECT_THAT(sent, ElementsAre(serializeClearEffectSettings(e0).getBytes(),
+                                      serializeClearEffectSettings(e1).getBytes(),
+                                      applyCmd,
+                                      serializeAmpSettings(amp).getBytes(),
+                                      serializeEffectSettings(e0).getBytes(),
+                                      serializeEffectSettings(e1).getBytes(),
+                                      serializeAmpSettingsUsbGain(amp).getBytes(),
+                                      applyCmd));
+    }
+
+    TEST_F(MustangTest, transactionKeepsLastWritePerSlot)
+    {
+        constexpr fx_pedal_settings e0{FxSlot{2}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings e1{FxSlot{2}, effects::FUZZ, 1, 2, 3, 4, 5, 6};
+        std::vector<PacketRawType> sent;
+        ackAllCommands(sent);
+
+        m->transaction().set_effect(e0).set_effect(e1).commit();
+
+        EXPECT_THAT(sent, ElementsAre(serializeClearEffectSettings(e1).getBytes(), applyCmd,
+                                      serializeEffectSettings(e1).getBytes(), applyCmd));
+    }
+
+    TEST_F(MustangTest, transactionSendsNothingIfEmpty)
+    {
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(0);
+        m->transaction().commit();
+    }
+
+    TEST_F(MustangTest, transactionDiscardsUncommittedWrites)
+    {
+        constexpr fx_pedal_settings e0{FxSlot{2}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(0);
+
+        m->transaction().set_effect(e0);
+        EXPECT_THAT(m->getDspState().effects, Each(Eq(std::nullopt)));
+    }
+
+    TEST_F(MustangTest, applySignalChainSendsOnlyChangedDsps)
+    {
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                   cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                   4, 1, 5, true, 4};
+        constexpr fx_pedal_settings e0{FxSlot{0}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        constexpr fx_pedal_settings e1{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 6};
+        constexpr fx_pedal_settings e1Changed{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 9, 4, 5, 6};
+        std::vector<PacketRawType> sent;
+        ackAllCommands(sent);
+
+        m->applySignalChain(SignalChain{"abc", amp, {e0, e1}});
+        sent.clear();
+        const auto saved = m->applySignalChain(SignalChain{"abc", amp, {e0, e1Changed}});
+
+        EXPECT_THAT(sent, ElementsAre(serializeEffectSettings(e1Changed).getBytes(), applyCmd));
+        EXPECT_THAT(saved, Eq(10));
+    }
+
     TEST_F(MustangTest, saveEffectsSendsValues)
     {
         const std::vector<fx_pedal_settings> settings{fx_pedal_settings{FxSlot{1}, effects::MONO_DELAY, 0, 1, 2, 3, 4, 5},
@@ -558,26 +1074,26 @@ namespace plug::test
         const auto dataName = serializeSaveEffectName(slot, name, settings).getBytes();
         const auto cmdExecute = serializeApplyCommand(settings[0]).getBytes();
         const auto packets = serializeSaveEffectPacket(slot, settings);
+        const auto effect0 = packets[0].getBytes();
+        const auto effect1 = packets[1].getBytes();
 
 
         InSequence s;
         // Save effect name cmd
         EXPECT_CALL(*conn, sendImpl(BufferIs(dataName), dataName.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Effect #0
-        const auto effect0 = packets[0].getBytes();
         EXPECT_CALL(*conn, sendImpl(BufferIs(effect0), effect0.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Effect #1
-        const auto effect1 = packets[1].getBytes();
         EXPECT_CALL(*conn, sendImpl(BufferIs(effect1), effect1.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply cmd
         EXPECT_CALL(*conn, sendImpl(BufferIs(cmdExecute), cmdExecute.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
 
         m->save_effects(slot, name, settings);
@@ -592,21 +1108,21 @@ namespace plug::test
         const auto dataName = serializeSaveEffectName(slot, name, settings).getBytes();
         const auto cmdExecute = serializeApplyCommand(settings[0]).getBytes();
         const auto packets = serializeSaveEffectPacket(slot, settings);
+        const auto effect0 = packets[0].getBytes();
 
 
         InSequence s;
         // Save effect cmd
         EXPECT_CALL(*conn, sendImpl(BufferIs(dataName), dataName.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Effect #0
-        const auto effect0 = packets[0].getBytes();
         EXPECT_CALL(*conn, sendImpl(BufferIs(effect0), effect0.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         // Apply cmd
         EXPECT_CALL(*conn, sendImpl(BufferIs(cmdExecute), cmdExecute.size())).WillOnce(Return(0));
-        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(confirmationData));
 
         m->save_effects(slot, name, settings);
     }
@@ -627,11 +1143,42 @@ namespace plug::test
         InSequence s;
         EXPECT_CALL(*conn, sendImpl(BufferIs(saveNamePacket), saveNamePacket.size())).WillOnce(Return(saveNamePacket.size()));
         EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
-        EXPECT_CALL(*conn, sendImpl(BufferIs(loadSlotCmd), loadSlotCmd.size())).WillOnce(Return(0));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(loadSlotCmd), loadSlotCmd.size())).WillOnce(Return(loadSlotCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreAmpData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
 
         m->save_on_amp(name, slot);
     }
 
+    TEST_F(MustangTest, saveOnAmpReturnsSavedBank)
+    {
+        const auto recvData = asBuffer(serializeName(0, "abc").getBytes());
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(recvData))
+            .WillOnce(Return(ignoreAmpData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(confirmationData));
+
+        const auto signalChain = m->save_on_amp("abc", slot);
+        EXPECT_THAT(signalChain.name(), StrEq("abc"));
+    }
+
     TEST_F(MustangTest, getDeviceModelReturnsInfos)
     {
         const auto model = m->getDeviceModel();
@@ -639,4 +1186,16 @@ namespace plug::test
         EXPECT_THAT(model.category(), Eq(DeviceModel::Category::MustangV1));
         EXPECT_THAT(model.numberOfPresets(), Eq(100));
     }
+
+    TEST_F(MustangTest, getDeviceNameReturnsConnectionName)
+    {
+        EXPECT_CALL(*conn, name()).WillOnce(Return("Mustang Amplifier"));
+        EXPECT_THAT(m->getDeviceName(), StrEq("Mustang Amplifier"));
+    }
+
+    TEST_F(MustangTest, getDeviceIdentityReturnsConnectionIdentity)
+    {
+        EXPECT_CALL(*conn, identity()).WillOnce(Return("1-2.4"));
+        EXPECT_THAT(m->getDeviceIdentity(), StrEq("1-2.4"));
+    }
 }
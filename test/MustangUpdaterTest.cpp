@@ -0,0 +1,230 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/MustangUpdater.h"
+#include "com/CommunicationException.h"
+#include "mocks/MockConnection.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <system_error>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class MustangUpdaterTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            filename = std::filesystem::temp_directory_path() / ("plug-firmware-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".upd");
+            conn = std::make_shared<mock::MockConnection>();
+            EXPECT_CALL(*conn, discardReceived()).Times(AnyNumber());
+        }
+
+        void TearDown() override
+        {
+            std::filesystem::remove(filename);
+        }
+
+        void writeImage(std::size_t dataSize)
+        {
+            std::vector<char> image(0x110 + dataSize, 0x00);
+            std::fill(std::next(image.begin(), 0x1a), std::next(image.begin(), 0x1a + 11), '7');
+            std::fill(std::next(image.begin(), 0x110), image.end(), 0x55);
+            std::ofstream{filename, std::ios::binary}.write(image.data(), static_cast<std::streamsize>(image.size()));
+        }
+
+        std::exception_ptr update(MustangUpdater::ProgressHandler progress = [](std::size_t, std::size_t) {})
+        {
+            std::promise<std::exception_ptr> finished;
+            MustangUpdater updater{progress, [&finished](std::exception_ptr error)
+                                   { finished.set_value(error); }};
+            updater.start(filename.string(), [this]
+                          { return conn; });
+            return finished.get_future().get();
+        }
+
+        static auto answer()
+        {
+            return Return(std::vector<std::uint8_t>(packetRawTypeSize, 0x00));
+        }
+
+        std::filesystem::path filename;
+        std::shared_ptr<mock::MockConnection> conn;
+    };
+
+
+    TEST_F(MustangUpdaterTest, sendsDateImageAndFinishPackets)
+    {
+        writeImage(100);
+        std::vector<PacketRawType> sent;
+        EXPECT_CALL(*conn, sendImpl(_, packetRawTypeSize)).Times(4).WillRepeatedly(Invoke([&sent](const std::uint8_t* data, std::size_t size)
+                                                                                          {
+            PacketRawType p{};
+            std::copy_n(data, size, p.begin());
+            sent.push_back(p);
+            return size; }));
+        EXPECT_CALL(*conn, receive(_)).Times(4).WillRepeatedly(answer());
+        EXPECT_CALL(*conn, close());
+
+        EXPECT_THAT(update(), Eq(nullptr));
+        ASSERT_THAT(sent, SizeIs(4));
+        EXPECT_THAT(std::vector<std::uint8_t>(sent[0].cbegin(), std::next(sent[0].cbegin(), 15)),
+                    ElementsAre(0x02, 0x03, 0x01, 0x06, '7', '7', '7', '7', '7', '7', '7', '7', '7', '7', '7'));
+        EXPECT_THAT(std::vector<std::uint8_t>(sent[1].cbegin(), std::next(sent[1].cbegin(), 5)), ElementsAre(0x03, 0x03, 0x00, 56, 0x55));
+        EXPECT_THAT(std::vector<std::uint8_t>(sent[2].cbegin(), std::next(sent[2].cbegin(), 5)), ElementsAre(0x03, 0x03, 0x01, 44, 0x55));
+        EXPECT_THAT(sent[2][4 + 44], Eq(0x00));
+        EXPECT_THAT(std::vector<std::uint8_t>(sent[3].cbegin(), std::next(sent[3].cbegin(), 4)), ElementsAre(0x04, 0x03, 0x00, 0x00));
+    }
+
+    TEST_F(MustangUpdaterTest, sendsNextPacketAfterAnswer)
+    {
+        writeImage(56);
+        {
+            InSequence s;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(ReturnArg<1>());
+                EXPECT_CALL(*conn, receive(_)).WillOnce(answer());
+            }
+            EXPECT_CALL(*conn, close());
+        }
+
+        EXPECT_THAT(update(), Eq(nullptr));
+    }
+
+    TEST_F(MustangUpdaterTest, reportsProgress)
+    {
+        writeImage(56);
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(ReturnArg<1>());
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(answer());
+        EXPECT_CALL(*conn, close());
+
+        std::vector<std::pair<std::size_t, std::size_t>> progress;
+        update([&progress](std::size_t sent, std::size_t total)
+               { progress.emplace_back(sent, total); });
+
+        EXPECT_THAT(progress, ElementsAre(Pair(1, 3), Pair(2, 3), Pair(3, 3)));
+    }
+
+    TEST_F(MustangUpdaterTest, failsIfPacketIsNotAnswered)
+    {
+        writeImage(56);
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(ReturnArg<1>());
+        EXPECT_CALL(*conn, receive(_)).WillOnce(Return(std::vector<std::uint8_t>{}));
+        EXPECT_CALL(*conn, close());
+
+        EXPECT_THROW(std::rethrow_exception(update()), CommunicationException);
+    }
+
+    TEST_F(MustangUpdaterTest, missingAnswerToFinishPacketIsTolerated)
+    {
+        writeImage(56);
+        {
+            InSequence s;
+            EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(ReturnArg<1>());
+            EXPECT_CALL(*conn, receive(_)).WillOnce(answer());
+            EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(ReturnArg<1>());
+            EXPECT_CALL(*conn, receive(_)).WillOnce(answer());
+            EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(ReturnArg<1>());
+            EXPECT_CALL(*conn, receive(_)).WillOnce(Return(std::vector<std::uint8_t>{}));
+            EXPECT_CALL(*conn, close());
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t>> progress;
+        EXPECT_THAT(update([&progress](std::size_t sent, std::size_t total)
+                           { progress.emplace_back(sent, total); }),
+                    Eq(nullptr));
+        EXPECT_THAT(progress, ElementsAre(Pair(1, 3), Pair(2, 3), Pair(3, 3)));
+    }
+
+    TEST_F(MustangUpdaterTest, failsOnSendError)
+    {
+        writeImage(56);
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Throw(CommunicationException{"send failed"}));
+        EXPECT_CALL(*conn, close());
+
+        EXPECT_THROW(std::rethrow_exception(update()), CommunicationException);
+    }
+
+    TEST_F(MustangUpdaterTest, cancelStopsUpdate)
+    {
+        writeImage(560);
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(2).WillRepeatedly(ReturnArg<1>());
+        EXPECT_CALL(*conn, receive(_)).Times(2).WillRepeatedly(answer());
+        EXPECT_CALL(*conn, close());
+
+        std::promise<std::exception_ptr> finished;
+        MustangUpdater* self{nullptr};
+        MustangUpdater updater{[&self](std::size_t sent, std::size_t)
+                               {
+                                   if (sent == 2)
+                                   {
+                                       self->cancel();
+                                   } },
+                               [&finished](std::exception_ptr error)
+                               { finished.set_value(error); }};
+        self = &updater;
+        updater.start(filename.string(), [this]
+                      { return conn; });
+
+        EXPECT_THROW(std::rethrow_exception(finished.get_future().get()), CommunicationException);
+    }
+
+    TEST_F(MustangUpdaterTest, failsIfNoDeviceFound)
+    {
+        writeImage(56);
+        std::promise<std::exception_ptr> finished;
+        MustangUpdater updater{[](std::size_t, std::size_t) {}, [&finished](std::exception_ptr error)
+                               { finished.set_value(error); }};
+
+        updater.start(filename.string(), []() -> std::shared_ptr<Connection>
+                      { throw CommunicationException{"No device in update mode found"}; });
+
+        EXPECT_THROW(std::rethrow_exception(finished.get_future().get()), CommunicationException);
+    }
+
+    TEST_F(MustangUpdaterTest, startThrowsIfFileIsMissing)
+    {
+        MustangUpdater updater{[](std::size_t, std::size_t) {}, [](std::exception_ptr) {}};
+
+        EXPECT_THROW(updater.start(filename.string(), [this]
+                                   { return conn; }),
+                     std::system_error);
+    }
+
+    TEST_F(MustangUpdaterTest, startThrowsOnTooShortImage)
+    {
+        std::ofstream{filename, std::ios::binary} << "short";
+        MustangUpdater updater{[](std::size_t, std::size_t) {}, [](std::exception_ptr) {}};
+
+        EXPECT_THROW(updater.start(filename.string(), [this]
+                                   { return conn; }),
+                     std::invalid_argument);
+    }
+}
@@ -0,0 +1,311 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/MustangWorker.h"
+#include "com/CommunicationException.h"
+#include "com/PacketSerializer.h"
+#include "mocks/MockConnection.h"
+#include "matcher/Matcher.h"
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace plug::test::matcher;
+    using namespace testing;
+
+
+    class MustangWorkerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            conn = std::make_shared<mock::MockConnection>();
+            EXPECT_CALL(*conn, discardReceived()).Times(AnyNumber());
+            worker = std::make_unique<MustangWorker>([this](std::exception_ptr error)
+                                                     { errors.set_value(error); });
+        }
+
+        void TearDown() override
+        {
+        }
+
+        void connectWorker()
+        {
+            std::promise<void> connected;
+            worker->connect([this]
+                            { return std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, conn); },
+                            [&connected](Mustang&)
+                            { connected.set_value(); });
+            connected.get_future().wait();
+        }
+
+        // Blocks the worker until the returned promise is set
+        std::promise<void> blockWorker()
+        {
+            std::promise<void> release;
+            std::promise<void> started;
+            worker->execute([future = release.get_future().share(), &started]
+                            {
+                started.set_value();
+                future.wait(); });
+            started.get_future().wait();
+            return release;
+        }
+
+        std::shared_ptr<mock::MockConnection> conn;
+        std::promise<std::exception_ptr> errors;
+        std::unique_ptr<MustangWorker> worker;
+        const std::vector<std::uint8_t> ackData = []
+        { std::vector<std::uint8_t> d(packetRawTypeSize, 0x00); d[0] = 0x1c; d[1] = 0x01; return d; }();
+    };
+
+
+    TEST(MpscQueueTest, popReturnsValuesInOrder)
+    {
+        MpscQueue<int> queue;
+        queue.push(1);
+        queue.push(2);
+
+        EXPECT_THAT(queue.tryPop(), Optional(1));
+        EXPECT_THAT(queue.tryPop(), Optional(2));
+        EXPECT_THAT(queue.tryPop(), Eq(std::nullopt));
+    }
+
+    TEST(MpscQueueTest, pushFromMultipleThreads)
+    {
+        MpscQueue<int> queue;
+        constexpr int perThread{1000};
+        std::vector<std::thread> producers;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            producers.emplace_back([&queue]
+                                   {
+                for (int n = 0; n < perThread; ++n)
+                {
+                    queue.push(n);
+                } });
+        }
+        std::for_each(producers.begin(), producers.end(), [](auto& t)
+                      { t.join(); });
+
+        int count{0};
+        while (queue.tryPop())
+        {
+            ++count;
+        }
+        EXPECT_THAT(count, Eq(4 * perThread));
+    }
+
+    TEST_F(MustangWorkerTest, runsTasksOnWorkerThread)
+    {
+        std::promise<std::thread::id> id;
+        worker->execute([&id]
+                        { id.set_value(std::this_thread::get_id()); });
+
+        EXPECT_THAT(id.get_future().get(), Ne(std::this_thread::get_id()));
+    }
+
+    TEST_F(MustangWorkerTest, tasksRunInQueuedOrder)
+    {
+        connectWorker();
+        std::mutex mutex;
+        std::vector<int> order;
+        std::promise<void> done;
+        auto release = blockWorker();
+
+        worker->post([&](Mustang&)
+                     {
+            std::lock_guard lock{mutex};
+            order.push_back(1); });
+        worker->post([&](Mustang&)
+                     {
+            std::lock_guard lock{mutex};
+            order.push_back(2); });
+        worker->execute([&done]
+                        { done.set_value(); });
+        release.set_value();
+        done.get_future().wait();
+
+        std::lock_guard lock{mutex};
+        EXPECT_THAT(order, ElementsAre(1, 2));
+    }
+
+    TEST_F(MustangWorkerTest, updatesAreSentAfterQueuedTasks)
+    {
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                   cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                   4, 1, 5, true, 4};
+        connectWorker();
+        auto release = blockWorker();
+        bool taskDone{false};
+        bool doneBeforeUpdate{false};
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Invoke([&](const std::uint8_t*, std::size_t size)
+                                                                 {
+            doneBeforeUpdate = taskDone;
+            return size; }));
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(Return(ackData));
+
+        worker->post([&taskDone](Mustang&)
+                     { taskDone = true; });
+        worker->update(amp);
+        std::promise<void> done;
+        worker->execute([&done]
+                        { done.set_value(); });
+        release.set_value();
+        done.get_future().wait();
+
+        EXPECT_THAT(doneBeforeUpdate, IsTrue());
+    }
+
+    TEST_F(MustangWorkerTest, updatesAreSentBeforeLaterTasks)
+    {
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                   cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                   4, 1, 5, true, 4};
+        connectWorker();
+        auto release = blockWorker();
+        bool updateSent{false};
+        bool sentBeforeTask{false};
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Invoke([&updateSent](const std::uint8_t*, std::size_t size)
+                                                                 {
+            updateSent = true;
+            return size; }));
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(Return(ackData));
+
+        worker->update(amp);
+        std::promise<void> done;
+        worker->execute([&]
+                        {
+            sentBeforeTask = updateSent;
+            done.set_value(); });
+        release.set_value();
+        done.get_future().wait();
+
+        EXPECT_THAT(sentBeforeTask, IsTrue());
+    }
+
+    TEST_F(MustangWorkerTest, errorsAreReported)
+    {
+        worker->execute([]
+                        { throw CommunicationException{"failed"}; });
+
+        EXPECT_THROW(std::rethrow_exception(errors.get_future().get()), CommunicationException);
+    }
+
+    TEST_F(MustangWorkerTest, postFailsIfNotConnected)
+    {
+        worker->post([](Mustang&) {});
+
+        EXPECT_THROW(std::rethrow_exception(errors.get_future().get()), CommunicationException);
+    }
+
+    TEST_F(MustangWorkerTest, disconnectStopsDevice)
+    {
+        connectWorker();
+        EXPECT_CALL(*conn, close());
+
+        worker->disconnect();
+        worker->post([](Mustang&) {});
+
+        EXPECT_THROW(std::rethrow_exception(errors.get_future().get()), CommunicationException);
+    }
+
+    TEST_F(MustangWorkerTest, updatesAreCoalesced)
+    {
+        constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                   cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                   4, 1, 5, true, 4};
+        constexpr amp_settings ampChanged{amps::BRITISH_70S, 8, 9, 1, 2, 7,
+                                          cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                          4, 1, 5, true, 4};
+        const auto data = serializeAmpSettings(ampChanged).getBytes();
+        connectWorker();
+        auto release = blockWorker();
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(AnyNumber()).WillRepeatedly(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(Return(ackData));
+
+        worker->update(amp);
+        worker->update(ampChanged);
+        std::promise<void> done;
+        worker->execute([&done]
+                        { done.set_value(); });
+        release.set_value();
+        done.get_future().wait();
+
+        EXPECT_THAT(worker->coalescingStats().coalesced, Eq(1));
+        EXPECT_THAT(worker->coalescingStats().dropped, Eq(0));
+    }
+
+    TEST_F(MustangWorkerTest, latencyIsReportedForSentUpdates)
+    {
+        constexpr fx_pedal_settings effect{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        std::promise<TokenBucket::Clock::duration> latency;
+        worker = std::make_unique<MustangWorker>([](std::exception_ptr) {},
+                                                 [&latency](auto value)
+                                                 { latency.set_value(value); });
+        connectWorker();
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(Return(ackData));
+
+        worker->update(effect);
+
+        EXPECT_THAT(latency.get_future().get(), Gt(TokenBucket::Clock::duration::zero()));
+    }
+
+    TEST_F(MustangWorkerTest, updatesAreDroppedIfNotConnected)
+    {
+        constexpr fx_pedal_settings effect{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        std::promise<void> done;
+
+        worker->update(effect);
+        worker->execute([&done]
+                        { done.set_value(); });
+        done.get_future().wait();
+
+        EXPECT_THAT(worker->coalescingStats().dropped, Eq(1));
+    }
+
+    TEST_F(MustangWorkerTest, failedConnectReleasesDevice)
+    {
+        worker->connect([this]
+                        { return std::make_unique<Mustang>(DeviceModel{"Test Device", DeviceModel::Category::MustangV1, 100}, conn); },
+                        [](Mustang&)
+                        { throw CommunicationException{"failed"}; });
+        auto future = errors.get_future();
+        future.wait();
+
+        std::promise<std::exception_ptr> next;
+        errors = std::move(next);
+        worker->post([](Mustang&) {});
+
+        EXPECT_THROW(std::rethrow_exception(errors.get_future().get()), CommunicationException);
+    }
+}
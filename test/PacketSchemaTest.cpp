@@ -0,0 +1,154 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/Packet.h"
+#include "com/PacketSchema.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace testing;
+    using namespace plug::com;
+
+    class PacketSchemaTest : public testing::Test
+    {
+    };
+
+    TEST_F(PacketSchemaTest, layoutIsValid)
+    {
+        EXPECT_THAT(schema::isValidLayout(schema::amp::fields, payloadRawTypeSize), IsTrue());
+        EXPECT_THAT(schema::isValidLayout(std::array{schema::amp::model, schema::amp::usbGain}, payloadRawTypeSize), IsFalse());
+        EXPECT_THAT(schema::isValidLayout(std::array{schema::Field{"x", 47, 2}}, payloadRawTypeSize), IsFalse());
+        EXPECT_THAT(schema::isSingleByte(schema::name::fields), IsFalse());
+    }
+
+    TEST_F(PacketSchemaTest, accessorsUseSchemaOffsets)
+    {
+        EffectPayload payload{};
+        payload.setKnob4(0x17);
+        const auto bytes = payload.getBytes();
+
+        EXPECT_THAT(bytes[schema::effect::knob4.offset], Eq(0x17));
+        EXPECT_THAT(schema::get(bytes, schema::effect::knob4), Eq(0x17));
+    }
+
+    TEST_F(PacketSchemaTest, bulkDecodeAndEncode)
+    {
+        EffectPayload payload{};
+        payload.setModel(0x3c);
+        payload.setSlot(2);
+        payload.setKnob1(1);
+        payload.setKnob6(6);
+        const auto values = schema::decode(schema::effect::fields, payload.getBytes());
+
+        EXPECT_THAT(values, ElementsAre(0x3c, 2, 0, 0, 0, 1, 0, 0, 0, 0, 6));
+
+        PayloadBase::RawType bytes{};
+        schema::encode(schema::effect::fields, values, bytes);
+        EXPECT_THAT(bytes, ContainerEq(payload.getBytes()));
+    }
+
+    TEST_F(PacketSchemaTest, equalFields)
+    {
+        AmpPayload lhs{};
+        lhs.setGain(0x80);
+        AmpPayload rhs{lhs};
+
+        EXPECT_THAT(equalFields(lhs, rhs), IsTrue());
+        rhs.setBass(0x10);
+        EXPECT_THAT(equalFields(lhs, rhs), IsFalse());
+    }
+
+    TEST_F(PacketSchemaTest, equalFieldsIgnoresBytesOutsideSchema)
+    {
+        PayloadBase::RawType data{};
+        data[47] = 0xff;
+        AmpPayload lhs{};
+        AmpPayload rhs{};
+        rhs.fromBytes(data);
+
+        EXPECT_THAT(equalFields(lhs, rhs), IsTrue());
+        EXPECT_THAT(hashFields(lhs), Eq(hashFields(rhs)));
+    }
+
+    TEST_F(PacketSchemaTest, hashFieldsDependsOnValues)
+    {
+        EffectPayload lhs{};
+        lhs.setKnob1(1);
+        EffectPayload rhs{};
+        rhs.setKnob2(1);
+
+        EXPECT_THAT(hashFields(lhs), Ne(hashFields(rhs)));
+        EXPECT_THAT(hashFields(lhs), Eq(hashFields(EffectPayload{lhs})));
+    }
+
+    TEST_F(PacketSchemaTest, diffFields)
+    {
+        AmpPayload lhs{};
+        AmpPayload rhs{};
+        rhs.setVolume(0x11);
+        rhs.setCabinet(0x03);
+
+        const auto changed = diffFields(lhs, rhs);
+        EXPECT_THAT(changed.count(), Eq(2));
+
+        std::vector<std::string_view> names;
+        for (std::size_t i = 0; i < changed.size(); ++i)
+        {
+            if (changed[i])
+            {
+                names.push_back(AmpPayload::fields[i].name);
+            }
+        }
+        EXPECT_THAT(names, ElementsAre("volume", "cabinet"));
+    }
+
+    TEST_F(PacketSchemaTest, diffIsConstexpr)
+    {
+        constexpr std::array<std::uint8_t, 3> lhs{{1, 2, 3}};
+        constexpr std::array<std::uint8_t, 3> rhs{{1, 5, 3}};
+        constexpr std::array fields{schema::Field{"a", 0}, schema::Field{"b", 1}, schema::Field{"c", 2}};
+        constexpr auto changed = schema::diff(fields, lhs, rhs);
+        static_assert(!changed[0] && changed[1] && !changed[2]);
+    }
+
+    TEST_F(PacketSchemaTest, fieldAccessByField)
+    {
+        AmpPayload payload{};
+        payload.set<schema::amp::volume>(0x21);
+
+        EXPECT_THAT(payload.get<schema::amp::volume>(), Eq(0x21));
+        EXPECT_THAT(payload.getVolume(), Eq(0x21));
+    }
+
+    TEST_F(PacketSchemaTest, viewsAndOwningTypesAgree)
+    {
+        Header header{};
+        header.setDSP(DSP::effect2);
+        EffectPayload payload{};
+        payload.setKnob3(0x33);
+        const auto data = Packet<EffectPayload>{header, payload}.getBytes();
+        const PacketView<EffectPayload> view{data};
+
+        EXPECT_THAT(hashFields(view.getPayload()), Eq(hashFields(payload)));
+        EXPECT_THAT(hashFields(view.getHeader()), Eq(hashFields(header)));
+        EXPECT_THAT(equalFields(view.getPayload(), PacketView<EffectPayload>{data}.getPayload()), IsTrue());
+    }
+}
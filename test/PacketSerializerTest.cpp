@@ -21,6 +21,7 @@
 #include "com/PacketSerializer.h"
 #include "data_structs.h"
 #include "matcher/PacketMatcher.h"
+#include "matcher/TypeMatcher.h"
 #include "helper/MustangConstants.h"
 #include <gmock/gmock.h>
 
@@ -1152,4 +1153,40 @@ namespace plug::test
         EXPECT_THAT(result[3].slot.id(), Eq(7));
         EXPECT_THAT(result[3].slot.isFxLoop(), IsTrue());
     }
+
+    TEST_F(PacketSerializerTest, serializeInPlaceOverwritesPacket)
+    {
+        const amp_settings amp{amps::METAL_2000, 11, 22, 33, 44, 55, cabinets::cab2x12C, 1, 2, 3, 4, 5, 6, 7, 8, true, 0x44};
+        const fx_pedal_settings effect{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        PacketRawType data{};
+        data.fill(0xff);
+
+        serializeAmpSettings(amp, PacketSpan<AmpPayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeAmpSettings(amp).getBytes()));
+        serializeAmpSettingsUsbGain(amp, PacketSpan<AmpPayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeAmpSettingsUsbGain(amp).getBytes()));
+        serializeEffectSettings(effect, PacketSpan<EffectPayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeEffectSettings(effect).getBytes()));
+        serializeClearEffectSettings(effect, PacketSpan<EffectPayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeClearEffectSettings(effect).getBytes()));
+        serializeName(3, "abc", PacketSpan<NamePayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeName(3, "abc").getBytes()));
+        serializeApplyCommand(PacketSpan<EmptyPayload>{data});
+        EXPECT_THAT(data, ContainerEq(serializeApplyCommand().getBytes()));
+    }
+
+    TEST_F(PacketSerializerTest, decodeFromViewMatchesPacket)
+    {
+        const amp_settings amp{amps::METAL_2000, 11, 22, 33, 44, 55, cabinets::cab2x12C, 1, 2, 3, 4, 5, 6, 7, 8, true, 0x44};
+        const fx_pedal_settings effect{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const auto ampData = serializeAmpSettings(amp).getBytes();
+        const auto usbGainData = serializeAmpSettingsUsbGain(amp).getBytes();
+        const auto effectData = serializeEffectSettings(effect).getBytes();
+        const auto nameData = serializeName(3, "abc").getBytes();
+
+        EXPECT_THAT(decodeAmpFromData(PacketView<AmpPayload>{ampData}, PacketView<AmpPayload>{usbGainData}),
+                    matcher::AmpIs(decodeAmpFromData(fromRawData<AmpPayload>(ampData), fromRawData<AmpPayload>(usbGainData))));
+        EXPECT_THAT(decodeEffectFromData(PacketView<EffectPayload>{effectData}), matcher::EffectIs(decodeEffectFromData(fromRawData<EffectPayload>(effectData))));
+        EXPECT_THAT(decodeNameFromData(PacketView<NamePayload>{nameData}), Eq("abc"));
+    }
 }
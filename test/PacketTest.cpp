@@ -118,6 +118,13 @@ namespace plug::test
         EXPECT_THAT(h.getBytes()[7], Eq(0x03));
     }
 
+    TEST_F(PacketTest, headerGetUnknown)
+    {
+        Header h{};
+        h.setUnknown(0x02, 0x01, 0x03);
+        EXPECT_THAT(h.getUnknown(), ElementsAre(0x02, 0x01, 0x03));
+    }
+
     TEST_F(PacketTest, headerStage)
     {
         Header h{};
@@ -601,4 +608,77 @@ namespace plug::test
 
         EXPECT_THAT(p.getUsbGain(), Eq(0x12));
     }
+
+    TEST_F(PacketTest, packetViewReadsInPlace)
+    {
+        std::array<std::uint8_t, 64> data{{}};
+        data[0] = 0x1c;
+        data[1] = 0x03;
+        data[2] = 0x06;
+        data[4] = 0x02;
+        data[16] = 0x42;
+        data[18] = 0x03;
+        data[32] = 0x09;
+
+        const PacketView<EffectPayload> view{data};
+        EXPECT_THAT(view.getHeader().getStage(), Eq(Stage::ready));
+        EXPECT_THAT(view.getHeader().getType(), Eq(Type::data));
+        EXPECT_THAT(view.getHeader().getDSP(), Eq(DSP::effect0));
+        EXPECT_THAT(view.getHeader().getSlot(), Eq(0x02));
+        EXPECT_THAT(view.getPayload().getModel(), Eq(0x42));
+        EXPECT_THAT(view.getPayload().getSlot(), Eq(0x03));
+        EXPECT_THAT(view.getPayload().getKnob1(), Eq(0x09));
+
+        data[32] = 0x0a;
+        EXPECT_THAT(view.getPayload().getKnob1(), Eq(0x0a));
+    }
+
+    TEST_F(PacketTest, packetViewMatchesPacket)
+    {
+        Header h{};
+        h.setStage(Stage::ready);
+        h.setType(Type::operation);
+        h.setDSP(DSP::amp);
+        h.setSlot(7);
+        AmpPayload pl{};
+        pl.setGain(0x80);
+        pl.setUsbGain(0x11);
+        const auto data = Packet<AmpPayload>{h, pl}.getBytes();
+
+        const PacketView<AmpPayload> view{data};
+        EXPECT_THAT(view.getHeader().getDSP(), Eq(DSP::amp));
+        EXPECT_THAT(view.getHeader().getType(), Eq(Type::operation));
+        EXPECT_THAT(view.getHeader().getSlot(), Eq(7));
+        EXPECT_THAT(view.getPayload().getGain(), Eq(0x80));
+        EXPECT_THAT(view.getPayload().getUsbGain(), Eq(0x11));
+    }
+
+    TEST_F(PacketTest, packetSpanWritesInPlace)
+    {
+        std::array<std::uint8_t, 64> data{{}};
+        const PacketSpan<NamePayload> span{data};
+        auto header = span.getHeader();
+        header.setStage(Stage::ready);
+        header.setDSP(DSP::opSave);
+        header.setSlot(5);
+        auto payload = span.getPayload();
+        payload.setName("abc");
+
+        Header expectedHeader{};
+        expectedHeader.setStage(Stage::ready);
+        expectedHeader.setDSP(DSP::opSave);
+        expectedHeader.setSlot(5);
+        NamePayload expectedPayload{};
+        expectedPayload.setName("abc");
+        EXPECT_THAT(data, ContainerEq(Packet<NamePayload>{expectedHeader, expectedPayload}.getBytes()));
+    }
+
+    TEST_F(PacketTest, packetSpanClear)
+    {
+        std::array<std::uint8_t, 64> data{};
+        data.fill(0xff);
+
+        PacketSpan<EmptyPayload>{data}.clear();
+        EXPECT_THAT(data, Each(Eq(0x00)));
+    }
 }
@@ -0,0 +1,100 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/PresetCache.h"
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class PresetCacheTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+        }
+
+        void TearDown() override
+        {
+        }
+
+        static constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                          cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                          4, 1, 5, true, 4};
+        const SignalChain chain{"abc", amp, {fx_pedal_settings{FxSlot{0}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3}}};
+    };
+
+
+    TEST_F(PresetCacheTest, emptyInitially)
+    {
+        PresetCache cache{3};
+
+        EXPECT_THAT(cache.size(), Eq(3));
+        EXPECT_THAT(cache.get(1), Eq(std::nullopt));
+        EXPECT_THAT(cache.contains(0), IsFalse());
+    }
+
+    TEST_F(PresetCacheTest, putStoresSignalChain)
+    {
+        PresetCache cache{3};
+
+        cache.put(1, chain);
+
+        EXPECT_THAT(cache.contains(1), IsTrue());
+        EXPECT_THAT(cache.get(1)->name(), StrEq("abc"));
+        EXPECT_THAT(cache.contains(0), IsFalse());
+        EXPECT_THAT(cache.contains(2), IsFalse());
+    }
+
+    TEST_F(PresetCacheTest, putIgnoresSlotOutOfRange)
+    {
+        PresetCache cache{3};
+
+        cache.put(3, chain);
+
+        EXPECT_THAT(cache.get(3), Eq(std::nullopt));
+        EXPECT_THAT(cache.contains(3), IsFalse());
+    }
+
+    TEST_F(PresetCacheTest, invalidateRemovesEntry)
+    {
+        PresetCache cache{3};
+        cache.put(2, chain);
+
+        cache.invalidate(2);
+
+        EXPECT_THAT(cache.contains(2), IsFalse());
+    }
+
+    TEST_F(PresetCacheTest, resetClearsAllEntries)
+    {
+        PresetCache cache{3};
+        cache.put(0, chain);
+
+        cache.reset(5);
+
+        EXPECT_THAT(cache.size(), Eq(5));
+        EXPECT_THAT(cache.contains(0), IsFalse());
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/StateCache.h"
+#include <filesystem>
+#include <sstream>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+
+    class StateCacheTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory = std::filesystem::temp_directory_path() / ("plug-state-cache-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+            std::filesystem::remove_all(directory);
+        }
+
+        void TearDown() override
+        {
+            std::filesystem::remove_all(directory);
+        }
+
+        CachedState createState() const
+        {
+            CachedState state{};
+            state.presetNames = {"first", "second", ""};
+            state.signalChain = chain;
+            state.banks = {chain, std::nullopt, SignalChain{"other", amp, {}}};
+            state.effectPresets = {EffectPreset{EffectKnob::dlyRev, 2, "echo", {fx_pedal_settings{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6}}}};
+            return state;
+        }
+
+        static std::string write(const CachedState& state, const std::string& key)
+        {
+            std::ostringstream stream;
+            writeStateCache(stream, key, state);
+            return stream.str();
+        }
+
+        static std::optional<CachedState> read(const std::string& data, const std::string& key)
+        {
+            std::istringstream stream{data};
+            return readStateCache(stream, key);
+        }
+
+        static constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                          cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                          4, 1, 5, true, 4};
+        const SignalChain chain{"abc", amp, {fx_pedal_settings{FxSlot{0}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3},
+                                             fx_pedal_settings{FxSlot{5}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 6, false}}};
+        std::filesystem::path directory;
+    };
+
+
+    TEST_F(StateCacheTest, readReturnsWrittenState)
+    {
+        const auto result = read(write(createState(), "key"), "key");
+
+        ASSERT_THAT(result.has_value(), IsTrue());
+        EXPECT_THAT(result->presetNames, ElementsAre("first", "second", ""));
+        EXPECT_THAT(result->signalChain.name(), StrEq("abc"));
+        EXPECT_THAT(result->signalChain.amp().amp_num, Eq(amps::BRITISH_70S));
+        EXPECT_THAT(result->signalChain.amp().cabinet, Eq(cabinets::cab4x12G));
+        EXPECT_THAT(result->signalChain.amp().gain, Eq(8));
+        EXPECT_THAT(result->signalChain.amp().sag, Eq(5));
+        EXPECT_THAT(result->signalChain.amp().brightness, IsTrue());
+        EXPECT_THAT(result->signalChain.amp().usb_gain, Eq(4));
+
+        const auto fx = result->signalChain.effects();
+        ASSERT_THAT(fx.size(), Eq(2));
+        EXPECT_THAT(fx[0].slot.id(), Eq(0));
+        EXPECT_THAT(fx[0].effect_num, Eq(effects::OVERDRIVE));
+        EXPECT_THAT(fx[0].knob1, Eq(8));
+        EXPECT_THAT(fx[0].knob6, Eq(3));
+        EXPECT_THAT(fx[1].slot.id(), Eq(5));
+        EXPECT_THAT(fx[1].effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(fx[1].enabled, IsFalse());
+    }
+
+    TEST_F(StateCacheTest, readReturnsWrittenBanksAndEffectPresets)
+    {
+        const auto result = read(write(createState(), "key"), "key");
+
+        ASSERT_THAT(result.has_value(), IsTrue());
+        ASSERT_THAT(result->banks.size(), Eq(3));
+        EXPECT_THAT(result->banks[0]->name(), StrEq("abc"));
+        EXPECT_THAT(result->banks[1], Eq(std::nullopt));
+        EXPECT_THAT(result->banks[2]->name(), StrEq("other"));
+        EXPECT_THAT(result->banks[2]->effects(), IsEmpty());
+
+        ASSERT_THAT(result->effectPresets.size(), Eq(1));
+        EXPECT_THAT(result->effectPresets[0].knob, Eq(EffectKnob::dlyRev));
+        EXPECT_THAT(result->effectPresets[0].slot, Eq(2));
+        EXPECT_THAT(result->effectPresets[0].name, StrEq("echo"));
+        ASSERT_THAT(result->effectPresets[0].effects.size(), Eq(1));
+        EXPECT_THAT(result->effectPresets[0].effects[0].effect_num, Eq(effects::TAPE_DELAY));
+    }
+
+    TEST_F(StateCacheTest, readIgnoresCacheOfOtherDevice)
+    {
+        EXPECT_THAT(read(write(createState(), "key"), "other key"), Eq(std::nullopt));
+    }
+
+    TEST_F(StateCacheTest, readIgnoresInvalidData)
+    {
+        EXPECT_THAT(read("", "key"), Eq(std::nullopt));
+        EXPECT_THAT(read("not a cache file", "key"), Eq(std::nullopt));
+    }
+
+    TEST_F(StateCacheTest, readIgnoresTruncatedData)
+    {
+        const auto data = write(createState(), "key");
+
+        EXPECT_THAT(read(data.substr(0, data.size() - 1), "key"), Eq(std::nullopt));
+        EXPECT_THAT(read(data.substr(0, data.size() / 2), "key"), Eq(std::nullopt));
+    }
+
+    TEST_F(StateCacheTest, readIgnoresInvalidIds)
+    {
+        CachedState state{};
+        state.signalChain = chain;
+        auto data = write(state, "k");
+
+        constexpr std::size_t ampIdPosition{4 + 1 + 3 + 2 + 2 + 3};
+        ASSERT_THAT(data[ampIdPosition], Eq(static_cast<char>(value(amps::BRITISH_70S))));
+        data[ampIdPosition] = static_cast<char>(0xff);
+
+        EXPECT_THAT(read(data, "k"), Eq(std::nullopt));
+    }
+
+    TEST_F(StateCacheTest, keyDependsOnModelAndDevice)
+    {
+        const DeviceModel v1{"Mustang I/II", DeviceModel::Category::MustangV1, 24};
+        const DeviceModel v2{"Mustang I/II", DeviceModel::Category::MustangV2, 24};
+
+        EXPECT_THAT(stateCacheKey(v1, "Mustang Amplifier", "A1B2"), StrEq("Mustang_I_II_v1_Mustang_Amplifier_A1B2"));
+        EXPECT_THAT(stateCacheKey(v2, "Mustang Amplifier", "A1B2"), Ne(stateCacheKey(v1, "Mustang Amplifier", "A1B2")));
+        EXPECT_THAT(stateCacheKey(v1, "Other", "A1B2"), Ne(stateCacheKey(v1, "Mustang Amplifier", "A1B2")));
+    }
+
+    TEST_F(StateCacheTest, keyKeepsAmpsOfSameModelApart)
+    {
+        const DeviceModel v1{"Mustang I/II", DeviceModel::Category::MustangV1, 24};
+
+        EXPECT_THAT(stateCacheKey(v1, "Mustang Amplifier", "1-2.4"), Ne(stateCacheKey(v1, "Mustang Amplifier", "1-3")));
+    }
+
+    TEST_F(StateCacheTest, loadReturnsSavedState)
+    {
+        saveStateCache(directory, "key", createState());
+
+        const auto result = loadStateCache(directory, "key");
+        ASSERT_THAT(result.has_value(), IsTrue());
+        EXPECT_THAT(result->presetNames, ElementsAre("first", "second", ""));
+        EXPECT_THAT(loadStateCache(directory, "other"), Eq(std::nullopt));
+    }
+
+    TEST_F(StateCacheTest, saveReplacesPreviousState)
+    {
+        saveStateCache(directory, "key", createState());
+        CachedState state{};
+        state.presetNames = {"new"};
+        saveStateCache(directory, "key", state);
+
+        const auto result = loadStateCache(directory, "key");
+        ASSERT_THAT(result.has_value(), IsTrue());
+        EXPECT_THAT(result->presetNames, ElementsAre("new"));
+    }
+
+    TEST_F(StateCacheTest, loadWithoutCacheFile)
+    {
+        EXPECT_THAT(loadStateCache(directory, "key"), Eq(std::nullopt));
+    }
+}
@@ -0,0 +1,167 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2024  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/UpdateCoalescer.h"
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+    using namespace std::chrono_literals;
+
+
+    class UpdateCoalescerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+        }
+
+        void TearDown() override
+        {
+        }
+
+        static constexpr amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3,
+                                          cabinets::cab4x12G, 3, 5, 3, 2, 1,
+                                          4, 1, 5, true, 4};
+        static constexpr fx_pedal_settings effect{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        const TokenBucket::Clock::time_point start{};
+    };
+
+
+    TEST_F(UpdateCoalescerTest, takeReturnsNothingInitially)
+    {
+        UpdateCoalescer coalescer;
+
+        const auto updates = coalescer.take();
+        EXPECT_THAT(updates.size(), Eq(0));
+    }
+
+    TEST_F(UpdateCoalescerTest, pushReportsIfNothingWasPending)
+    {
+        UpdateCoalescer coalescer;
+
+        EXPECT_THAT(coalescer.push(amp), IsTrue());
+        EXPECT_THAT(coalescer.push(effect), IsFalse());
+        coalescer.take();
+        EXPECT_THAT(coalescer.push(effect), IsTrue());
+    }
+
+    TEST_F(UpdateCoalescerTest, latestValueWins)
+    {
+        UpdateCoalescer coalescer;
+        auto ampChanged = amp;
+        ampChanged.gain = 99;
+        auto effectChanged = effect;
+        effectChanged.knob1 = 1;
+
+        coalescer.push(amp);
+        coalescer.push(effect);
+        coalescer.push(ampChanged);
+        coalescer.push(effectChanged);
+        const auto updates = coalescer.take();
+
+        EXPECT_THAT(updates.amp->gain, Eq(99));
+        ASSERT_THAT(updates.effects.size(), Eq(1));
+        EXPECT_THAT(updates.effects[0].knob1, Eq(1));
+        EXPECT_THAT(coalescer.stats().coalesced, Eq(2));
+    }
+
+    TEST_F(UpdateCoalescerTest, effectsAreKeptPerDsp)
+    {
+        UpdateCoalescer coalescer;
+        constexpr fx_pedal_settings other{FxSlot{5}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 6};
+
+        coalescer.push(effect);
+        coalescer.push(other);
+        const auto updates = coalescer.take();
+
+        EXPECT_THAT(updates.effects.size(), Eq(2));
+        EXPECT_THAT(coalescer.stats().coalesced, Eq(0));
+    }
+
+    TEST_F(UpdateCoalescerTest, effectMovedToOtherSlotReplacesUpdateOfItsDsp)
+    {
+        UpdateCoalescer coalescer;
+        constexpr fx_pedal_settings moved{FxSlot{1}, effects::FUZZ, 1, 2, 3, 4, 5, 6};
+
+        coalescer.push(effect);
+        coalescer.push(moved);
+        const auto updates = coalescer.take();
+
+        ASSERT_THAT(updates.effects.size(), Eq(1));
+        EXPECT_THAT(updates.effects[0].slot.id(), Eq(1));
+        EXPECT_THAT(updates.effects[0].effect_num, Eq(effects::FUZZ));
+        EXPECT_THAT(coalescer.stats().coalesced, Eq(1));
+    }
+
+    TEST_F(UpdateCoalescerTest, emptyEffectReplacesUpdatesOfItsSlot)
+    {
+        UpdateCoalescer coalescer;
+        constexpr fx_pedal_settings empty{FxSlot{3}, effects::EMPTY, 0, 0, 0, 0, 0, 0};
+        constexpr fx_pedal_settings other{FxSlot{3}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 6};
+
+        coalescer.push(effect);
+        coalescer.push(empty);
+        coalescer.push(other);
+        const auto updates = coalescer.take();
+
+        ASSERT_THAT(updates.effects.size(), Eq(2));
+        EXPECT_THAT(updates.effects[0].effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(updates.effects[1].effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(coalescer.stats().coalesced, Eq(1));
+    }
+
+    TEST_F(UpdateCoalescerTest, dropCountsUpdates)
+    {
+        UpdateCoalescer coalescer;
+        coalescer.drop(3);
+        EXPECT_THAT(coalescer.stats().dropped, Eq(3));
+    }
+
+    TEST_F(UpdateCoalescerTest, tokenBucketAllowsBurst)
+    {
+        TokenBucket bucket{2, 10ms, start};
+
+        EXPECT_THAT(bucket.tryConsume(start), IsTrue());
+        EXPECT_THAT(bucket.tryConsume(start), IsTrue());
+        EXPECT_THAT(bucket.tryConsume(start), IsFalse());
+    }
+
+    TEST_F(UpdateCoalescerTest, tokenBucketRefillsOverTime)
+    {
+        TokenBucket bucket{1, 10ms, start};
+        bucket.tryConsume(start);
+
+        EXPECT_THAT(bucket.waitTime(start + 4ms), Eq(6ms));
+        EXPECT_THAT(bucket.tryConsume(start + 5ms), IsFalse());
+        EXPECT_THAT(bucket.tryConsume(start + 10ms), IsTrue());
+    }
+
+    TEST_F(UpdateCoalescerTest, tokenBucketIsLimitedToCapacity)
+    {
+        TokenBucket bucket{1, 10ms, start};
+
+        EXPECT_THAT(bucket.tryConsume(start + 100ms), IsTrue());
+        EXPECT_THAT(bucket.tryConsume(start + 100ms), IsFalse());
+    }
+}
@@ -28,7 +28,12 @@
 namespace plug::test
 {
     using plug::com::UsbComm;
+    using plug::com::CommunicationException;
+    using plug::com::PacketRawType;
+    using plug::com::packetRawTypeSize;
     using plug::com::usb::Device;
+    using plug::com::usb::PendingWrite;
+    using plug::com::usb::ReceiveHandler;
     using namespace plug::test::matcher;
     using namespace testing;
 
@@ -47,7 +52,12 @@ namespace plug::test
 
         UsbComm create() const
         {
-            return UsbComm{Device{nullptr}};
+            return UsbComm{Device{nullptr, nullptr}};
+        }
+
+        static PendingWrite completed(std::size_t value)
+        {
+            return PendingWrite{value};
         }
 
         mock::UsbDeviceMock* deviceMock{nullptr};
@@ -56,14 +66,29 @@ namespace plug::test
     TEST_F(UsbCommTest, ctorOpensDevice)
     {
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
-        UsbComm com{Device{nullptr}};
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+        UsbComm com{Device{nullptr, nullptr}};
+    }
+
+    TEST_F(UsbCommTest, ctorStartsReceiving)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(0x81, 64, _));
+        UsbComm com{Device{nullptr, nullptr}};
+    }
+
+    TEST_F(UsbCommTest, ctorDoesNotReadName)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+        EXPECT_CALL(*deviceMock, name()).Times(0);
+        UsbComm com{Device{nullptr, nullptr}};
     }
 
     TEST_F(UsbCommTest, closeClosesDevice)
     {
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
         EXPECT_CALL(*deviceMock, close());
 
         UsbComm com = create();
@@ -73,7 +98,7 @@ namespace plug::test
     TEST_F(UsbCommTest, isOpenReturnDeviceState)
     {
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
 
         UsbComm com = create();
         EXPECT_CALL(*deviceMock, isOpen()).WillOnce(Return(false));
@@ -85,36 +110,183 @@ namespace plug::test
     TEST_F(UsbCommTest, sendSendsData)
     {
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
 
         const std::array<std::uint8_t, 4> data{{0x00, 0xa1, 0xb2, 0xb3}};
-        EXPECT_CALL(*deviceMock, write(0x01, BufferIs(data), data.size())).WillOnce(Return(data.size()));
+        EXPECT_CALL(*deviceMock, writeAsync(0x01, ElementsAreArray(data))).WillOnce(Return(ByMove(completed(data.size()))));
 
         UsbComm com = create();
         const auto n = com.send(data);
         EXPECT_THAT(n, Eq(4));
     }
 
+    TEST_F(UsbCommTest, sendThrowsOnTransferError)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+
+        const std::array<std::uint8_t, 4> data{{0x00, 0xa1, 0xb2, 0xb3}};
+        EXPECT_CALL(*deviceMock, writeAsync(_, _)).WillOnce(Invoke([](auto, auto)
+                                                                   { return PendingWrite{std::make_exception_ptr(std::runtime_error{"transfer failed"})}; }));
+
+        UsbComm com = create();
+        EXPECT_THROW(com.send(data), std::runtime_error);
+    }
+
     TEST_F(UsbCommTest, receiveReceivesData)
     {
+        ReceiveHandler handler;
         EXPECT_CALL(*deviceMock, open());
-        EXPECT_CALL(*deviceMock, name());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _)).WillOnce(SaveArg<2>(&handler));
 
-        std::vector<std::uint8_t> data{{0x00, 0xa1, 0xb2, 0xb3, 0xc4}};
-        EXPECT_CALL(*deviceMock, receive(0x81, data.size())).WillOnce(Return(data));
+        const std::array<std::uint8_t, 5> data{{0x00, 0xa1, 0xb2, 0xb3, 0xc4}};
 
         UsbComm com = create();
-        const auto received = com.receive(data.size());
+        handler(data, nullptr);
+        std::array<std::uint8_t, 5> received{};
+        EXPECT_THAT(com.receiveInto(received), Eq(data.size()));
         EXPECT_THAT(received, Eq(data));
     }
 
+    TEST_F(UsbCommTest, receiveReturnsZeroAfterReceiveTimeout)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+
+        UsbComm com{Device{nullptr, nullptr}, std::chrono::milliseconds{10}};
+        PacketRawType received{};
+        EXPECT_THAT(com.receiveInto(received), Eq(0));
+    }
+
+    TEST_F(UsbCommTest, setReceiveTimeoutChangesTimeout)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+
+        UsbComm com{Device{nullptr, nullptr}, std::chrono::hours{1}};
+        com.setReceiveTimeout(std::chrono::milliseconds{10});
+        PacketRawType received{};
+        EXPECT_THAT(com.receiveInto(received), Eq(0));
+    }
+
+    TEST_F(UsbCommTest, receiveReturnsPacketsInOrder)
+    {
+        ReceiveHandler handler;
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _)).WillOnce(SaveArg<2>(&handler));
+
+        const std::vector<std::uint8_t> first{{0x01, 0x02}};
+        const std::vector<std::uint8_t> second{{0x03, 0x04, 0x05}};
+
+        UsbComm com = create();
+        handler(first, nullptr);
+        handler(second, nullptr);
+        PacketRawType received{};
+        EXPECT_THAT(com.receiveInto(received), Eq(2));
+        EXPECT_THAT(received[0], Eq(0x01));
+        EXPECT_THAT(received[1], Eq(0x02));
+        EXPECT_THAT(com.receiveInto(std::span{received}.first(2)), Eq(2));
+        EXPECT_THAT(received[0], Eq(0x03));
+        EXPECT_THAT(received[1], Eq(0x04));
+    }
+
+    TEST_F(UsbCommTest, receiveThrowsOnTransferError)
+    {
+        ReceiveHandler handler;
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _)).WillOnce(SaveArg<2>(&handler));
+
+        UsbComm com = create();
+        handler({}, std::make_exception_ptr(std::runtime_error{"transfer failed"}));
+        PacketRawType received{};
+        EXPECT_THROW(com.receiveInto(received), std::runtime_error);
+    }
+
+    TEST_F(UsbCommTest, receiveThrowsOnQueueOverflow)
+    {
+        ReceiveHandler handler;
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _)).WillOnce(SaveArg<2>(&handler));
+
+        const std::array<std::uint8_t, 2> data{{0x01, 0x02}};
+
+        UsbComm com = create();
+        for (std::size_t i = 0; i < 513; ++i)
+        {
+            handler(data, nullptr);
+        }
+        PacketRawType received{};
+        EXPECT_THROW(com.receiveInto(received), CommunicationException);
+        EXPECT_THAT(com.receiveInto(received), Eq(data.size()));
+    }
+
+    TEST_F(UsbCommTest, discardReceivedDropsQueuedPackets)
+    {
+        ReceiveHandler handler;
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _)).WillOnce(SaveArg<2>(&handler));
+
+        const std::vector<std::uint8_t> stale{{0x01, 0x02}};
+        const std::vector<std::uint8_t> answer{{0x03, 0x04, 0x05}};
+
+        UsbComm com = create();
+        handler(stale, nullptr);
+        com.discardReceived();
+        handler(answer, nullptr);
+        PacketRawType received{};
+        EXPECT_THAT(com.receiveInto(received), Eq(3));
+        EXPECT_THAT(received[0], Eq(0x03));
+    }
+
+    TEST_F(UsbCommTest, sendBatchSendsAllPackets)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+
+        std::array<PacketRawType, 3> packets{};
+        packets[0][0] = 0xa0;
+        packets[1][0] = 0xa1;
+        packets[2][0] = 0xa2;
+
+        InSequence s;
+        EXPECT_CALL(*deviceMock, writeAsync(0x01, ElementsAreArray(packets[0]))).WillOnce(Return(ByMove(completed(packetRawTypeSize))));
+        EXPECT_CALL(*deviceMock, writeAsync(0x01, ElementsAreArray(packets[1]))).WillOnce(Return(ByMove(completed(packetRawTypeSize))));
+        EXPECT_CALL(*deviceMock, writeAsync(0x01, ElementsAreArray(packets[2]))).WillOnce(Return(ByMove(completed(packetRawTypeSize))));
+
+        UsbComm com = create();
+        EXPECT_THAT(com.sendBatch(packets), Eq(3 * packetRawTypeSize));
+    }
+
     TEST_F(UsbCommTest, modelName)
     {
         EXPECT_CALL(*deviceMock, open());
         EXPECT_CALL(*deviceMock, name()).WillOnce(Return("USB Device Name"));
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
 
         UsbComm com = create();
         EXPECT_THAT(com.name(), Eq("USB Device Name"));
     }
 
+    TEST_F(UsbCommTest, identityIsSerialNumber)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+        EXPECT_CALL(*deviceMock, serialNumber()).WillOnce(Return("A1B2C3"));
+        EXPECT_CALL(*deviceMock, location()).Times(0);
+
+        UsbComm com = create();
+        EXPECT_THAT(com.identity(), Eq("A1B2C3"));
+    }
+
+    TEST_F(UsbCommTest, identityIsLocationIfNoSerialNumber)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, startReceiving(_, _, _));
+        EXPECT_CALL(*deviceMock, serialNumber()).WillOnce(Return(""));
+        EXPECT_CALL(*deviceMock, location()).WillOnce(Return("1-2.4"));
+
+        UsbComm com = create();
+        EXPECT_THAT(com.identity(), Eq("1-2.4"));
+    }
+
 }
@@ -20,8 +20,14 @@
 
 #include "com/UsbContext.h"
 #include "com/UsbException.h"
+#include "com/UsbHotplug.h"
+#include "com/UsbTransport.h"
 #include "mocks/LibUsbMocks.h"
+#include <algorithm>
 #include <array>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <libusb-1.0/libusb.h>
 #include <gmock/gmock.h>
 
@@ -50,35 +56,89 @@ namespace plug::test
             mock::clearUsbMock();
         }
 
+        // Cancelled transfers complete on the event thread, as with libusb
+        void expectEventHandling()
+        {
+            EXPECT_CALL(*usbmock, handle_events_timeout_completed(context, NotNull(), _))
+                .WillRepeatedly(InvokeWithoutArgs([this]
+                                                  {
+                                                      std::vector<libusb_transfer*> done;
+                                                      {
+                                                          std::lock_guard lock{cancelledMutex};
+                                                          done.swap(cancelled);
+                                                      }
+                                                      std::for_each(done.begin(), done.end(), [](auto* t)
+                                                                    { complete(t, LIBUSB_TRANSFER_CANCELLED, 0); });
+                                                      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                                                      return LIBUSB_SUCCESS; }));
+        }
+
+        auto cancelTransfer()
+        {
+            return Invoke([this](libusb_transfer* t)
+                          {
+                              std::lock_guard lock{cancelledMutex};
+                              cancelled.push_back(t);
+                              return LIBUSB_SUCCESS; });
+        }
+
+        static void complete(libusb_transfer* transfer, libusb_transfer_status status, int length)
+        {
+            transfer->status = status;
+            transfer->actual_length = length;
+            transfer->callback(transfer);
+        }
+
         mock::UsbMock* usbmock{nullptr};
+        std::mutex cancelledMutex;
+        std::vector<libusb_transfer*> cancelled;
+        libusb_context ctx;
+        libusb_context* context{&ctx};
         libusb_device dev;
         libusb_device_handle dummy;
         libusb_device_handle* handle{&dummy};
     };
 
-    TEST_F(UsbTest, contextCtorInitializesDefaultContext)
+    TEST_F(UsbTest, contextCtorInitializesOwnContext)
     {
-        EXPECT_CALL(*usbmock, init(nullptr)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, init(NotNull())).WillOnce(DoAll(SetArgPointee<0>(context), Return(LIBUSB_SUCCESS)));
         EXPECT_CALL(*usbmock, exit(_));
 
-        Context context;
+        const Context usbContext;
+        EXPECT_THAT(usbContext.get(), Eq(context));
     }
 
     TEST_F(UsbTest, contextCtorThrowsOnInitError)
     {
-        EXPECT_CALL(*usbmock, init(nullptr)).WillOnce(Return(LIBUSB_ERROR_OTHER));
+        EXPECT_CALL(*usbmock, init(NotNull())).WillOnce(Return(LIBUSB_ERROR_OTHER));
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_OTHER)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_OTHER)).WillOnce(Return("ignore_message"));
 
         EXPECT_THROW(Context{}, UsbException);
     }
 
-    TEST_F(UsbTest, contextDtorDeinitializesDefaultContext)
+    TEST_F(UsbTest, contextDtorDeinitializesOwnContext)
     {
-        EXPECT_CALL(*usbmock, init(_)).WillOnce(Return(LIBUSB_SUCCESS));
-        EXPECT_CALL(*usbmock, exit(nullptr));
+        EXPECT_CALL(*usbmock, init(_)).WillOnce(DoAll(SetArgPointee<0>(context), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, exit(context));
 
-        Context ctx{};
+        Context usbContext{};
+    }
+
+    TEST_F(UsbTest, contextsAreIndependent)
+    {
+        libusb_context other;
+        EXPECT_CALL(*usbmock, init(_))
+            .WillOnce(DoAll(SetArgPointee<0>(context), Return(LIBUSB_SUCCESS)))
+            .WillOnce(DoAll(SetArgPointee<0>(&other), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, exit(context));
+
+        Context first{};
+        {
+            EXPECT_CALL(*usbmock, exit(&other));
+            Context second{};
+            EXPECT_THAT(second.get(), Ne(first.get()));
+        }
     }
 
     TEST_F(UsbTest, exceptionContainsErrorInformation)
@@ -95,10 +155,10 @@ namespace plug::test
 
     TEST_F(UsbTest, listDevicesEmptyIfNoDevices)
     {
-        EXPECT_CALL(*usbmock, get_device_list(nullptr, _)).WillOnce(Return(0));
+        EXPECT_CALL(*usbmock, get_device_list(context, _)).WillOnce(Return(0));
         EXPECT_CALL(*usbmock, free_device_list(_, _));
 
-        const auto devices = listDevices();
+        const auto devices = listDevices(context);
         EXPECT_THAT(devices, SizeIs(0));
     }
 
@@ -108,7 +168,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, strerror(_)).WillOnce(Return("ignore_message"));
 
         EXPECT_CALL(*usbmock, get_device_list(_, _)).WillOnce(Return(LIBUSB_ERROR_OTHER));
-        EXPECT_THROW(listDevices(), UsbException);
+        EXPECT_THROW(listDevices(context), UsbException);
     }
 
     TEST_F(UsbTest, listDevicesReturnsDevices)
@@ -118,7 +178,7 @@ namespace plug::test
         libusb_device device0;
         libusb_device device1;
         std::array<libusb_device*, 2> deviceList{&device0, &device1};
-        EXPECT_CALL(*usbmock, get_device_list(nullptr, NotNull()))
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
             .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()),
                             Return(deviceList.size())));
         libusb_device_descriptor descr0{};
@@ -132,7 +192,7 @@ namespace plug::test
             .WillOnce(DoAll(SetArgPointee<1>(descr1), Return(LIBUSB_SUCCESS)));
         EXPECT_CALL(*usbmock, free_device_list(_, _));
 
-        const auto devices = listDevices();
+        const auto devices = listDevices(context);
         EXPECT_THAT(devices, SizeIs(2));
         EXPECT_THAT(devices[0].vendorId(), Eq(0xabcd));
         EXPECT_THAT(devices[0].productId(), Eq(0x1221));
@@ -145,14 +205,14 @@ namespace plug::test
         EXPECT_CALL(*usbmock, ref_device(_));
 
         std::array<libusb_device*, 1> deviceList{&dev};
-        EXPECT_CALL(*usbmock, get_device_list(nullptr, NotNull()))
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
             .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()),
                             Return(deviceList.size())));
         EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull()))
             .WillOnce(DoAll(SetArgPointee<1>(libusb_device_descriptor{}), Return(LIBUSB_SUCCESS)));
         EXPECT_CALL(*usbmock, free_device_list(NotNull(), 1));
 
-        listDevices();
+        listDevices(context);
     }
 
     TEST_F(UsbTest, listDevicesSkipsDeviceOnFailingDescriptor)
@@ -162,7 +222,7 @@ namespace plug::test
         libusb_device device0;
         libusb_device device1;
         std::array<libusb_device*, 2> deviceList{&device0, &device1};
-        EXPECT_CALL(*usbmock, get_device_list(nullptr, NotNull()))
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
             .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()),
                             Return(deviceList.size())));
         libusb_device_descriptor descr0{};
@@ -178,18 +238,76 @@ namespace plug::test
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_ACCESS)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_ACCESS)).WillOnce(Return("ignore_message"));
 
-        const auto devices = listDevices();
+        const auto devices = listDevices(context);
         EXPECT_THAT(devices, SizeIs(1));
         EXPECT_THAT(devices[0].vendorId(), Eq(0x1234));
     }
 
+    TEST_F(UsbTest, listDevicesFilteredCreatesMatchingDevicesOnly)
+    {
+        libusb_device device0;
+        libusb_device device1;
+        libusb_device device2;
+        std::array<libusb_device*, 3> deviceList{&device0, &device1, &device2};
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
+            .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()),
+                            Return(deviceList.size())));
+        libusb_device_descriptor descr0{};
+        descr0.idVendor = 0x1ed8;
+        descr0.idProduct = 0x0005;
+        libusb_device_descriptor descr1{};
+        descr1.idVendor = 0xeeff;
+        descr1.idProduct = 0x0202;
+        libusb_device_descriptor descr2{};
+        descr2.idVendor = 0x1ed8;
+        descr2.idProduct = 0x0014;
+        EXPECT_CALL(*usbmock, get_device_descriptor(&device0, NotNull())).WillOnce(DoAll(SetArgPointee<1>(descr0), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, get_device_descriptor(&device1, NotNull())).WillOnce(DoAll(SetArgPointee<1>(descr1), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, get_device_descriptor(&device2, NotNull())).WillOnce(DoAll(SetArgPointee<1>(descr2), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, ref_device(&device0));
+        EXPECT_CALL(*usbmock, ref_device(&device2));
+        EXPECT_CALL(*usbmock, free_device_list(NotNull(), 1));
+
+        const auto devices = listDevices(context, [](std::uint16_t vid, std::uint16_t)
+                                         { return vid == 0x1ed8; });
+        EXPECT_THAT(devices, SizeIs(2));
+        EXPECT_THAT(devices[0].productId(), Eq(0x0005));
+        EXPECT_THAT(devices[1].productId(), Eq(0x0014));
+    }
+
+    TEST_F(UsbTest, listDevicesFilteredSkipsDeviceOnFailingDescriptor)
+    {
+        std::array<libusb_device*, 1> deviceList{&dev};
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
+            .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()),
+                            Return(deviceList.size())));
+        EXPECT_CALL(*usbmock, get_device_descriptor(&dev, NotNull())).WillOnce(Return(LIBUSB_ERROR_ACCESS));
+        EXPECT_CALL(*usbmock, ref_device(_)).Times(0);
+        EXPECT_CALL(*usbmock, free_device_list(_, _));
+
+        const auto devices = listDevices(context, [](std::uint16_t, std::uint16_t)
+                                         { return true; });
+        EXPECT_THAT(devices, IsEmpty());
+    }
+
+    TEST_F(UsbTest, listDevicesFilteredThrowsOnDeviceListError)
+    {
+        EXPECT_CALL(*usbmock, error_name(_)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(_)).WillOnce(Return("ignore_message"));
+
+        EXPECT_CALL(*usbmock, get_device_list(_, _)).WillOnce(Return(LIBUSB_ERROR_OTHER));
+        EXPECT_THROW(listDevices(context, [](std::uint16_t, std::uint16_t)
+                                 { return true; }),
+                     UsbException);
+    }
+
     TEST_F(UsbTest, deviceRefsDevice)
     {
         EXPECT_CALL(*usbmock, ref_device(&dev)).WillOnce(Return(&dev));
         EXPECT_CALL(*usbmock, unref_device(_));
         EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(Return(LIBUSB_SUCCESS));
 
-        Device device{&dev};
+        Device device{context, &dev};
     }
 
     TEST_F(UsbTest, deviceUnRefsDeviceOnDestruction)
@@ -198,7 +316,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, unref_device(&dev));
         EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(Return(LIBUSB_SUCCESS));
 
-        Device device{&dev};
+        Device device{context, &dev};
     }
 
     TEST_F(UsbTest, deviceOpen)
@@ -213,7 +331,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(_, _));
         EXPECT_CALL(*usbmock, close(_));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_TRUE(device.isOpen());
     }
@@ -227,7 +345,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_ACCESS)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_ACCESS)).WillOnce(Return("ignore_message"));
 
-        Device device{&dev};
+        Device device{context, &dev};
         EXPECT_THROW(device.open(), UsbException);
     }
 
@@ -244,7 +362,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_NO_MEM)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_NO_MEM)).WillOnce(Return("ignore_message"));
 
-        Device device{&dev};
+        Device device{context, &dev};
         EXPECT_THROW(device.open(), UsbException);
     }
 
@@ -262,7 +380,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_BUSY)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_BUSY)).WillOnce(Return("ignore_message"));
 
-        Device device{&dev};
+        Device device{context, &dev};
         EXPECT_THROW(device.open(), UsbException);
     }
 
@@ -272,7 +390,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
         EXPECT_CALL(*usbmock, unref_device(_));
 
-        Device device{&dev};
+        Device device{context, &dev};
         EXPECT_FALSE(device.isOpen());
     }
 
@@ -288,7 +406,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(handle, 0)).WillOnce(Return(LIBUSB_SUCCESS));
         EXPECT_CALL(*usbmock, close(handle));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_TRUE(device.isOpen());
         device.close();
@@ -301,7 +419,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
         EXPECT_CALL(*usbmock, unref_device(_));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.close();
         EXPECT_FALSE(device.isOpen());
     }
@@ -318,7 +436,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_ERROR_NO_DEVICE));
         EXPECT_CALL(*usbmock, close(handle));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_TRUE(device.isOpen());
         device.close();
@@ -337,7 +455,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_ERROR_NO_DEVICE));
         EXPECT_CALL(*usbmock, close(handle));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
     }
 
@@ -357,7 +475,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
         EXPECT_CALL(*usbmock, close(_));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.name(), StrEq("usb-device-0"));
     }
@@ -378,7 +496,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
         EXPECT_CALL(*usbmock, close(_));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.name(), SizeIs(0));
     }
@@ -401,11 +519,73 @@ namespace plug::test
         EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_TIMEOUT)).WillOnce(Return("ignore_name"));
         EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_TIMEOUT)).WillOnce(Return("ignore_message"));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THROW(device.name(), UsbException);
     }
 
+    TEST_F(UsbTest, deviceSerialNumberReadsSerialNumberDescriptor)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        libusb_device_descriptor descr{};
+        descr.iProduct = 2;
+        descr.iSerialNumber = 3;
+        EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(DoAll(SetArgPointee<1>(descr), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        EXPECT_CALL(*usbmock, open(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(handle), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, set_auto_detach_kernel_driver(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, claim_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        std::string serialBuffer = "A1B2C3";
+        EXPECT_CALL(*usbmock, get_string_descriptor_ascii(handle, 3, NotNull(), 256))
+            .WillOnce(DoAll(SetArrayArgument<2>(serialBuffer.begin(), serialBuffer.end()), Return(serialBuffer.size())));
+        EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, close(_));
+
+        Device device{context, &dev};
+        device.open();
+        EXPECT_THAT(device.serialNumber(), StrEq("A1B2C3"));
+    }
+
+    TEST_F(UsbTest, deviceSerialNumberIsEmptyIfNotReported)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        libusb_device_descriptor descr{};
+        EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(DoAll(SetArgPointee<1>(descr), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        EXPECT_CALL(*usbmock, get_string_descriptor_ascii(_, _, _, _)).Times(0);
+
+        Device device{context, &dev};
+        EXPECT_THAT(device.serialNumber(), IsEmpty());
+    }
+
+    TEST_F(UsbTest, deviceLocationIsBusAndPortPath)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        const std::array<std::uint8_t, 2> ports{{2, 4}};
+        EXPECT_CALL(*usbmock, get_port_numbers(&dev, NotNull(), 7))
+            .WillOnce(DoAll(SetArrayArgument<1>(ports.begin(), ports.end()), Return(ports.size())));
+        EXPECT_CALL(*usbmock, get_bus_number(&dev)).WillOnce(Return(1));
+
+        Device device{context, &dev};
+        EXPECT_THAT(device.location(), StrEq("1-2.4"));
+    }
+
+    TEST_F(UsbTest, deviceLocationThrowsOnError)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        EXPECT_CALL(*usbmock, get_device_descriptor(NotNull(), NotNull())).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        EXPECT_CALL(*usbmock, get_port_numbers(_, _, _)).WillOnce(Return(LIBUSB_ERROR_OVERFLOW));
+        EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_OVERFLOW)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_OVERFLOW)).WillOnce(Return("ignore_message"));
+
+        Device device{context, &dev};
+        EXPECT_THROW(device.location(), UsbException);
+    }
+
     TEST_F(UsbTest, writeTransmitsData)
     {
         EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
@@ -423,7 +603,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0xab, buffer.data(), buffer.size(), NotNull(), 500))
             .WillOnce(DoAll(SetArgPointee<4>(buffer.size()), Return(LIBUSB_SUCCESS)));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.write(0xab, buffer.data(), buffer.size()), Eq(buffer.size()));
     }
@@ -445,7 +625,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0xab, buffer.data(), buffer.size(), NotNull(), 500))
             .WillOnce(DoAll(SetArgPointee<4>(3), Return(LIBUSB_SUCCESS)));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.write(0xab, buffer.data(), buffer.size()), Eq(3));
     }
@@ -468,7 +648,7 @@ namespace plug::test
         std::array<std::uint8_t, 4> buffer{{0x00, 0x01, 0x02, 0x03}};
         EXPECT_CALL(*usbmock, interrupt_transfer(_, _, _, _, _, _)).WillOnce(Return(LIBUSB_ERROR_NOT_FOUND));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THROW(device.write(0xab, buffer.data(), buffer.size()), UsbException);
     }
@@ -490,7 +670,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0xcd, NotNull(), buffer.size(), NotNull(), 500))
             .WillOnce(DoAll(SetArrayArgument<2>(buffer.begin(), buffer.end()), SetArgPointee<4>(buffer.size()), Return(LIBUSB_SUCCESS)));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.receive(0xcd, buffer.size()), BufferIs(buffer));
     }
@@ -512,7 +692,7 @@ namespace plug::test
         EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0xcd, NotNull(), buffer.size(), NotNull(), 500))
             .WillOnce(DoAll(SetArrayArgument<2>(buffer.begin(), std::next(buffer.begin(), 2)), SetArgPointee<4>(2), Return(LIBUSB_SUCCESS)));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.receive(0xcd, buffer.size()), BufferIs(std::array<std::uint8_t, 2>{{0x10, 0x11}}));
     }
@@ -532,7 +712,7 @@ namespace plug::test
 
         EXPECT_CALL(*usbmock, interrupt_transfer(_, _, _, _, _, _)).WillOnce(Return(LIBUSB_ERROR_TIMEOUT));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THAT(device.receive(0x88, 99), SizeIs(0));
     }
@@ -554,8 +734,286 @@ namespace plug::test
 
         EXPECT_CALL(*usbmock, interrupt_transfer(_, _, _, _, _, _)).WillOnce(Return(LIBUSB_ERROR_ACCESS));
 
-        Device device{&dev};
+        Device device{context, &dev};
         device.open();
         EXPECT_THROW(device.receive(0x33, 17), UsbException);
     }
+
+    TEST_F(UsbTest, transportWriteSubmitsTransfer)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+
+        Transport transport{context, handle};
+        auto result = transport.write(0xab, std::array<std::uint8_t, 3>{{0x00, 0x01, 0x02}});
+        EXPECT_THAT(transfer.dev_handle, Eq(handle));
+        EXPECT_THAT(transfer.endpoint, Eq(0xab));
+        EXPECT_THAT(transfer.timeout, Eq(500));
+        EXPECT_THAT(transfer.length, Eq(3));
+        EXPECT_THAT(std::vector<std::uint8_t>(transfer.buffer, std::next(transfer.buffer, 3)), ElementsAre(0x00, 0x01, 0x02));
+
+        complete(&transfer, LIBUSB_TRANSFER_COMPLETED, 3);
+        EXPECT_THAT(result.get(), Eq(3));
+    }
+
+    TEST_F(UsbTest, transportWriteReusesTransfers)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).Times(2).WillRepeatedly(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+
+        Transport transport{context, handle};
+        auto first = transport.write(0xab, std::array<std::uint8_t, 1>{{0x00}});
+        complete(&transfer, LIBUSB_TRANSFER_COMPLETED, 1);
+        EXPECT_THAT(first.get(), Eq(1));
+
+        auto second = transport.write(0xab, std::array<std::uint8_t, 2>{{0x00, 0x01}});
+        complete(&transfer, LIBUSB_TRANSFER_COMPLETED, 2);
+        EXPECT_THAT(second.get(), Eq(2));
+    }
+
+    TEST_F(UsbTest, transportWriteReusesTransferOfDroppedResult)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).Times(2).WillRepeatedly(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+
+        Transport transport{context, handle};
+        {
+            auto dropped = transport.write(0xab, std::array<std::uint8_t, 1>{{0x00}});
+            complete(&transfer, LIBUSB_TRANSFER_COMPLETED, 1);
+        }
+
+        auto second = transport.write(0xab, std::array<std::uint8_t, 2>{{0x00, 0x01}});
+        complete(&transfer, LIBUSB_TRANSFER_COMPLETED, 2);
+        EXPECT_THAT(second.get(), Eq(2));
+    }
+
+    TEST_F(UsbTest, transportWriteThrowsOnSubmitFailure)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).WillOnce(Return(LIBUSB_ERROR_NO_DEVICE));
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+        EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_NO_DEVICE)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_NO_DEVICE)).WillOnce(Return("ignore_message"));
+
+        Transport transport{context, handle};
+        EXPECT_THROW(transport.write(0xab, std::array<std::uint8_t, 1>{{0x00}}), UsbException);
+    }
+
+    TEST_F(UsbTest, transportWriteResultThrowsOnTransferFailure)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+        EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_TIMEOUT)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_TIMEOUT)).WillOnce(Return("ignore_message"));
+
+        Transport transport{context, handle};
+        auto result = transport.write(0xab, std::array<std::uint8_t, 1>{{0x00}});
+        complete(&transfer, LIBUSB_TRANSFER_TIMED_OUT, 0);
+        EXPECT_THROW(result.get(), UsbException);
+    }
+
+    TEST_F(UsbTest, transportDtorCancelsPendingWrites)
+    {
+        expectEventHandling();
+        libusb_transfer transfer{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfer));
+        EXPECT_CALL(*usbmock, submit_transfer(&transfer)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, cancel_transfer(&transfer)).WillOnce(cancelTransfer());
+        EXPECT_CALL(*usbmock, free_transfer(&transfer));
+        EXPECT_CALL(*usbmock, error_name(_)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(_)).WillOnce(Return("ignore_message"));
+
+        PendingWrite result;
+        {
+            Transport transport{context, handle};
+            result = transport.write(0xab, std::array<std::uint8_t, 1>{{0x00}});
+        }
+        EXPECT_THROW(result.get(), UsbException);
+    }
+
+    TEST_F(UsbTest, transportReceivingArmsDoubleBufferedTransfers)
+    {
+        expectEventHandling();
+        std::array<libusb_transfer, 2> transfers{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfers[0])).WillOnce(Return(&transfers[1]));
+        EXPECT_CALL(*usbmock, submit_transfer(_)).Times(2).WillRepeatedly(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, cancel_transfer(_)).Times(2).WillRepeatedly(cancelTransfer());
+        EXPECT_CALL(*usbmock, free_transfer(_)).Times(2);
+
+        Transport transport{context, handle};
+        transport.startReceiving(0x81, 64, [](auto, auto) {});
+        EXPECT_THAT(transport.isReceiving(), IsTrue());
+        EXPECT_THAT(transfers[0].endpoint, Eq(0x81));
+        EXPECT_THAT(transfers[0].length, Eq(64));
+        EXPECT_THAT(transfers[0].timeout, Eq(0));
+        EXPECT_THAT(transfers[1].buffer, Ne(transfers[0].buffer));
+
+        transport.stopReceiving();
+        EXPECT_THAT(transport.isReceiving(), IsFalse());
+    }
+
+    TEST_F(UsbTest, transportReceivingDeliversDataAndRearms)
+    {
+        expectEventHandling();
+        std::array<libusb_transfer, 2> transfers{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfers[0])).WillOnce(Return(&transfers[1]));
+        EXPECT_CALL(*usbmock, submit_transfer(_)).Times(3).WillRepeatedly(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, cancel_transfer(_)).Times(2).WillRepeatedly(cancelTransfer());
+        EXPECT_CALL(*usbmock, free_transfer(_)).Times(2);
+
+        std::vector<std::uint8_t> received;
+        Transport transport{context, handle};
+        transport.startReceiving(0x81, 64, [&received](std::span<const std::uint8_t> data, std::exception_ptr error)
+                                 {
+                                     EXPECT_THAT(error, IsFalse());
+                                     received.assign(data.begin(), data.end()); });
+
+        std::fill_n(transfers[0].buffer, 3, 0xcd);
+        complete(&transfers[0], LIBUSB_TRANSFER_COMPLETED, 3);
+        EXPECT_THAT(received, ElementsAre(0xcd, 0xcd, 0xcd));
+    }
+
+    TEST_F(UsbTest, transportReceivingReportsTransferError)
+    {
+        expectEventHandling();
+        std::array<libusb_transfer, 2> transfers{};
+        EXPECT_CALL(*usbmock, alloc_transfer(0)).WillOnce(Return(&transfers[0])).WillOnce(Return(&transfers[1]));
+        EXPECT_CALL(*usbmock, submit_transfer(_)).Times(2).WillRepeatedly(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, cancel_transfer(&transfers[1])).WillOnce(cancelTransfer());
+        EXPECT_CALL(*usbmock, free_transfer(_)).Times(2);
+        EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_NO_DEVICE)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_NO_DEVICE)).WillOnce(Return("ignore_message"));
+
+        std::exception_ptr reported;
+        Transport transport{context, handle};
+        transport.startReceiving(0x81, 64, [&reported](auto, std::exception_ptr error)
+                                 { reported = error; });
+
+        complete(&transfers[0], LIBUSB_TRANSFER_NO_DEVICE, 0);
+        EXPECT_THROW(std::rethrow_exception(reported), UsbException);
+    }
+
+    TEST_F(UsbTest, hotplugRegistersCallbackIfSupported)
+    {
+        EXPECT_CALL(*usbmock, has_capability(LIBUSB_CAP_HAS_HOTPLUG)).WillOnce(Return(1));
+        EXPECT_CALL(*usbmock, hotplug_register_callback(context, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                                        LIBUSB_HOTPLUG_NO_FLAGS, 0x1ed8, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                                        NotNull(), NotNull(), NotNull()))
+            .WillOnce(DoAll(SetArgPointee<8>(7), Return(LIBUSB_SUCCESS)));
+        expectEventHandling();
+        EXPECT_CALL(*usbmock, hotplug_deregister_callback(context, 7));
+
+        HotplugMonitor monitor{context, 0x1ed8, {0x0005}, [](HotplugEvent, std::uint16_t) {}};
+        EXPECT_THAT(monitor.isPolling(), IsFalse());
+    }
+
+    TEST_F(UsbTest, hotplugThrowsOnRegisterError)
+    {
+        EXPECT_CALL(*usbmock, has_capability(LIBUSB_CAP_HAS_HOTPLUG)).WillOnce(Return(1));
+        EXPECT_CALL(*usbmock, hotplug_register_callback(_, _, _, _, _, _, _, _, _)).WillOnce(Return(LIBUSB_ERROR_NOT_SUPPORTED));
+        EXPECT_CALL(*usbmock, error_name(LIBUSB_ERROR_NOT_SUPPORTED)).WillOnce(Return("ignore_name"));
+        EXPECT_CALL(*usbmock, strerror(LIBUSB_ERROR_NOT_SUPPORTED)).WillOnce(Return("ignore_message"));
+
+        EXPECT_THROW((HotplugMonitor{context, 0x1ed8, {0x0005}, [](HotplugEvent, std::uint16_t) {}}), UsbException);
+    }
+
+    TEST_F(UsbTest, hotplugReportsMatchingProductsOnly)
+    {
+        libusb_hotplug_callback_fn callback{nullptr};
+        void* userData{nullptr};
+        EXPECT_CALL(*usbmock, has_capability(LIBUSB_CAP_HAS_HOTPLUG)).WillOnce(Return(1));
+        EXPECT_CALL(*usbmock, hotplug_register_callback(_, _, _, _, _, _, _, _, _))
+            .WillOnce(DoAll(SaveArg<6>(&callback), SaveArg<7>(&userData), Return(LIBUSB_SUCCESS)));
+        expectEventHandling();
+        EXPECT_CALL(*usbmock, hotplug_deregister_callback(_, _));
+
+        libusb_device_descriptor supported{};
+        supported.idVendor = 0x1ed8;
+        supported.idProduct = 0x0005;
+        libusb_device_descriptor other{};
+        other.idVendor = 0x1ed8;
+        other.idProduct = 0x0099;
+        EXPECT_CALL(*usbmock, get_device_descriptor(&dev, NotNull()))
+            .WillOnce(DoAll(SetArgPointee<1>(supported), Return(LIBUSB_SUCCESS)))
+            .WillOnce(DoAll(SetArgPointee<1>(other), Return(LIBUSB_SUCCESS)))
+            .WillOnce(DoAll(SetArgPointee<1>(supported), Return(LIBUSB_SUCCESS)));
+
+        std::vector<std::pair<HotplugEvent, std::uint16_t>> events;
+        HotplugMonitor monitor{context, 0x1ed8, {0x0004, 0x0005}, [&events](HotplugEvent event, std::uint16_t productId)
+                               { events.emplace_back(event, productId); }};
+        ASSERT_THAT(callback, NotNull());
+
+        EXPECT_THAT(callback(nullptr, &dev, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, userData), Eq(0));
+        EXPECT_THAT(callback(nullptr, &dev, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, userData), Eq(0));
+        EXPECT_THAT(callback(nullptr, &dev, LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT, userData), Eq(0));
+        EXPECT_THAT(events, ElementsAre(std::pair{HotplugEvent::arrived, std::uint16_t{0x0005}},
+                                        std::pair{HotplugEvent::left, std::uint16_t{0x0005}}));
+    }
+
+    TEST_F(UsbTest, hotplugPollsDeviceListIfNotSupported)
+    {
+        std::array<libusb_device*, 1> deviceList{&dev};
+        libusb_device_descriptor descriptor{};
+        descriptor.idVendor = 0x1ed8;
+        descriptor.idProduct = 0x0005;
+        EXPECT_CALL(*usbmock, has_capability(LIBUSB_CAP_HAS_HOTPLUG)).WillOnce(Return(0));
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
+            .WillOnce(Return(0))
+            .WillRepeatedly(DoAll(SetArgPointee<1>(deviceList.data()), Return(deviceList.size())));
+        EXPECT_CALL(*usbmock, get_device_descriptor(&dev, NotNull())).WillRepeatedly(DoAll(SetArgPointee<1>(descriptor), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, ref_device(_)).WillRepeatedly(Return(nullptr));
+        EXPECT_CALL(*usbmock, free_device_list(_, _)).Times(AtLeast(1));
+
+        std::promise<std::pair<HotplugEvent, std::uint16_t>> reported;
+        std::once_flag once;
+        HotplugMonitor monitor{context, 0x1ed8, {0x0005}, [&reported, &once](HotplugEvent event, std::uint16_t productId)
+                               { std::call_once(once, [&]
+                                                { reported.set_value({event, productId}); }); },
+                               std::chrono::milliseconds{1}};
+        EXPECT_THAT(monitor.isPolling(), IsTrue());
+
+        auto result = reported.get_future();
+        ASSERT_THAT(result.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+        EXPECT_THAT(result.get(), Eq(std::pair{HotplugEvent::arrived, std::uint16_t{0x0005}}));
+    }
+
+    TEST_F(UsbTest, hotplugPollingReportsRemovedDevice)
+    {
+        std::array<libusb_device*, 1> deviceList{&dev};
+        libusb_device_descriptor descriptor{};
+        descriptor.idVendor = 0x1ed8;
+        descriptor.idProduct = 0x0005;
+        EXPECT_CALL(*usbmock, has_capability(LIBUSB_CAP_HAS_HOTPLUG)).WillOnce(Return(0));
+        EXPECT_CALL(*usbmock, get_device_list(context, NotNull()))
+            .WillOnce(DoAll(SetArgPointee<1>(deviceList.data()), Return(deviceList.size())))
+            .WillRepeatedly(Return(0));
+        EXPECT_CALL(*usbmock, get_device_descriptor(&dev, NotNull())).WillOnce(DoAll(SetArgPointee<1>(descriptor), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, ref_device(_)).WillRepeatedly(Return(nullptr));
+        EXPECT_CALL(*usbmock, free_device_list(_, _)).Times(AtLeast(1));
+
+        std::promise<std::pair<HotplugEvent, std::uint16_t>> reported;
+        std::once_flag once;
+        HotplugMonitor monitor{context, 0x1ed8, {0x0005}, [&reported, &once](HotplugEvent event, std::uint16_t productId)
+                               { std::call_once(once, [&]
+                                                { reported.set_value({event, productId}); }); },
+                               std::chrono::milliseconds{1}};
+
+        auto result = reported.get_future();
+        ASSERT_THAT(result.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+        EXPECT_THAT(result.get(), Eq(std::pair{HotplugEvent::left, std::uint16_t{0x0005}}));
+    }
 }
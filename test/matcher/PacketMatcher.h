@@ -28,10 +28,26 @@
 
 namespace plug::test::matcher
 {
+    namespace detail
+    {
+        constexpr std::size_t headerPos(const com::schema::Field& field)
+        {
+            return field.offset;
+        }
+
+        constexpr std::size_t payloadPos(const com::schema::Field& field)
+        {
+            return com::headerRawTypeSize + field.offset;
+        }
+    }
+
     MATCHER_P4(AmpDataIs, ampId, v0, v1, v2, "")
     {
-        constexpr std::size_t posAmpId{16};
-        const std::tuple actual{arg[posAmpId], arg[40], arg[43], arg[44], arg[45], arg[46], arg[50], arg[54]};
+        using namespace com::schema::amp;
+        using detail::payloadPos;
+        const std::tuple actual{arg[payloadPos(model)], arg[payloadPos(unknown0)], arg[payloadPos(unknown1)],
+                                arg[payloadPos(ampSpecific0)], arg[payloadPos(ampSpecific1)], arg[payloadPos(ampSpecific2)],
+                                arg[payloadPos(ampSpecific3)], arg[payloadPos(ampSpecific4)]};
         const auto [a0, a1, a2, a3, a4, a5, a6, a7] = actual;
         *result_listener << " with amp specific values: ("
                          << int{a0} << ", {" << int{a1} << ", " << int{a2} << "}, {"
@@ -42,17 +58,16 @@ namespace plug::test::matcher
 
     MATCHER_P(CabinetDataIs, cabinetValue, "")
     {
-        constexpr std::size_t posCabId{49};
-        const auto actual = arg[posCabId];
+        const auto actual = arg[detail::payloadPos(com::schema::amp::cabinet)];
         *result_listener << " with cabinet data: " << int{actual};
         return actual == cabinetValue;
     }
 
     MATCHER_P4(EffectDataIs, dsp, effect, v0, v1, "")
     {
-        constexpr std::size_t posDspId{2};
-        constexpr std::size_t posEffectId{16};
-        const std::tuple actual{arg[posDspId], arg[posEffectId], arg[19], arg[20]};
+        using detail::payloadPos;
+        const std::tuple actual{arg[detail::headerPos(com::schema::header::dsp)], arg[payloadPos(com::schema::effect::model)],
+                                arg[payloadPos(com::schema::effect::unknown0)], arg[payloadPos(com::schema::effect::unknown1)]};
         const auto [a0, a1, a2, a3] = actual;
         *result_listener << " with effect values: (" << int{a0} << ", " << int{a1}
                          << ", " << int{a2} << ", " << int{a3} << ")";
@@ -62,14 +77,10 @@ namespace plug::test::matcher
 
     MATCHER_P6(KnobsAre, k1, k2, k3, k4, k5, k6, "")
     {
-        constexpr std::size_t posKnob1{32};
-        constexpr std::size_t posKnob2{33};
-        constexpr std::size_t posKnob3{34};
-        constexpr std::size_t posKnob4{35};
-        constexpr std::size_t posKnob5{36};
-        constexpr std::size_t posKnob6{37};
-        const std::tuple actual{arg[posKnob1], arg[posKnob2], arg[posKnob3],
-                                arg[posKnob4], arg[posKnob5], arg[posKnob6]};
+        using namespace com::schema::effect;
+        using detail::payloadPos;
+        const std::tuple actual{arg[payloadPos(knob1)], arg[payloadPos(knob2)], arg[payloadPos(knob3)],
+                                arg[payloadPos(knob4)], arg[payloadPos(knob5)], arg[payloadPos(knob6)]};
         const auto [a1, a2, a3, a4, a5, a6] = actual;
         *result_listener << " with knobs: (" << int{a1} << ", " << int{a2} << ", " << int{a3}
                          << ", " << int{a4} << ", " << int{a5} << ", " << int{a6} << ")";
@@ -78,8 +89,7 @@ namespace plug::test::matcher
 
     MATCHER_P(FxKnobIs, value, "")
     {
-        constexpr std::size_t posFxKnobId{3};
-        const auto a = arg[posFxKnobId];
+        const auto a = arg[detail::headerPos(com::schema::header::unknown0)];
         *result_listener << " with FX Knob " << int{a};
         return value == a;
     }
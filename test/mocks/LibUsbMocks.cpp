@@ -73,6 +73,31 @@ extern "C"
         return plug::test::mock::getUsbMock()->interrupt_transfer(dev_handle, endpoint, data, length, actual_length, timeout);
     }
 
+    libusb_transfer* libusb_alloc_transfer(int iso_packets)
+    {
+        return plug::test::mock::getUsbMock()->alloc_transfer(iso_packets);
+    }
+
+    int libusb_submit_transfer(libusb_transfer* transfer)
+    {
+        return plug::test::mock::getUsbMock()->submit_transfer(transfer);
+    }
+
+    int libusb_cancel_transfer(libusb_transfer* transfer)
+    {
+        return plug::test::mock::getUsbMock()->cancel_transfer(transfer);
+    }
+
+    void libusb_free_transfer(libusb_transfer* transfer)
+    {
+        plug::test::mock::getUsbMock()->free_transfer(transfer);
+    }
+
+    int libusb_handle_events_timeout_completed(libusb_context* ctx, timeval* tv, int* completed)
+    {
+        return plug::test::mock::getUsbMock()->handle_events_timeout_completed(ctx, tv, completed);
+    }
+
     int libusb_claim_interface(libusb_device_handle* dev_handle, int interface_number)
     {
         return plug::test::mock::getUsbMock()->claim_interface(dev_handle, interface_number);
@@ -147,6 +172,32 @@ extern "C"
     {
         return plug::test::mock::getUsbMock()->get_string_descriptor_ascii(dev_handle, desc_index, data, length);
     }
+
+    uint8_t libusb_get_bus_number(libusb_device* dev)
+    {
+        return plug::test::mock::getUsbMock()->get_bus_number(dev);
+    }
+
+    int libusb_get_port_numbers(libusb_device* dev, uint8_t* port_numbers, int port_numbers_len)
+    {
+        return plug::test::mock::getUsbMock()->get_port_numbers(dev, port_numbers, port_numbers_len);
+    }
+
+    int libusb_has_capability(uint32_t capability)
+    {
+        return plug::test::mock::getUsbMock()->has_capability(capability);
+    }
+
+    int libusb_hotplug_register_callback(libusb_context* ctx, int events, int flags, int vendor_id, int product_id, int dev_class,
+                                         libusb_hotplug_callback_fn cb_fn, void* user_data, libusb_hotplug_callback_handle* callback_handle)
+    {
+        return plug::test::mock::getUsbMock()->hotplug_register_callback(ctx, events, flags, vendor_id, product_id, dev_class, cb_fn, user_data, callback_handle);
+    }
+
+    void libusb_hotplug_deregister_callback(libusb_context* ctx, libusb_hotplug_callback_handle callback_handle)
+    {
+        plug::test::mock::getUsbMock()->hotplug_deregister_callback(ctx, callback_handle);
+    }
 }
 
 
@@ -39,6 +39,11 @@ namespace plug::test::mock
         MOCK_METHOD(int, release_interface, (libusb_device_handle*, int) );
         MOCK_METHOD(int, claim_interface, (libusb_device_handle*, int) );
         MOCK_METHOD(int, interrupt_transfer, (libusb_device_handle*, unsigned char, unsigned char*, int, int*, unsigned int) );
+        MOCK_METHOD(libusb_transfer*, alloc_transfer, (int) );
+        MOCK_METHOD(int, submit_transfer, (libusb_transfer*) );
+        MOCK_METHOD(int, cancel_transfer, (libusb_transfer*) );
+        MOCK_METHOD(void, free_transfer, (libusb_transfer*) );
+        MOCK_METHOD(int, handle_events_timeout_completed, (libusb_context*, timeval*, int*) );
         MOCK_METHOD(const char*, error_name, (int) );
         MOCK_METHOD(const char*, strerror, (int) );
         MOCK_METHOD(ssize_t, get_device_list, (libusb_context*, libusb_device***) );
@@ -48,6 +53,11 @@ namespace plug::test::mock
         MOCK_METHOD(void, unref_device, (libusb_device*) );
         MOCK_METHOD(int, open, (libusb_device*, libusb_device_handle**) );
         MOCK_METHOD(int, get_string_descriptor_ascii, (libusb_device_handle*, uint8_t, unsigned char*, int) );
+        MOCK_METHOD(uint8_t, get_bus_number, (libusb_device*) );
+        MOCK_METHOD(int, get_port_numbers, (libusb_device*, uint8_t*, int) );
+        MOCK_METHOD(int, has_capability, (uint32_t) );
+        MOCK_METHOD(int, hotplug_register_callback, (libusb_context*, int, int, int, int, int, libusb_hotplug_callback_fn, void*, libusb_hotplug_callback_handle*) );
+        MOCK_METHOD(void, hotplug_deregister_callback, (libusb_context*, libusb_hotplug_callback_handle) );
     };
 
     UsbMock* getUsbMock();
@@ -58,6 +68,12 @@ namespace plug::test::mock
 
 extern "C"
 {
+    struct libusb_context
+    {
+        char dummy;
+    };
+
+
     struct libusb_device
     {
         uint16_t idVendor;
@@ -21,6 +21,8 @@
 #pragma once
 
 #include "com/Connection.h"
+#include <algorithm>
+#include <vector>
 #include <gmock/gmock.h>
 
 namespace plug::test::mock
@@ -36,8 +38,20 @@ namespace plug::test::mock
         MOCK_METHOD(void, openFirst, (std::uint16_t, std::initializer_list<std::uint16_t>) );
         MOCK_METHOD(void, close, ());
         MOCK_METHOD(bool, isOpen, (), (const));
+        // Data source for receiveInto()
         MOCK_METHOD(std::vector<std::uint8_t>, receive, (std::size_t));
-        MOCK_METHOD(std::size_t, sendImpl, (std::uint8_t*, std::size_t));
+        MOCK_METHOD(std::size_t, sendImpl, (const std::uint8_t*, std::size_t));
+
+        std::size_t receiveInto(std::span<std::uint8_t> buffer) override
+        {
+            const auto data = receive(buffer.size());
+            const auto n = std::min(data.size(), buffer.size());
+            std::copy_n(data.cbegin(), n, buffer.begin());
+            return n;
+        }
+        MOCK_METHOD(void, setReceiveTimeout, (std::chrono::milliseconds));
         MOCK_METHOD(std::string, name, (), (const));
+        MOCK_METHOD(std::string, identity, (), (const));
+        MOCK_METHOD(void, discardReceived, ());
     };
 }
@@ -80,16 +80,83 @@ namespace plug::com::usb
         void releaseHandle([[maybe_unused]] libusb_device_handle* handle)
         {
         }
+
+        void releaseTransport([[maybe_unused]] Transport* transport)
+        {
+        }
+
+        void releaseEventThread([[maybe_unused]] EventThread* thread)
+        {
+        }
+    }
+
+    std::vector<Device> listDevices(libusb_context* context)
+    {
+        return plug::test::mock::usbContextMock->listDevices(context);
+    }
+
+    std::vector<Device> listDevices(libusb_context* context, const DeviceFilter& filter)
+    {
+        return plug::test::mock::usbContextMock->listDevices(context, filter);
+    }
+
+
+    HotplugMonitor::HotplugMonitor(libusb_context* context, std::uint16_t vendorId, const std::vector<std::uint16_t>& productIds, HotplugHandler handler, std::chrono::milliseconds pollInterval)
+        : context_(context), vendorId_(vendorId), productIds_(productIds), handler_(handler), pollInterval_(pollInterval),
+          callbackHandle_(0), eventThread_(nullptr), running_(false), present_(), pollThread_()
+    {
+        plug::test::mock::usbContextMock->monitor(context, vendorId, productIds, handler);
+    }
+
+    HotplugMonitor::~HotplugMonitor()
+    {
+    }
+
+    bool HotplugMonitor::isPolling() const noexcept
+    {
+        return false;
     }
 
-    std::vector<Device> listDevices()
+
+    PendingWrite::PendingWrite(std::size_t transferred)
+        : transferred_(transferred)
     {
-        return plug::test::mock::usbContextMock->listDevices();
     }
 
+    PendingWrite::PendingWrite(std::exception_ptr error)
+        : error_(std::move(error))
+    {
+    }
+
+    PendingWrite::PendingWrite(PendingWrite&& other) noexcept
+        : request_(std::move(other.request_)), transferred_(other.transferred_), error_(std::move(other.error_))
+    {
+    }
 
-    Device::Device(libusb_device* device)
-        : device_(device), handle_(nullptr), descriptor_({})
+    PendingWrite::~PendingWrite()
+    {
+    }
+
+    std::size_t PendingWrite::get()
+    {
+        if (error_ != nullptr)
+        {
+            std::rethrow_exception(error_);
+        }
+        return transferred_;
+    }
+
+    PendingWrite& PendingWrite::operator=(PendingWrite&& other) noexcept
+    {
+        request_ = std::move(other.request_);
+        transferred_ = other.transferred_;
+        error_ = std::move(other.error_);
+        return *this;
+    }
+
+
+    Device::Device(libusb_context* context, libusb_device* device)
+        : context_(context), device_(device), handle_(nullptr), transport_(nullptr), descriptor_({})
     {
     }
 
@@ -123,6 +190,16 @@ namespace plug::com::usb
         return plug::test::mock::usbDeviceMock->name();
     }
 
+    std::string Device::serialNumber() const
+    {
+        return plug::test::mock::usbDeviceMock->serialNumber();
+    }
+
+    std::string Device::location() const
+    {
+        return plug::test::mock::usbDeviceMock->location();
+    }
+
     std::size_t Device::write(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize)
     {
         return plug::test::mock::usbDeviceMock->write(endpoint, data, dataSize);
@@ -133,4 +210,19 @@ namespace plug::com::usb
         return plug::test::mock::usbDeviceMock->receive(endpoint, dataSize);
     }
 
+    PendingWrite Device::writeAsync(std::uint8_t endpoint, std::span<const std::uint8_t> data)
+    {
+        return plug::test::mock::usbDeviceMock->writeAsync(endpoint, std::vector<std::uint8_t>(data.begin(), data.end()));
+    }
+
+    void Device::startReceiving(std::uint8_t endpoint, std::size_t packetSize, ReceiveHandler handler)
+    {
+        plug::test::mock::usbDeviceMock->startReceiving(endpoint, packetSize, std::move(handler));
+    }
+
+    void Device::stopReceiving()
+    {
+        plug::test::mock::usbDeviceMock->stopReceiving();
+    }
+
 }
@@ -22,13 +22,16 @@
 
 #include "com/UsbContext.h"
 #include "com/UsbDevice.h"
+#include "com/UsbHotplug.h"
 #include <gmock/gmock.h>
 
 namespace plug::test::mock
 {
     struct UsbContextMock
     {
-        MOCK_METHOD(std::vector<plug::com::usb::Device>, listDevices, ());
+        MOCK_METHOD(std::vector<plug::com::usb::Device>, listDevices, (libusb_context*));
+        MOCK_METHOD(std::vector<plug::com::usb::Device>, listDevices, (libusb_context*, plug::com::usb::DeviceFilter));
+        MOCK_METHOD(void, monitor, (libusb_context*, std::uint16_t, std::vector<std::uint16_t>, plug::com::usb::HotplugHandler));
     };
 
     UsbContextMock* resetUsbContextMock();
@@ -45,7 +48,12 @@ namespace plug::test::mock
         MOCK_METHOD(std::uint16_t, productId, (), (const noexcept));
         MOCK_METHOD(std::size_t, write, (std::uint8_t, std::uint8_t*, std::size_t));
         MOCK_METHOD(std::vector<std::uint8_t>, receive, (std::uint8_t, std::size_t));
+        MOCK_METHOD(plug::com::usb::PendingWrite, writeAsync, (std::uint8_t, std::vector<std::uint8_t>));
+        MOCK_METHOD(void, startReceiving, (std::uint8_t, std::size_t, plug::com::usb::ReceiveHandler));
+        MOCK_METHOD(void, stopReceiving, ());
         MOCK_METHOD(std::string, name, ());
+        MOCK_METHOD(std::string, serialNumber, ());
+        MOCK_METHOD(std::string, location, ());
     };
 
 